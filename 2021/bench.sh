@@ -0,0 +1,80 @@
+#!/bin/bash
+# This script builds and benchmarks the given days (all days by default) and
+# prints a single CSV report. Options after -- are passed to each benchmark.
+# Example: ./bench.sh 15 19 -- -n 50
+#
+# With -r it records a baseline file of all timings instead, and with -c it
+# runs the same benchmarks and compares them to a recorded baseline, failing
+# if any phase got significantly slower (see compare.cpp). With -s the days
+# run on inputs of the given scale from the generator instead of the puzzle
+# inputs. Baselines default to 20 repetitions per phase.
+# Example: ./bench.sh -r baseline.csv -s 1000 6 15
+#          ./bench.sh -c baseline.csv -s 1000 6 15
+
+usage() {
+    echo "Usage: $0 [-r baseline | -c baseline] [-s scale] [days...] [-- options]"
+    exit 1
+}
+
+record=""
+compare=""
+scale=""
+while getopts "r:c:s:" option; do
+    case "$option" in
+        r) record="$OPTARG" ;;
+        c) compare="$OPTARG" ;;
+        s) scale="$OPTARG" ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+[[ -n "$record" && -n "$compare" ]] && usage
+
+days=()
+while [[ $# -gt 0 && "$1" != "--" ]]; do
+    days+=("$1")
+    shift
+done
+[[ "$1" == "--" ]] && shift
+
+if [[ ${#days[@]} -eq 0 ]]; then
+    days=($(seq 1 25))
+fi
+
+cmake -S . -B build > /dev/null || exit
+cmake --build build -j > /dev/null || exit
+
+# Runs the benchmark of a day on the input of the selected scale
+run() {
+    local day="$1"
+    shift
+    if [[ -n "$scale" ]]; then
+        local input="build/inputs/input${day}_${scale}.txt"
+        mkdir -p build/inputs
+        [[ -f "$input" ]] || ./build/generate "$day" "$scale" > "$input" || return
+        BENCHMARK_NO_HEADER=1 ./build/day_"$day"_bench "$@" "$input"
+    else
+        BENCHMARK_NO_HEADER=1 ./build/day_"$day"_bench "$@"
+    fi
+}
+
+if [[ -z "$record" && -z "$compare" ]]; then
+    echo "day,phase,repetitions,min_ns,median_ns,p99_ns,allocations,allocated_bytes,peak_live_bytes,peak_rss_kb,result"
+    for day in "${days[@]}"; do
+        run "$day" "$@"
+    done
+    exit
+fi
+
+output="${record:-$(mktemp)}"
+echo "day,phase,scale,repetitions,median_ns,ops_per_sec,peak_live_bytes,peak_rss_kb,samples_ns" > "$output"
+for day in "${days[@]}"; do
+    run "$day" -n 20 --baseline "${scale:-puzzle}" "$@" >> "$output"
+done
+
+if [[ -n "$compare" ]]; then
+    ./build/compare "$compare" "$output"
+    status=$?
+    rm "$output"
+    exit $status
+fi
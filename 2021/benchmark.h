@@ -0,0 +1,256 @@
+#pragma once
+
+/* Benchmark harness shared by all days.
+ *
+ * Every day keeps its normal main(), and when compiled with -DBENCHMARK it
+ * instead hands its parse and part functions to benchmark::run, which times
+ * each of them as a separate phase:
+ *
+ *     ./day_15_bench [-n repetitions] [--json] [--baseline scale] [input file]
+ *
+ * Each phase is repeated n times and reported as one CSV row (or one JSON
+ * object per line with --json) with min, median and p99 wall time in
+ * nanoseconds, together with the number of heap allocations and allocated
+ * bytes per repetition. Memory is reported as the peak of live heap bytes
+ * above what was live when the phase started, and as the peak resident set
+ * size in kB. The kernel's peak RSS is reset before every repetition where
+ * /proc/self/clear_refs allows it, otherwise it covers the whole run so far.
+ *
+ * With --baseline every phase is instead reported in the format of the
+ * baseline files read by the compare tool, with the given label of the input
+ * scale, the median as operations per second and all timings of the phase.
+ * The header must be included in exactly one translation unit, because it
+ * replaces the global operator new and delete.
+ */
+
+#ifdef BENCHMARK
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <malloc.h>
+
+namespace benchmark {
+
+std::atomic<std::size_t> allocations(0);
+std::atomic<std::size_t> allocated_bytes(0);
+
+/* Usable size of the live blocks, which is what they really occupy */
+std::atomic<std::size_t> live_bytes(0);
+std::atomic<std::size_t> peak_live_bytes(0);
+
+constexpr const char *BASELINE_HEADER =
+    "day,phase,scale,repetitions,median_ns,ops_per_sec,peak_live_bytes,peak_rss_kb,samples_ns";
+
+struct Options {
+    int repetitions = 10;
+    bool json = false;
+    /* Scale of the input in baseline rows, empty if not writing them */
+    std::string baseline;
+    std::string input;
+};
+
+struct Phase {
+    std::string name;
+    std::vector<long long> times;
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+    std::size_t peak_live_bytes = 0;
+    long peak_rss_kb = 0;
+    std::string result;
+};
+
+/* Keep the compiler from discarding a result that is never printed */
+template <typename T>
+inline void do_not_optimize(const T &value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+/* Return value at percentile p (0-100) of sorted times */
+inline long long percentile(const std::vector<long long> &sorted, int p) {
+    std::size_t rank = (sorted.size() * p + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+inline Options parse_options(int argc, char *argv[], const std::string &input) {
+    Options options;
+    options.input = input;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "-n") && i + 1 < argc) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (!std::strcmp(argv[i], "--json")) {
+            options.json = true;
+        } else if (!std::strcmp(argv[i], "--baseline") && i + 1 < argc) {
+            options.baseline = argv[++i];
+        } else {
+            options.input = argv[i];
+        }
+    }
+
+    return options;
+}
+
+/* Let the kernel's peak RSS start again from the current RSS */
+inline void reset_peak_rss() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+}
+
+/* Return the peak RSS in kB, or 0 where it is not known */
+inline long peak_rss_kb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.starts_with("VmHWM:")) {
+            return std::atol(line.c_str() + 6);
+        }
+    }
+    return 0;
+}
+
+/* Run fn n times and collect its timings and memory use. The result of fn
+ * is destroyed after its time is taken, and kept for the report if answer is
+ * set. */
+template <typename Fn>
+Phase measure(const std::string &name, int n, Fn fn, bool answer = true) {
+    Phase phase;
+    phase.name = name;
+
+    for (int i = 0; i < n; ++i) {
+        // Before the counters, as it allocates itself
+        reset_peak_rss();
+        std::size_t start_allocations = allocations;
+        std::size_t start_bytes = allocated_bytes;
+        std::size_t start_live = live_bytes;
+        peak_live_bytes = start_live;
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = fn();
+        auto end = std::chrono::steady_clock::now();
+        do_not_optimize(result);
+
+        phase.allocations += allocations - start_allocations;
+        phase.bytes += allocated_bytes - start_bytes;
+        phase.peak_live_bytes = std::max(phase.peak_live_bytes, peak_live_bytes - start_live);
+        phase.peak_rss_kb = std::max(phase.peak_rss_kb, peak_rss_kb());
+
+        phase.times.push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+        );
+
+        // Remember the answer of the last repetition for the report
+        if constexpr (requires(std::ostream &out, const decltype(result) &value) {
+            out << value;
+        }) {
+            if (answer && i == n - 1) {
+                std::ostringstream out;
+                out << result;
+                phase.result = out.str();
+            }
+        }
+    }
+
+    phase.allocations /= n;
+    phase.bytes /= n;
+    std::sort(phase.times.begin(), phase.times.end());
+    return phase;
+}
+
+inline void report(const std::string &day, const Phase &phase, int n, const Options &options) {
+    const auto &t = phase.times;
+    if (!options.baseline.empty()) {
+        std::cout << day << ',' << phase.name << ',' << options.baseline << ',' << n << ','
+                  << percentile(t, 50) << ',' << 1e9 / std::max(1LL, percentile(t, 50)) << ','
+                  << phase.peak_live_bytes << ',' << phase.peak_rss_kb << ',';
+        for (std::size_t i = 0; i < t.size(); ++i) {
+            std::cout << (i ? " " : "") << t[i];
+        }
+        std::cout << '\n';
+    } else if (options.json) {
+        std::cout << "{\"day\": \"" << day << "\", \"phase\": \"" << phase.name
+                  << "\", \"repetitions\": " << n
+                  << ", \"min_ns\": " << t.front()
+                  << ", \"median_ns\": " << percentile(t, 50)
+                  << ", \"p99_ns\": " << percentile(t, 99)
+                  << ", \"allocations\": " << phase.allocations
+                  << ", \"allocated_bytes\": " << phase.bytes
+                  << ", \"peak_live_bytes\": " << phase.peak_live_bytes
+                  << ", \"peak_rss_kb\": " << phase.peak_rss_kb
+                  << ", \"result\": \"" << phase.result << "\"}\n";
+    } else {
+        std::cout << day << ',' << phase.name << ',' << n << ','
+                  << t.front() << ',' << percentile(t, 50) << ','
+                  << percentile(t, 99) << ',' << phase.allocations << ','
+                  << phase.bytes << ',' << phase.peak_live_bytes << ','
+                  << phase.peak_rss_kb << ',' << phase.result << '\n';
+    }
+}
+
+/* Benchmark parse and all given parts of a day. Parts receive a const
+ * reference to the data returned by parse. */
+template <typename Parse, typename... Parts>
+int run(int argc, char *argv[], const std::string &day,
+        const std::string &input, Parse parse, Parts... parts) {
+    Options options = parse_options(argc, argv, input);
+    int n = options.repetitions;
+
+    bool header = !options.json && !std::getenv("BENCHMARK_NO_HEADER");
+    if (header && !options.baseline.empty()) {
+        std::cout << BASELINE_HEADER << '\n';
+    } else if (header) {
+        std::cout << "day,phase,repetitions,min_ns,median_ns,p99_ns,"
+                     "allocations,allocated_bytes,peak_live_bytes,peak_rss_kb,result\n";
+    }
+
+    auto data = parse(options.input);
+    report(day, measure("parse", n, [&]() {
+        return parse(options.input);
+    }, false), n, options);
+
+    const auto &parsed = data;
+    int part = 0;
+    (report(day, measure("part" + std::to_string(++part), n, [&]() {
+        return parts(parsed);
+    }), n, options), ...);
+
+    return 0;
+}
+
+}
+
+void *operator new(std::size_t size) {
+    ++benchmark::allocations;
+    benchmark::allocated_bytes += size;
+
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        std::size_t live = benchmark::live_bytes += malloc_usable_size(ptr);
+        std::size_t peak = benchmark::peak_live_bytes;
+        while (live > peak && !benchmark::peak_live_bytes.compare_exchange_weak(peak, live)) { }
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+/* Not inlined, or GCC sees memory from operator new released with free */
+__attribute__((noinline)) void operator delete(void *ptr) noexcept {
+    if (ptr) {
+        benchmark::live_bytes -= malloc_usable_size(ptr);
+    }
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+#endif
@@ -0,0 +1,266 @@
+#pragma once
+
+/* Opt-in cache of parsed inputs.
+ *
+ * If the AOC_CACHE environment variable names a directory, cache::cached
+ * saves the parsed input of a day there as a flat binary file named after the
+ * day and a hash of the input file. Later runs on the same input map that
+ * file and rebuild the parsed input with bulk copies instead of parsing it
+ * again. Without AOC_CACHE the input is always parsed.
+ *
+ * A day describes its parsed input with a save function writing to a
+ * cache::Writer and a load function reading it back from a cache::Reader in
+ * the same order. Only trivially copyable values and arrays of them can be
+ * written. The day passes a layout version, which it bumps whenever it
+ * changes what it saves, so that old cache files are not read.
+ *
+ * A cache file is only used if the size of the input and two independent 64
+ * bit hashes of it match those in its header.
+ */
+
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tokenizer.h"
+
+namespace cache {
+
+struct Header {
+    char magic[8];
+    std::uint32_t layout;
+    std::uint32_t reserved;
+    std::uint64_t size;
+    std::uint64_t input_size;
+    std::uint64_t hash;
+    std::uint64_t check;
+};
+
+constexpr char MAGIC[8] = { 'A', 'O', 'C', 'C', 'A', 'C', 'H', '2' };
+
+/* Values are 8 byte aligned, so arrays can be read in place from the mapping */
+constexpr std::size_t ALIGNMENT = 8;
+
+/* What identifies an input: its size and two hashes with different seeds */
+struct Key {
+    std::uint64_t input_size;
+    std::uint64_t hash;
+    std::uint64_t check;
+
+    bool operator==(const Key &) const = default;
+};
+
+/* Finalizer of MurmurHash3, every input bit affects every output bit */
+inline std::uint64_t mix(std::uint64_t x) {
+    x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdull;
+    x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53ull;
+    return x ^ (x >> 33);
+}
+
+/* Hash of the input, eight bytes at a time. Each word is mixed on its own
+ * before it is folded into the state, so a change in any byte of it changes
+ * all bits of the result. */
+inline std::uint64_t hash(std::string_view data, std::uint64_t seed) {
+    std::uint64_t h = mix(seed ^ data.size());
+    std::size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data.data() + i, 8);
+        h = (std::rotl(h, 29) ^ mix(word ^ seed)) * 0x9e3779b97f4a7c15ull;
+    }
+
+    // The rest is padded with zeros, which the size in the seed tells apart
+    std::uint64_t word = 0;
+    if (i < data.size()) {
+        std::memcpy(&word, data.data() + i, data.size() - i);
+    }
+    h = (std::rotl(h, 29) ^ mix(word ^ seed)) * 0x9e3779b97f4a7c15ull;
+    return mix(h);
+}
+
+inline Key key(std::string_view data) {
+    return { data.size(), hash(data, 0x243f6a8885a308d3ull), hash(data, 0x13198a2e03707344ull) };
+}
+
+struct Writer {
+    std::string data;
+
+    template <typename T>
+    void write(const T &value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        append(&value, sizeof(T));
+    }
+
+    /* Arrays are written as their length followed by their elements */
+    template <typename T>
+    void write(std::span<const T> values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(static_cast<std::uint64_t>(values.size()));
+        append(values.data(), values.size_bytes());
+    }
+
+    void append(const void *bytes, std::size_t size) {
+        data.append(static_cast<const char *>(bytes), size);
+        data.resize((data.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+    }
+};
+
+/* Reads back what a Writer wrote. Reading past the end of the data gives
+ * zeros and empty arrays and marks the reader as failed. */
+struct Reader {
+    std::string_view rest;
+    bool ok = true;
+
+    template <typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        if (auto bytes = take(sizeof(T)); bytes) {
+            std::memcpy(&value, bytes, sizeof(T));
+        }
+        return value;
+    }
+
+    /* The array points into the mapped cache file */
+    template <typename T>
+    std::span<const T> read_span() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        auto size = read<std::uint64_t>();
+        if (size > rest.size() / sizeof(T)) {
+            ok = false;
+            return {};
+        }
+        auto bytes = take(size * sizeof(T));
+        return { reinterpret_cast<const T *>(bytes), bytes ? size : 0 };
+    }
+
+    const char *take(std::size_t size) {
+        std::size_t padded = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        if (!ok || padded > rest.size()) {
+            ok = false;
+            return nullptr;
+        }
+        const char *bytes = rest.data();
+        rest.remove_prefix(padded);
+        return bytes;
+    }
+};
+
+/* Memory mapped cache file, empty if it is missing or does not match */
+struct File {
+    void *mapping = nullptr;
+    std::size_t mapping_size = 0;
+    std::string_view data;
+
+    File(const std::string &path, std::uint32_t layout, const Key &input) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(Header)) {
+            void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                mapping = p;
+                mapping_size = st.st_size;
+            }
+        }
+        close(fd);
+
+        if (mapping) {
+            Header header;
+            std::memcpy(&header, mapping, sizeof(header));
+            Key stored{ header.input_size, header.hash, header.check };
+            if (!std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) && header.layout == layout &&
+                    stored == input && header.size == mapping_size - sizeof(Header)) {
+                data = std::string_view(static_cast<const char *>(mapping) + sizeof(Header), header.size);
+            }
+        }
+    }
+
+    ~File() {
+        if (mapping) {
+            munmap(mapping, mapping_size);
+        }
+    }
+
+    File(const File &) = delete;
+    File &operator=(const File &) = delete;
+};
+
+/* Write to a temporary file first, so that concurrent runs never see a
+ * partially written cache */
+inline void save(const std::string &path, std::uint32_t layout, const Key &input,
+                 const Writer &writer) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.layout = layout;
+    header.size = writer.data.size();
+    header.input_size = input.input_size;
+    header.hash = input.hash;
+    header.check = input.check;
+
+    std::string temporary = path + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(temporary, std::ios::binary);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(writer.data.data(), writer.data.size());
+        if (!out) {
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    std::rename(temporary.c_str(), path.c_str());
+}
+
+/* Return the parsed input of filename, from the cache if possible */
+template <typename Parse, typename Save, typename Load>
+auto cached(const std::string &filename, std::string_view day, std::uint32_t layout,
+            Parse parse, Save save_input, Load load_input) {
+    const char *directory = std::getenv("AOC_CACHE");
+    if (!directory || !*directory) {
+        return parse(filename);
+    }
+
+    Key input_key;
+    {
+        Tokenizer input(filename);
+        input_key = key(input.rest);
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "-%016llx.bin", (unsigned long long) input_key.hash);
+    std::string path = std::string(directory) + "/" + std::string(day) + name;
+
+    {
+        File file(path, layout, input_key);
+        if (!file.data.empty()) {
+            Reader reader{ file.data };
+            auto input = load_input(reader);
+            if (reader.ok && reader.rest.empty()) {
+                return input;
+            }
+        }
+    }
+
+    auto input = parse(filename);
+    Writer writer;
+    save_input(writer, input);
+    save(path, layout, input_key, writer);
+    return input;
+}
+
+}
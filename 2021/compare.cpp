@@ -0,0 +1,217 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/* Comparison of benchmark runs against a recorded baseline.
+ *
+ *     ./compare [--alpha 0.01] [--threshold 0.05] baseline.csv current.csv
+ *
+ * Both files hold the rows the benchmarks print with --baseline (see
+ * benchmark.h and bench.sh), one per day, phase and input scale with all
+ * timings of the phase. For each phase in both files the timings are compared
+ * with a one-sided Mann-Whitney U test, and a bootstrap confidence interval
+ * of the ratio of the medians estimates how much slower or faster it got. A
+ * phase is flagged as slower if the test is significant at alpha and the
+ * whole interval is above 1 + threshold, and as faster the other way around.
+ * Peak live heap bytes are deterministic, so they are flagged as soon as they
+ * grow by more than the threshold.
+ *
+ * The exit status is 1 if any phase got slower or uses more memory.
+ */
+
+typedef std::tuple<std::string, std::string, std::string> Key;
+
+struct Row {
+    long long median_ns = 0;
+    long long peak_live_bytes = 0;
+    std::vector<double> samples;
+};
+
+struct Options {
+    double alpha = 0.01;
+    double threshold = 0.05;
+    std::string baseline;
+    std::string current;
+};
+
+/* Rows by day, phase and scale. Lines that do not parse are skipped. */
+std::map<Key, Row> read_rows(const std::string &filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Cannot read " << filename << '\n';
+        std::exit(2);
+    }
+
+    std::map<Key, Row> rows;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 9 || fields[0] == "day") {
+            continue;
+        }
+
+        Row row;
+        row.median_ns = std::atoll(fields[4].c_str());
+        row.peak_live_bytes = std::atoll(fields[6].c_str());
+        std::stringstream samples(fields[8]);
+        for (double ns; samples >> ns;) {
+            row.samples.push_back(ns);
+        }
+        if (!row.samples.empty()) {
+            rows[{ fields[0], fields[1], fields[2] }] = row;
+        }
+    }
+    return rows;
+}
+
+double median(std::vector<double> values) {
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
+
+/* Probability of a U statistic of a at least this large if a and b come from
+ * the same distribution, i.e. a one-sided p-value for a being larger. Uses the
+ * normal approximation with tie and continuity corrections. */
+double mann_whitney(const std::vector<double> &a, const std::vector<double> &b) {
+    std::vector<std::pair<double, bool>> all;
+    for (double x : a) all.push_back({ x, true });
+    for (double x : b) all.push_back({ x, false });
+    std::sort(all.begin(), all.end());
+
+    // Ties share the average of their ranks
+    double rank_sum = 0, ties = 0;
+    for (std::size_t i = 0; i < all.size();) {
+        std::size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first) ++j;
+        double rank = (i + j + 1) / 2.0;
+        for (std::size_t k = i; k < j; ++k) {
+            rank_sum += all[k].second ? rank : 0;
+        }
+        double t = j - i;
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    double n1 = a.size(), n2 = b.size(), n = n1 + n2;
+    double u = rank_sum - n1 * (n1 + 1) / 2;
+    double variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+    if (variance <= 0) {
+        return 0.5;
+    }
+    double z = (u - n1 * n2 / 2 - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+/* Bootstrap confidence interval at the given level of the ratio of the median
+ * of a to the median of b. The generator is seeded, so the same files always
+ * give the same interval. */
+std::pair<double, double> bootstrap_ratio(const std::vector<double> &a,
+                                          const std::vector<double> &b, double level) {
+    const int RESAMPLES = 2000;
+    std::mt19937_64 rng(42);
+    std::vector<double> ratios, resample_a(a.size()), resample_b(b.size());
+
+    for (int i = 0; i < RESAMPLES; ++i) {
+        for (double &x : resample_a) {
+            x = a[std::uniform_int_distribution<std::size_t>(0, a.size() - 1)(rng)];
+        }
+        for (double &x : resample_b) {
+            x = b[std::uniform_int_distribution<std::size_t>(0, b.size() - 1)(rng)];
+        }
+        ratios.push_back(median(resample_a) / std::max(1.0, median(resample_b)));
+    }
+
+    std::sort(ratios.begin(), ratios.end());
+    std::size_t tail = (1 - level) / 2 * RESAMPLES;
+    return { ratios[tail], ratios[RESAMPLES - 1 - tail] };
+}
+
+Options parse_options(int argc, char *argv[]) {
+    Options options;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--alpha") && i + 1 < argc) {
+            options.alpha = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--threshold") && i + 1 < argc) {
+            options.threshold = std::atof(argv[++i]);
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (files.size() != 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--alpha 0.01] [--threshold 0.05] baseline.csv current.csv\n";
+        std::exit(2);
+    }
+    options.baseline = files[0];
+    options.current = files[1];
+    return options;
+}
+
+int main(int argc, char *argv[]) {
+    Options options = parse_options(argc, argv);
+    auto baseline = read_rows(options.baseline);
+    auto current = read_rows(options.current);
+
+    std::printf("%-8s %-6s %-8s %14s %14s %8s %17s %9s  %s\n", "day", "phase", "scale",
+                "baseline ns", "current ns", "change", "interval", "p", "verdict");
+
+    int regressions = 0;
+    for (const auto &[key, row] : current) {
+        const auto &[day, phase, scale] = key;
+        auto it = baseline.find(key);
+        if (it == baseline.end()) {
+            std::printf("%-8s %-6s %-8s %14s %14lld %8s %17s %9s  new\n", day.c_str(),
+                        phase.c_str(), scale.c_str(), "-", row.median_ns, "-", "-", "-");
+            continue;
+        }
+
+        const Row &base = it->second;
+        double slower = mann_whitney(row.samples, base.samples);
+        double faster = mann_whitney(base.samples, row.samples);
+        auto [low, high] = bootstrap_ratio(row.samples, base.samples, 1 - 2 * options.alpha);
+        double change = median(row.samples) / std::max(1.0, median(base.samples)) - 1;
+
+        std::string verdict = "same";
+        if (slower < options.alpha && low > 1 + options.threshold) {
+            verdict = "SLOWER";
+            ++regressions;
+        } else if (faster < options.alpha && high < 1 - options.threshold) {
+            verdict = "faster";
+        }
+        if (row.peak_live_bytes > base.peak_live_bytes * (1 + options.threshold)) {
+            verdict += ", MORE MEMORY (" + std::to_string(base.peak_live_bytes) + " -> "
+                       + std::to_string(row.peak_live_bytes) + " bytes)";
+            ++regressions;
+        }
+
+        char interval[32];
+        std::snprintf(interval, sizeof(interval), "[%.3f, %.3f]", low, high);
+        std::printf("%-8s %-6s %-8s %14lld %14lld %+7.1f%% %17s %9.2g  %s\n", day.c_str(),
+                    phase.c_str(), scale.c_str(), base.median_ns, row.median_ns,
+                    100 * change, interval, std::min(slower, faster), verdict.c_str());
+    }
+
+    if (regressions) {
+        std::cerr << regressions << " regression(s) against " << options.baseline << '\n';
+    }
+    return regressions ? 1 : 0;
+}
@@ -1,65 +1,169 @@
 #include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <cassert>
 
-/* Read and parse input file <filename> */
-std::vector<int> read_file(std::string filename) {
-    std::ifstream fin; 
-    fin.open(filename);
-    
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+#include "benchmark.h"
+#include "tokenizer.h"
+
+/* Counts of increases of consecutive measurements and of window sums */
+typedef std::pair<std::size_t, std::size_t> Increases;
+
+/* Measurements parsed at a time when streaming the input */
+constexpr std::size_t CHUNK_SIZE = 1 << 12;
+
+/* Example from the puzzle description */
+constexpr std::string_view EXAMPLE = "199\n200\n208\n210\n200\n207\n240\n269\n260\n263\n";
+
+/* Parse the measurements, one per line */
+constexpr std::vector<int> parse(Tokenizer &in) {
     int input;
     std::vector<int> inputs;
-    while (fin >> input) {
+    while (in.next_int(input)) {
         inputs.push_back(input);
     }
 
     return inputs;
 }
 
-/* Count number of increases of consecutive measurements */
-int num_of_increases(const std::vector<int> input) {
-    int increases = 0;
-    for (decltype(input.size()) i = 1; i < input.size(); ++i) {
-        increases += input[i] > input[i - 1];
+/* Read and parse input file <filename> */
+std::vector<int> read_file(std::string filename) {
+    Tokenizer in(filename);
+    return parse(in);
+}
+
+#ifdef __x86_64__
+inline bool has_avx2() {
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+/* Count increases like count_increases for eight measurements at a time, and
+ * return the index of the first measurement that is left to the caller */
+__attribute__((target("avx2")))
+std::size_t count_increases_avx2(const int *data, std::size_t size, std::size_t lag,
+                                 std::size_t &increases) {
+    // Lanes count at most 2^31 increases before they are added up
+    constexpr std::size_t BATCH = std::size_t(8) << 31;
+
+    std::size_t i = 0;
+    while (i + lag + 8 <= size) {
+        std::size_t end = std::min(size - lag - 7, i + BATCH);
+        __m256i counts = _mm256_setzero_si256();
+        for (; i < end; i += 8) {
+            __m256i before = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            __m256i after = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + lag));
+            // Lanes that increased are all ones, i.e. -1
+            counts = _mm256_sub_epi32(counts, _mm256_cmpgt_epi32(after, before));
+        }
+
+        alignas(32) std::uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), counts);
+        for (std::uint32_t lane : lanes) {
+            increases += lane;
+        }
+    }
+
+    return i;
+}
+#endif
+
+/* Count measurements that are larger than the one lag places before them.
+ * A window of three measurements has a larger sum than the previous window
+ * exactly when the measurement entering it is larger than the one leaving
+ * it, so lag 1 counts increases of measurements and lag 3 of window sums. */
+constexpr std::size_t count_increases(const int *data, std::size_t size, std::size_t lag) {
+    std::size_t increases = 0;
+    std::size_t i = 0;
+
+#ifdef __x86_64__
+    if (!std::is_constant_evaluated() && has_avx2()) {
+        i = count_increases_avx2(data, size, lag, increases);
+    }
+#endif
+
+    for (; i + lag < size; ++i) {
+        increases += data[i + lag] > data[i];
     }
     return increases;
 }
 
+/* Count number of increases of consecutive measurements */
+constexpr std::size_t num_of_increases(const std::vector<int> &input) {
+    return count_increases(input.data(), input.size(), 1);
+}
+
 /* Count number of increases of consecutive window sums */
-int num_of_increases_window(const std::vector<int> input) {
-    int increases = 0;
-
-    // We need at least 3 measurements to calculate the first window
-    if (input.size() >= 3) {
-        int prev_window = input[0] + input[1] + input[2];
-        
-        // Calculate the next window sum
-        for (decltype(input.size()) i = 1; i + 2 < input.size(); ++i) {
-            int curr_window = input[i] + input[i + 1] + input[i + 2];  
-            increases += curr_window > prev_window;
-
-            // Save current window sum for next iteration
-            prev_window = curr_window;
+constexpr std::size_t num_of_increases_window(const std::vector<int> &input) {
+    return count_increases(input.data(), input.size(), 3);
+}
+
+/* Count both kinds of increases in a single pass over the input, which is
+ * parsed a chunk at a time so that memory use does not grow with its size */
+constexpr Increases stream_increases(Tokenizer &in) {
+    // The last three measurements of a chunk are carried over to the next
+    // one, where they are compared to the measurements after them
+    std::array<int, CHUNK_SIZE + 3> chunk{};
+    std::size_t carried = 0;
+    Increases increases = { 0, 0 };
+
+    bool more = true;
+    while (more) {
+        std::size_t size = carried;
+        int input;
+        while (size < chunk.size() && (more = in.next_int(input))) {
+            chunk[size++] = input;
         }
+
+        // Count only pairs with a new measurement, the others were counted
+        // with the previous chunk
+        std::size_t first = carried >= 1 ? carried - 1 : 0;
+        std::size_t window = carried >= 3 ? carried - 3 : 0;
+        increases.first += count_increases(chunk.data() + first, size - first, 1);
+        increases.second += count_increases(chunk.data() + window, size - window, 3);
+
+        carried = std::min<std::size_t>(size, 3);
+        std::copy(chunk.begin() + size - carried, chunk.begin() + size, chunk.begin());
     }
 
     return increases;
 }
 
-/* Test small cases */
-void test() {
-    std::vector<int> test_inputs = read_file("inputs/input1_test.txt");
-    assert(num_of_increases(test_inputs) == 7);
-    assert(num_of_increases_window(test_inputs) == 5);
+/* Test small cases at compile time */
+constexpr bool test() {
+    Tokenizer in(EXAMPLE);
+    std::vector<int> test_inputs = parse(in);
+
+    Tokenizer stream(EXAMPLE);
+    return num_of_increases(test_inputs) == 7 && num_of_increases_window(test_inputs) == 5 &&
+           stream_increases(stream) == Increases{ 7, 5 };
 }
 
-int main() {
-    test(); 
+static_assert(test());
 
-    std::vector<int> inputs = read_file("inputs/input1.txt");
-    std::cout << num_of_increases(inputs) << std::endl;
-    std::cout << num_of_increases_window(inputs) << std::endl;
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_1", "inputs/input1.txt", read_file,
+        num_of_increases, num_of_increases_window);
+}
+#else
+int main() {
+    std::string filename = "inputs/input1.txt";
+    Tokenizer in(filename);
+    auto [increases, window_increases] = stream_increases(in);
+    std::cout << increases << std::endl;
+    std::cout << window_increases << std::endl;
 
     return 0;
 }
+#endif
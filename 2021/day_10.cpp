@@ -1,10 +1,15 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
-#include <stack>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <thread>
 #include <cassert>
 #include <algorithm>
 
+#include "benchmark.h"
+#include "tokenizer.h"
+
 const int SCORE_BRACKET = 3;
 const int SCORE_SQUARE = 57;
 const int SCORE_CURLY = 1197;
@@ -15,148 +20,168 @@ const int SCORE_SQUARE_CLOSE = 2;
 const int SCORE_CURLY_CLOSE = 3;
 const int SCORE_ANGLE_CLOSE = 4;
 
-std::vector<std::string> read_file(const std::string &filename) {
-    std::vector<std::string> data;
-
-    std::ifstream in;
-    in.open(filename);
-
-    std::string line; 
-    while (std::getline(in, line)) {
-        data.push_back(line);
-    }
-
-    return data;
-}
+/* Scores of the kinds of brackets ( [ { < in this order */
+const int ERROR_SCORES[] = { SCORE_BRACKET, SCORE_SQUARE, SCORE_CURLY, SCORE_ANGLE };
+const int COMPLETION_SCORES[] = { SCORE_BRACKET_CLOSE, SCORE_SQUARE_CLOSE, SCORE_CURLY_CLOSE, SCORE_ANGLE_CLOSE };
 
-/* Calculate syntax error score for given lines of code */
-int syntax_error_score(const std::vector<std::string> &data) {
-    int score = 0;
+/* Smallest part of the input worth a thread of its own */
+constexpr std::size_t MIN_CHUNK_SIZE = 1 << 20;
 
-    for (const std::string &line : data) {
-        // Put opening brackets on a stack
-        std::stack<char> brackets;
+constexpr std::int8_t NEWLINE = 5;
 
-        for (char c : line) {
-            if (c == '(' || c == '[' || c == '{' || c == '<') {
-                // Push opening brackets
-                brackets.push(c);
-            } else {
-                // Try to pop closing brackets
-                char closing = brackets.top();
-                closing = closing == '(' ? ')' :
-                          closing == '[' ? ']' :
-                          closing == '{' ? '}' :
-                          closing == '<' ? '>' : closing;
-
-                if (c == closing) {
-                    // We found a matching closing bracket
-                    brackets.pop();
-                } else {
-                    // This line is corrupted
-                    switch (c) {
-                        case ')':
-                            score += SCORE_BRACKET;
-                            break;
-                        case ']':
-                            score += SCORE_SQUARE;
-                            break;
-                        case '}':
-                            score += SCORE_CURLY;
-                            break;
-                        case '>':
-                            score += SCORE_ANGLE;
-                            break;
-                    }    
-                    break;
+/* Class of every byte, 1 to 4 for opening brackets of each kind, -1 to -4 for
+ * closing brackets, NEWLINE at the end of a line and 0 for anything else */
+constexpr std::array<std::int8_t, 256> CLASSES = [] {
+    std::array<std::int8_t, 256> classes{};
+    for (int kind = 0; kind < 4; ++kind) {
+        classes[static_cast<unsigned char>("([{<"[kind])] = kind + 1;
+        classes[static_cast<unsigned char>(")]}>"[kind])] = -(kind + 1);
+    }
+    classes['\n'] = NEWLINE;
+    return classes;
+}();
+
+/* Syntax error score of all corrupted lines and completion scores of all
+ * incomplete lines */
+struct Report {
+    long long error_score = 0;
+    std::vector<long long> completion_scores;
+
+    void merge(const Report &other) {
+        error_score += other.error_score;
+        completion_scores.insert(completion_scores.end(), other.completion_scores.begin(),
+                                 other.completion_scores.end());
+    }
+};
+
+/* Check all lines of text in one pass. Open brackets go on a byte stack that
+ * is reused for all lines and only grows for deeper lines than before. */
+Report validate(std::string_view text) {
+    Report report;
+    std::vector<std::uint8_t> stack(1 << 12);
+    std::size_t depth = 0;
+
+    for (std::size_t i = 0; i <= text.size(); ++i) {
+        std::int8_t c = i < text.size() ? CLASSES[static_cast<unsigned char>(text[i])] : NEWLINE;
+
+        if (c == NEWLINE) {
+            // Calculate score based on missing brackets, if there are any
+            if (depth > 0) {
+                long long score = 0;
+                while (depth > 0) {
+                    score = 5 * score + COMPLETION_SCORES[stack[--depth]];
                 }
+                report.completion_scores.push_back(score);
+            }
+        } else if (c > 0) {
+            if (depth == stack.size()) {
+                stack.resize(2 * stack.size());
+            }
+            stack[depth++] = c - 1;
+        } else if (c < 0) {
+            if (depth > 0 && stack[depth - 1] == -c - 1) {
+                // We found a matching closing bracket
+                --depth;
+            } else {
+                // This line is corrupted, skip the rest of it
+                report.error_score += ERROR_SCORES[-c - 1];
+                depth = 0;
+                i = std::min(text.find('\n', i), text.size());
             }
         }
     }
 
-    return score;
+    return report;
 }
 
-/* Calculate completion score and return the middle one */
-long middle_score(const std::vector<std::string> &data) {
-    std::vector<long> scores;
+/* Check the lines of text on up to <threads> threads, each of which takes a
+ * chunk of whole lines of at least MIN_CHUNK_SIZE bytes */
+Report validate_parallel(std::string_view text, unsigned threads) {
+    threads = std::clamp<std::size_t>(text.size() / MIN_CHUNK_SIZE, 1, std::max(threads, 1u));
+
+    std::vector<Report> reports(threads);
+    std::vector<std::thread> workers;
+    std::size_t begin = 0;
+    for (unsigned i = 0; i < threads; ++i) {
+        // Every chunk but the last ends after the first newline past its share
+        std::size_t end = text.size();
+        if (i + 1 < threads) {
+            end = std::min(text.find('\n', std::max(begin, text.size() / threads * (i + 1))),
+                           text.size() - 1) + 1;
+        }
 
-    for (const std::string &line : data) {
-        // Put opening brackets on a stack
-        std::stack<char> brackets;
-        bool corrupted = false;
+        workers.emplace_back([&reports, i, chunk = text.substr(begin, end - begin)]() {
+            reports[i] = validate(chunk);
+        });
+        begin = end;
+    }
 
-        for (char c : line) {
-            if (c == '(' || c == '[' || c == '{' || c == '<') {
-                // Push opening brackets
-                brackets.push(c);
-            } else {
-                // Try to pop closing brackets
-                char closing = brackets.top();
-                closing = closing == '(' ? ')' :
-                          closing == '[' ? ']' :
-                          closing == '{' ? '}' :
-                          closing == '<' ? '>' : closing;
-
-                if (c == closing) {
-                    // We found a matching closing bracket
-                    brackets.pop();
-                } else {
-                    // Skip corrupted lines
-                    corrupted = true;
-                    break;
-                }
-            }
-        }
+    Report report;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers[i].join();
+        report.merge(reports[i]);
+    }
+    return report;
+}
 
-        if (corrupted || brackets.empty()) {
-            continue;
-        }
+/* Check all lines of the file while reading it */
+Report read_file(const std::string &filename) {
+    Tokenizer in(filename);
+    return validate_parallel(in.rest, std::thread::hardware_concurrency());
+}
 
-        // Calculate score based on missing brackets
-        long score = 0;
-        while (!brackets.empty()) {
-            char bracket = brackets.top(); 
-            brackets.pop();
-
-            score *= 5;
-            switch (bracket) {
-                case '(':
-                    score += SCORE_BRACKET_CLOSE;
-                    break;
-                case '[':
-                    score += SCORE_SQUARE_CLOSE;
-                    break;
-                case '{':
-                    score += SCORE_CURLY_CLOSE;
-                    break;
-                case '<':
-                    score += SCORE_ANGLE_CLOSE;
-                    break;
-            }
-        }
+/* Syntax error score of the corrupted lines */
+long long syntax_error_score(const Report &report) {
+    return report.error_score;
+}
 
-        scores.push_back(score);
+/* Middle completion score, selected without sorting all of them */
+long long middle_score(const Report &report) {
+    if (report.completion_scores.empty()) {
+        return 0;
     }
-    
-    // Sort scores and return the middle one
-    std::sort(scores.begin(), scores.end());
-    return scores[scores.size() / 2];
+
+    std::vector<long long> scores = report.completion_scores;
+    auto middle = scores.begin() + scores.size() / 2;
+    std::nth_element(scores.begin(), middle, scores.end());
+    return *middle;
 }
 
 void test() {
-    std::vector<std::string> test_data = read_file("inputs/input10_test.txt");
+    Report test_data = read_file("inputs/input10_test.txt");
 
     assert(syntax_error_score(test_data) == 26397);
     assert(middle_score(test_data) == 288957);
+
+    // Chunks of whole lines, without a final newline
+    Tokenizer in(std::string("inputs/input10_test.txt"));
+    std::string_view text = in.rest.substr(0, in.rest.find_last_not_of('\n') + 1);
+    for (std::size_t chunks = 1; chunks <= 12; ++chunks) {
+        Report report;
+        std::size_t begin = 0;
+        for (std::size_t i = 1; i <= chunks; ++i) {
+            std::size_t end = std::min(text.find('\n', text.size() * i / chunks), text.size());
+            report.merge(validate(text.substr(begin, end - begin)));
+            begin = end;
+        }
+        assert(syntax_error_score(report) == 26397);
+        assert(middle_score(report) == 288957);
+    }
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_10", "inputs/input10.txt", read_file,
+        syntax_error_score, middle_score);
+}
+#else
 int main() {
     test();
     
-    std::vector<std::string> data = read_file("inputs/input10.txt");
+    Report data = read_file("inputs/input10.txt");
     std::cout << syntax_error_score(data) << std::endl;
     std::cout << middle_score(data) << std::endl;
 
     return 0;
 }
+#endif
@@ -1,14 +1,23 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
-#include <queue>
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 
-struct Octopus {
-    int y;
-    int x;
-};
+#include "benchmark.h"
+#include "tokenizer.h"
+#include "grid.h"
+
+typedef Grid<std::uint8_t> Octopuses;
+
+/* Octopuses about to flash, as one bit per cell of the grid */
+typedef std::vector<std::uint64_t> Frontier;
+
+/* Energy of a flashing octopus. The padding is set to it, so it never
+ * gains energy from its neighbors and never flashes. */
+const std::uint8_t FLASH = 10;
 
 const int NEIGHBORS[8][2] = {
     { -1, -1 }, { -1, 0 }, { -1, 1},
@@ -16,125 +25,210 @@ const int NEIGHBORS[8][2] = {
     { 1, -1 }, { 1, 0 }, { 1, 1},
 };
 
-std::vector<std::vector<int>> read_file(const std::string &filename) {
-    std::vector<std::vector<int>> grid;
+Octopuses read_file(const std::string &filename) {
+    Tokenizer in(filename);
 
-    std::ifstream in;
-    in.open(filename);
+    std::vector<std::string_view> lines;
+    std::string_view line;
+    while (in.next_line(line)) {
+        lines.push_back(line);
+    }
 
-    std::string line_str;
-    while (std::getline(in, line_str)) {
-        std::vector<int> nums;
-        std::istringstream line(line_str);
-        
-        char c;
-        while (line >> c) {
-            nums.push_back(c - '0');
+    return make_grid(lines, 1, FLASH, [](char c) { return static_cast<std::uint8_t>(c - '0'); });
+}
+
+/* Simulate one step of the iteration and return number of flashes. The
+ * frontier holds no bits between steps. */
+int simulate_step(Octopuses &octopuses, Frontier &frontier) {
+    frontier.resize((octopuses.cells.size() + 63) / 64);
+
+    // Increase energy level of each octopus a row at a time, which the
+    // compiler vectorizes, then mark the ones that flash
+    for (int y = 0; y < octopuses.rows; ++y) {
+        auto row = octopuses.row(y);
+        for (std::uint8_t &energy : row) {
+            ++energy;
         }
 
-        grid.push_back(nums);
+        int first = octopuses.index(y, 0);
+        for (int x = 0; x < octopuses.cols; ++x) {
+            if (row[x] == FLASH) {
+                frontier[(first + x) / 64] |= std::uint64_t(1) << ((first + x) % 64);
+            }
+        }
     }
 
-    return grid;
-}
+    // Flash octopuses from the lowest bit of the frontier on. Neighbors in
+    // the row above may add bits before it, so the scan steps back to them.
+    int offsets[8];
+    for (int i = 0; i < 8; ++i) {
+        offsets[i] = octopuses.offset(NEIGHBORS[i][0], NEIGHBORS[i][1]);
+    }
 
-/* Simulate one step of the iteration and return number of flashes */
-int simulate_step(std::vector<std::vector<int>> &octopuses) {
     int flashes = 0;
-    std::queue<Octopus> to_flash;
-
-    // Increase energy level of each octopus
-    for (int y = 0; y < octopuses.size(); ++y) {
-        for (int x = 0; x < octopuses[y].size(); ++x) {
-            int &energy = octopuses[y][x];
-
-            // Only increase energy if smaller than 10
-            if (energy < 10) {
-                // Increase energy and check if octopus flashes
-                if (++energy == 10) {
-                    Octopus o = { y, x };
-                    to_flash.push(o);
-                    ++flashes;
-                }
-            }
-        } 
-    }
+    for (std::size_t word = 0; word < frontier.size();) {
+        if (!frontier[word]) {
+            ++word;
+            continue;
+        }
 
-    // Flash octopuses
-    while (!to_flash.empty()) {
-        Octopus o = to_flash.front();
-        to_flash.pop();
+        int o = word * 64 + std::countr_zero(frontier[word]);
+        frontier[word] &= frontier[word] - 1;
+        ++flashes;
 
         // Increase energy of neighbors if they are not flashing
-        for (int i = 0; i < 8; ++i) {
-            int dy = NEIGHBORS[i][0];
-            int dx = NEIGHBORS[i][1];
-
-            int new_y = o.y + dy;
-            int new_x = o.x + dx;
-
-            if (new_y >= 0 && new_y < octopuses.size() &&
-                    new_x >=0 && new_x < octopuses[new_y].size()) {
-                int &energy = octopuses[new_y][new_x];
-
-                if (energy < 10 && ++energy == 10) {
-                    Octopus o = { new_y, new_x };
-                    to_flash.push(o);
-                    ++flashes;
-                }
+        for (int offset : offsets) {
+            int neighbor = o + offset;
+            std::uint8_t &energy = octopuses[neighbor];
+
+            if (energy < FLASH && ++energy == FLASH) {
+                frontier[neighbor / 64] |= std::uint64_t(1) << (neighbor % 64);
+                word = std::min<std::size_t>(word, neighbor / 64);
             }
         }
     }
 
     // Reset energy 10 to 0
-    for (std::vector<int> &line : octopuses) {
-        for (int &octopus : line) {
-            octopus = octopus == 10 ? 0 : octopus;
+    for (int y = 0; y < octopuses.rows; ++y) {
+        for (std::uint8_t &octopus : octopuses.row(y)) {
+            octopus = octopus == FLASH ? 0 : octopus;
         }
     }
 
     return flashes;
 }
 
-/* Calculate number of flashes in 100 steps */
-int num_of_flashes(std::vector<std::vector<int>> octopuses) {
-    int flashes = 0;
+/* Hash of the energy levels, compared before whole grids */
+std::uint64_t state_hash(const Octopuses &octopuses) {
+    std::uint64_t h = 14695981039346656037ull;
+    std::size_t i = 0, size = octopuses.cells.size();
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, octopuses.cells.data() + i, 8);
+        h = (h ^ word) * 1099511628211ull;
+    }
+    for (; i < size; ++i) {
+        h = (h ^ octopuses.cells[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+/* Steps of the octopuses that notices when their state repeats, with Brent's
+ * algorithm. It keeps the state at the last power of two steps and the
+ * flashes of every step since then. Once the state equals that saved state,
+ * every step from there on repeats with that period. */
+struct Simulation {
+    Octopuses octopuses;
+    Frontier frontier;
+    long long steps = 0;
+
+    Octopuses saved;
+    std::uint64_t saved_hash;
+    long long power = 1;
+    std::vector<int> flashes_since_saved;
+    long long period = 0;
+
+    explicit Simulation(Octopuses octopuses)
+        : octopuses(octopuses), saved(octopuses), saved_hash(state_hash(octopuses)) { }
+
+    /* Simulate one step and return its flashes */
+    int step() {
+        int flashes = simulate_step(octopuses, frontier);
+        ++steps;
+        flashes_since_saved.push_back(flashes);
+
+        std::uint64_t hash = state_hash(octopuses);
+        if (hash == saved_hash && octopuses == saved) {
+            period = flashes_since_saved.size();
+        } else if ((long long) flashes_since_saved.size() == power) {
+            saved = octopuses;
+            saved_hash = hash;
+            power *= 2;
+            flashes_since_saved.clear();
+        }
+
+        return flashes;
+    }
+
+    /* Flashes of the step after a number of steps past the current one,
+     * once the period is known */
+    int flashes_ahead(long long steps) const {
+        return flashes_since_saved[steps % period];
+    }
+};
+
+/* Calculate number of flashes in <steps> steps, jumping ahead whole periods
+ * once the state repeats */
+long long flashes_after(const Octopuses &octopuses, long long steps) {
+    Simulation simulation(octopuses);
+    long long flashes = 0;
+
+    while (simulation.steps < steps && !simulation.period) {
+        flashes += simulation.step();
+    }
+
+    if (simulation.steps < steps) {
+        long long rest = steps - simulation.steps, period = simulation.period;
+        long long per_period = 0;
+        for (long long i = 0; i < period; ++i) {
+            per_period += simulation.flashes_ahead(i);
+        }
 
-    // Simulate <steps> steps
-    for (int step = 1; step <= 100; ++step) {
-        flashes += simulate_step(octopuses);
+        flashes += rest / period * per_period;
+        for (long long i = 0; i < rest % period; ++i) {
+            flashes += simulation.flashes_ahead(i);
+        }
     }
-        
+
     return flashes;
-} 
+}
+
+/* Calculate number of flashes in 100 steps */
+long long num_of_flashes(const Octopuses &octopuses) {
+    return flashes_after(octopuses, 100);
+}
 
-/* Find number of steps required for all octopuses to flash at once */
-int flash_sync(std::vector<std::vector<int>> octopuses) {
-    int steps = 1;
-    int octopuses_num = octopuses.size() * octopuses[0].size();
+/* Find number of steps required for all octopuses to flash at once, or -1 if
+ * the state repeats before that, so that they never do */
+long long flash_sync(const Octopuses &octopuses) {
+    Simulation simulation(octopuses);
+    int octopuses_num = octopuses.rows * octopuses.cols;
 
     // Simulate steps until all octopuses flash
-    while (simulate_step(octopuses) != octopuses_num) {
-        ++steps;
+    while (simulation.step() != octopuses_num) {
+        if (simulation.period) {
+            return -1;
+        }
     }
 
-    return steps;
+    return simulation.steps;
 }
 
 void test() {
-    std::vector<std::vector<int>> test_data = read_file("inputs/input11_test.txt");
+    Octopuses test_data = read_file("inputs/input11_test.txt");
 
     assert(num_of_flashes(test_data) == 1656);
     assert(flash_sync(test_data) == 195);
+
+    // After syncing at step 195 all flash every 10 steps, 100 flashes each
+    [[maybe_unused]] long long at_sync = flashes_after(test_data, 195);
+    assert(flashes_after(test_data, 1000000000) == at_sync + (1000000000LL - 195) / 10 * 100);
+    assert(flashes_after(test_data, 1000000005) == at_sync + (1000000005LL - 195) / 10 * 100);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_11", "inputs/input11.txt", read_file,
+        num_of_flashes, flash_sync);
+}
+#else
 int main() {
     test();
 
-    std::vector<std::vector<int>> data = read_file("inputs/input11.txt");
+    Octopuses data = read_file("inputs/input11.txt");
     std::cout << num_of_flashes(data) << std::endl;
     std::cout << flash_sync(data) << std::endl;
     
     return 0;
 }
-
+#endif
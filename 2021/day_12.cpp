@@ -1,11 +1,13 @@
 #include <iostream>
-#include <fstream>
 #include <cassert>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
 #include <cctype>
 
+#include "benchmark.h"
+#include "tokenizer.h"
+
 typedef std::unordered_map<std::string, std::vector<std::string>> Graph;
 
 const std::string START("start");
@@ -14,15 +16,14 @@ const std::string END("end");
 Graph read_file(const std::string &filename) {
     Graph data;
     
-    std::ifstream in;
-    in.open(filename);
+    Tokenizer in(filename);
 
-    std::string line;
-    while (std::getline(in, line)) {
+    std::string_view line;
+    while (in.next_line(line)) {
         // Parse current edge end points
         decltype(line.size()) index = line.find('-');
-        std::string a = line.substr(0, index);
-        std::string b = line.substr(index + 1);
+        std::string a(line.substr(0, index));
+        std::string b(line.substr(index + 1));
 
         // Create empty vectors for nodes if not yet present
         if (data.find(a) == data.end()) {
@@ -96,6 +97,12 @@ void test() {
     assert(num_of_paths_longer(test_data3) == 3509);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_12", "inputs/input12.txt", read_file,
+        num_of_paths, num_of_paths_longer);
+}
+#else
 int main() {
     test();
 
@@ -105,3 +112,4 @@ int main() {
 
     return 0;
 }
+#endif
@@ -1,12 +1,13 @@
 #include <iostream>
-#include <fstream>
 #include <cassert>
 #include <utility>
 #include <vector>
 #include <unordered_set>
-#include <regex>
 #include <string>
 
+#include "benchmark.h"
+#include "tokenizer.h"
+
 struct Point {
     int x;
     int y;
@@ -40,19 +41,20 @@ read_file(const std::string &filename) {
     Grid grid;
     std::vector<Fold> folds;
     
-    std::ifstream in;
-    in.open(filename);
-    std::string line; 
-
-    std::regex point_regex("(\\d+),(\\d+)");
-    std::regex fold_regex("fold along (x|y)=(\\d+)");
-    std::smatch match;
-
-    while (std::getline(in, line)) {
-        if (std::regex_match(line, match, point_regex)) {
-            grid.insert(Point(std::stoi(match[1]), std::stoi(match[2])));
-        } else if (std::regex_match(line, match, fold_regex)) {
-            folds.push_back(Fold(match.str(1)[0], std::stoi(match[2])));
+    Tokenizer in(filename);
+    std::string_view line; 
+
+    // Lines are either points x,y or folds "fold along x=c"
+    const std::string_view fold_prefix = "fold along ";
+
+    while (in.next_line(line)) {
+        Tokenizer numbers(line);
+        int x, y;
+        if (line.substr(0, fold_prefix.size()) == fold_prefix) {
+            numbers.next_uint(x);
+            folds.push_back(Fold(line[fold_prefix.size()], x));
+        } else if (numbers.next_uint(x) && numbers.next_uint(y)) {
+            grid.insert(Point(x, y));
         }
     }
    
@@ -65,8 +67,8 @@ Grid fold(const Grid &grid, Fold f) {
 
     // Copy dots under fold and transfot those above
     for (const Point p : grid) {
-        if (f.direction == 'x' && p.x < f.coordinate ||
-                f.direction == 'y' && p.y < f.coordinate) {
+        if ((f.direction == 'x' && p.x < f.coordinate) ||
+                (f.direction == 'y' && p.y < f.coordinate)) {
             folded.insert(p);
         } else if (f.direction == 'x') {
             int new_x = f.coordinate - (p.x - f.coordinate);
@@ -112,6 +114,20 @@ void test() {
     assert(fold(test_data.first, test_data.second[0]).size() == 17);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_13", "inputs/input13.txt", read_file,
+        [](const auto &data) { return fold(data.first, data.second[0]).size(); },
+        [](const auto &data) {
+            // Count dots after all folds instead of drawing them
+            Grid grid = data.first;
+            for (Fold f : data.second) {
+                grid = fold(grid, f);
+            }
+            return grid.size();
+        });
+}
+#else
 int main() {
     test();
 
@@ -121,3 +137,4 @@ int main() {
      
     return 0;
 }
+#endif
@@ -1,56 +1,90 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <cassert>
-#include <regex>
 #include <utility>
-#include <unordered_map>
 #include <array>
+#include <string>
+#include <string_view>
 #include <vector>
 
-typedef std::unordered_map<std::string, std::string> Rules;
+#include "benchmark.h"
+#include "tokenizer.h"
 
-std::pair<std::string, Rules> read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
+/* Element inserted between each pair of elements, 0 for pairs without a rule */
+typedef std::array<char, 26 * 26> Rules;
+
+/* Example from the puzzle description */
+constexpr std::string_view EXAMPLE =
+    "NNCB\n\nCH -> B\nHH -> N\nCB -> H\nNH -> C\nHB -> C\nHC -> B\nHN -> C\nNN -> C\n"
+    "BH -> H\nNC -> B\nNB -> B\nBN -> B\nBB -> N\nBC -> B\nCC -> N\nCN -> C\n";
+
+/* Index of the pair of elements a and b */
+constexpr int pair_index(char a, char b) {
+    return (a - 'A') * 26 + (b - 'A');
+}
 
-    std::string polymer;
-    in >> polymer;
+constexpr std::pair<std::string, Rules> parse(Tokenizer &in) {
+    std::string_view polymer;
+    in.next_token(polymer);
 
-    Rules rules;
+    Rules rules{};
 
-    std::string a;
-    std::string b;
-    std::string temp;
-    while (in >> a) {
-        in >> temp;
-        in >> b;
+    std::string_view a;
+    std::string_view b;
+    std::string_view temp;
+    while (in.next_token(a)) {
+        in.next_token(temp);
+        in.next_token(b);
 
-        rules[a] = b;
+        rules[pair_index(a[0], a[1])] = b[0];
     }
     
-    return std::make_pair(polymer, rules);
+    return std::make_pair(std::string(polymer), rules);
 }
 
-/* Use rules to insert elements into polymer template */
-std::string insert_elements(const std::string &polymer, Rules rules) {
-    std::ostringstream result;
+std::pair<std::string, Rules> read_file(const std::string &filename) {
+    Tokenizer in(filename);
+    return parse(in);
+}
+
+/* Use rules to insert elements into polymer template, a string or a vector
+ * of elements */
+template <typename Polymer>
+constexpr Polymer insert_elements(const Polymer &polymer, const Rules &rules) {
+    Polymer result;
+    result.reserve(2 * polymer.size());
 
     // Add first element
-    result << polymer[0];
+    result.push_back(polymer[0]);
 
     // Add remaining elements
     for (decltype(polymer.size()) i = 1; i < polymer.size(); ++i) {
         // Check if previous and current element form a rule
-        auto it = rules.find(polymer.substr(i - 1, 2));
-        if (it != rules.end()) {
+        if (char c = rules[pair_index(polymer[i - 1], polymer[i])]) {
             // Insert new element
-            result << it->second;
+            result.push_back(c);
+        }
+        result.push_back(polymer[i]);
+    }
+
+    return result;
+}
+
+/* Return quantity of most common element subtracted by quantity of least
+ * common element */
+template <typename T>
+constexpr T most_minus_least_common(const std::array<T, 26> &counts) {
+    decltype(counts.size()) most_common = 0, least_common = 0;
+
+    for (decltype(counts.size()) i = 1; i < counts.size(); ++i) {
+        if (counts[i] > counts[most_common]) {
+            most_common = i;
+        }
+
+        if (counts[least_common] == 0 || (counts[i] > 0 && counts[i] < counts[least_common])) {
+            least_common = i;
         }
-        result << polymer[i];
     }
 
-    return result.str();
+    return counts[most_common] - counts[least_common];
 }
 
 /* 
@@ -58,127 +92,89 @@ std::string insert_elements(const std::string &polymer, Rules rules) {
  * quantity of least common element after running iterations
  * of element insertion
  */
-int run_iterations(int iterations, std::string polymer, const Rules rules) {
+constexpr int run_iterations(int iterations, const std::string &start, const Rules &rules) {
+    std::vector<char> polymer(start.begin(), start.end());
     for (int i = 0; i < iterations; ++i) {
         polymer = insert_elements(polymer, rules);
     }
 
     // Count for every character
-    std::array<int, 'Z' - 'A' + 1> counts{};
-    // Find most and least common elements
+    std::array<int, 26> counts{};
     for (char c : polymer) {
         ++counts[c - 'A'];
     }  
 
-    decltype(counts.size()) most_common = 0, least_common = 0;
-
-    for (decltype(counts.size()) i = 1; i < counts.size(); ++i) {
-        if (counts[i] > counts[most_common]) {
-            most_common = i;
-        }
-
-        if (counts[least_common] == 0 || (counts[i] > 0 && counts[i] < counts[least_common])) {
-            least_common = i;
-        }
-    }
-
-    return counts[most_common] - counts[least_common];
+    return most_minus_least_common(counts);
 } 
 
-/* Run iterations more efficiently */
-unsigned long long run_iterations_fast(int iterations, const std::string polymer, const Rules rules) {
+/* Run iterations more efficiently by counting pairs instead of building the
+ * polymer */
+constexpr unsigned long long run_iterations_fast(int iterations, const std::string &polymer,
+                                                 const Rules &rules) {
     // Counter for every letter
-    std::array<unsigned long long, 'Z' - 'A' + 1> counts{};
+    std::array<unsigned long long, 26> counts{};
 
-    // Tranform polymer string in map from pairs to count and update counter
+    // Count pairs of the polymer and letters
+    std::array<unsigned long long, 26 * 26> pairs{};
     ++counts[polymer[0] - 'A'];
-    std::unordered_map<std::string, unsigned long long> pairs;
     for (decltype(polymer.size()) i = 1; i < polymer.size(); ++i) {
-        std::string pair = polymer.substr(i - 1, 2);
-        auto it = pairs.find(pair);
-
-        if (it != pairs.end()) {
-            ++pairs[pair];
-        } else {
-            pairs[pair] = 1;
-        }
-
+        ++pairs[pair_index(polymer[i - 1], polymer[i])];
         ++counts[polymer[i] - 'A'];
     }
 
     // Update pairs for every iteration
     for (int i = 0; i < iterations; ++i) {
-        std::unordered_map<std::string, unsigned long long> pairs_new;
-
-        // For every pair, check if it is in rules
-        for (auto pair : pairs) {
-            auto it = rules.find(pair.first);
-            std::vector<std::pair<std::string, unsigned long long>> pairs_to_add;
-            
-            if (it != rules.end()) {
+        std::array<unsigned long long, 26 * 26> pairs_new{};
+
+        for (int pair = 0; pair < 26 * 26; ++pair) {
+            if (!pairs[pair]) {
+                continue;
+            }
+
+            if (char c = rules[pair]) {
                 // Every pair in rules is transformed into two new pairs
-                char a = pair.first[0];
-                char b = pair.first[1];
-                std::string c = it->second;
-
-                // Update letters counter
-                counts[c[0] - 'A'] += pair.second;
-                
-                pairs_to_add.push_back(std::make_pair(a + c, pair.second));
-                pairs_to_add.push_back(std::make_pair(c + b, pair.second));
+                char a = 'A' + pair / 26;
+                char b = 'A' + pair % 26;
+                counts[c - 'A'] += pairs[pair];
+                pairs_new[pair_index(a, c)] += pairs[pair];
+                pairs_new[pair_index(c, b)] += pairs[pair];
             } else {
                 // Pairs not present in rules remain the same
-                pairs_to_add.push_back(pair);
-            }
-
-            // Add transformed pairs to a map
-            for (auto pair_to_add : pairs_to_add) {
-                auto it_pair = pairs_new.find(pair_to_add.first);
-
-                if (it_pair != pairs_new.end()) {
-                    pairs_new[pair_to_add.first] += pair_to_add.second;
-                } else {
-                    pairs_new[pair_to_add.first] = pair_to_add.second;
-                }
+                pairs_new[pair] += pairs[pair];
             }
         }
-        
-        // Replace old pairs with transformed ones
+
         pairs = pairs_new;
     }
 
-    decltype(counts.size()) most_common = 0, least_common = 0;
+    return most_minus_least_common(counts);
+}
 
-    // Find most and least common letters
-    for (decltype(counts.size()) i = 1; i < counts.size(); ++i) {
-        if (counts[i] > counts[most_common]) {
-            most_common = i;
-        }
+/* Test small cases at compile time */
+constexpr bool test() {
+    Tokenizer in(EXAMPLE);
+    std::pair<std::string, Rules> test_data = parse(in);
 
-        if (counts[least_common] == 0 || (counts[i] > 0 && counts[i] < counts[least_common])) {
-            least_common = i;
-        }
-    }
-
-    return counts[most_common] - counts[least_common];
+    return insert_elements(test_data.first, test_data.second) == "NCNBCHB" &&
+           run_iterations(10, test_data.first, test_data.second) == 1588 &&
+           run_iterations_fast(10, test_data.first, test_data.second) == 1588 &&
+           run_iterations_fast(40, test_data.first, test_data.second) == 2188189693529ull;
 }
 
-void test() {
-    std::pair<std::string, Rules> test_data = read_file("inputs/input14_test.txt");   
+static_assert(test());
 
-    assert(insert_elements(test_data.first, test_data.second) == "NCNBCHB"); 
-    assert(run_iterations(10, test_data.first, test_data.second) == 1588); 
-    assert(run_iterations_fast(10, test_data.first, test_data.second) == 1588); 
-    assert(run_iterations_fast(40, test_data.first, test_data.second) == 2188189693529ull); 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_14", "inputs/input14.txt", read_file,
+        [](const auto &data) { return run_iterations(10, data.first, data.second); },
+        [](const auto &data) { return run_iterations_fast(40, data.first, data.second); });
 }
-
+#else
 int main() {
-    test();
-
     std::pair<std::string, Rules> data = read_file("inputs/input14.txt");   
     std::cout << run_iterations(10, data.first, data.second) << std::endl;
     std::cout << run_iterations_fast(40, data.first, data.second) << std::endl;
     
     return 0;
 }
-
+#endif
@@ -1,104 +1,79 @@
 #include <iostream>
-#include <fstream>
 #include <cassert>
 #include <vector>
-#include <queue>
 
-typedef std::vector<std::vector<int>> GRID;
+#include "benchmark.h"
+#include "tokenizer.h"
+#include "grid.h"
+#include "search.h"
 
-struct Node {
-    int x;
-    int y;
-    int cost;
-
-    Node(int x, int y, int cost) : x(x), y(y), cost(cost) { } 
-};
+typedef Grid<int> GRID;
 
 const int NEIGHBORS[4][2] = {
     { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1}
 };
 
-GRID read_file(const std::string &filename) {
-    GRID grid;
+/* Cells of the grid by index, entering a cell costs its risk level */
+struct Cavern {
+    using State = int;
+    static constexpr search::Cost MAX_STEP = 9;
+
+    const GRID &grid;
+    int goal;
 
-    std::ifstream in;
-    in.open(filename);
+    std::size_t size() const {
+        return grid.cells.size();
+    }
+
+    bool is_goal(int index) const {
+        return index == goal;
+    }
 
-    std::string line;
-    while (std::getline(in, line)) {
-        std::vector<int> grid_line;
-        for (char c : line) {
-            grid_line.push_back(c - '0');
+    /* The padding has risk level 0 and is never entered */
+    template <typename Emit>
+    void neighbors(int index, Emit emit) const {
+        for (int i = 0; i < 4; ++i) {
+            int neighbor = index + grid.offset(NEIGHBORS[i][0], NEIGHBORS[i][1]);
+            if (grid[neighbor]) {
+                emit(neighbor, grid[neighbor]);
+            }
         }
-        grid.push_back(grid_line);
     }
+};
+
+GRID read_file(const std::string &filename) {
+    Tokenizer in(filename);
 
-    return grid;
+    std::vector<std::string_view> lines;
+    std::string_view line;
+    while (in.next_line(line)) {
+        lines.push_back(line);
+    }
+
+    return make_grid(lines, 1, 0, [](char c) { return c - '0'; });
 }
 
 /* Return length of path from top left to bottom right */
 int shortest_path(const GRID &grid) {
-    auto compare = [](const Node &a, const Node &b) {
-        return a.cost > b.cost;
-    };
-    std::priority_queue<Node, std::vector<Node>, decltype(compare)> queue(compare);
-
     // For part 2 we are solving a bigger grid
-    int goal_y = grid.size() - 1;
-    int goal_x = grid[goal_y].size() - 1;
-
-    std::vector<std::vector<bool>> visited(
-        goal_y + 1,
-        std::vector<bool>(goal_x + 1)
-    );
+    Cavern cavern{ grid, grid.index(grid.rows - 1, grid.cols - 1) };
 
     // Start at top left
-    queue.push(Node(0, 0, 0));
-
-    while (!queue.empty()) {
-        // Take the cheapest node
-        Node next = queue.top();
-        queue.pop();
-
-        if (visited[next.y][next.x]) {
-            continue;
-        } 
-        visited[next.y][next.x] = true;
-
-        // Check if we are done
-        if (next.y == goal_y && next.x == goal_x) {
-            return next.cost;
-        }
-
-        // Generate all its neighbours
-        for (int i = 0; i < 4; ++i) {
-            int new_y = next.y + NEIGHBORS[i][0];
-            int new_x = next.x + NEIGHBORS[i][1];
-
-            // Check if neighbors is valid
-            if (new_y >= 0 && new_y <= goal_y && new_x >= 0 && new_x <= goal_x) {
-                queue.push(Node(new_x, new_y, next.cost + grid[new_y][new_x]));
-            }
-        }
-    }
-    
-    return -1;
+    auto result = search::shortest_path(cavern, grid.index(0, 0));
+    return result.found ? result.cost : -1;
 }
 
 /* Return 5 times bigger grid */
 GRID bigger_grid(const GRID &grid) {
-    int size_y = grid.size();
-    int size_x = grid[size_y - 1].size();
-    std::vector<std::vector<int>> bigger(
-        size_y * 5,
-        std::vector<int>(size_x * 5)
-    );
+    GRID bigger(grid.rows * 5, grid.cols * 5, grid.padding);
     
-    for (decltype(bigger.size()) i = 0; i < bigger.size(); ++i) {
-        for (decltype(bigger[i].size()) j = 0; j < bigger[i].size(); ++j) {
-            int grid_y = i / size_y;
-            int grid_x = j / size_x;
-            bigger[i][j] = (grid[i % size_y][j % size_x] + grid_y + grid_x - 1) % 9 + 1;
+    for (int i = 0; i < bigger.rows; ++i) {
+        auto row = bigger.row(i);
+        auto tile_row = grid.row(i % grid.rows);
+        for (int j = 0; j < bigger.cols; ++j) {
+            int grid_y = i / grid.rows;
+            int grid_x = j / grid.cols;
+            row[j] = (tile_row[j % grid.cols] + grid_y + grid_x - 1) % 9 + 1;
         }
     }
     
@@ -112,6 +87,13 @@ void test() {
     assert(shortest_path(bigger_grid(test_data)) == 315);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_15", "inputs/input15.txt", read_file,
+        shortest_path,
+        [](const GRID &data) { return shortest_path(bigger_grid(data)); });
+}
+#else
 int main() {
     test();
 
@@ -121,4 +103,4 @@ int main() {
 
     return 0;
 }
-
+#endif
@@ -1,38 +1,37 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <bitset>
 #include <vector>
 #include <utility>
 #include <cassert>
 
+#include "benchmark.h"
+#include "tokenizer.h"
+
 struct Packet {
     int version;
     int type_ID;
     std::vector<Packet> content;
-    long literal;
+    long literal = 0;
 };
 
 std::string read_data(const std::string &filename) {
-    std::ifstream in; 
-    in.open(filename);
+    Tokenizer in(filename);
 
-    std::string line;
-    std::getline(in, line);
-    return line;
+    std::string_view line;
+    in.next_line(line);
+    return std::string(line);
 }
 
 /* Transform each hex character to 4 binary bits */
 std::string hex_to_bin(const std::string &hex_string) {
-    std::ostringstream out;
-    int a;
+    std::string out;
+    out.reserve(4 * hex_string.size());
     for (char c : hex_string) {
-        std::istringstream(std::string(1, c)) >> std::hex >> a;
-        std::bitset<4> b(a);
-        out << b;
+        int a = Tokenizer::is_digit(c) ? c - '0' : (c | 0x20) - 'a' + 10;
+        out += std::bitset<4>(a).to_string();
     }
     
-    return out.str();
+    return out;
 }
 
 /* Decapsulate one packet and return it as an object */
@@ -194,6 +193,15 @@ void test() {
     assert(calculate_value(result) == 1);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_16", "inputs/input16.txt",
+        [](const std::string &filename) {
+            return decapsulate(hex_to_bin(read_data(filename))).first;
+        },
+        versions_sum, calculate_value);
+}
+#else
 int main() {
     test();
 
@@ -204,3 +212,4 @@ int main() {
     
     return 0;
 }
+#endif
@@ -1,9 +1,9 @@
 #include <iostream>
-#include <fstream>
-#include <regex>
 #include <string>
-#include <cassert>
-#include <cmath>
+#include <string_view>
+
+#include "benchmark.h"
+#include "tokenizer.h"
 
 struct Area {
     int minX;
@@ -11,39 +11,42 @@ struct Area {
     int minY;
     int maxY;
 
-    bool hit(int x, int y) const {
+    constexpr bool hit(int x, int y) const {
         return x >= minX && x <= maxX && y >= minY && y <= maxY; 
     }
 };
 
-Area read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
+/* Example from the puzzle description */
+constexpr std::string_view EXAMPLE = "target area: x=20..30, y=-10..-5\n";
 
-    std::string content;
-    std::getline(in, content);
+constexpr Area parse(Tokenizer &in) {
+    // The only line is "target area: x=minX..maxX, y=minY..maxY"
+    Area area = {0, 0, 0, 0};
+    in.next_int(area.minX);
+    in.next_int(area.maxX);
+    in.next_int(area.minY);
+    in.next_int(area.maxY);
+    return area;
+}
 
-    std::regex content_regex("target area: x=(-?\\d+)..(-?\\d+), y=(-?\\d+)..(-?\\d+)");
-    std::smatch match;
-    
-    std::regex_match(content, match, content_regex);
-    return {
-        std::stoi(match.str(1)),
-        std::stoi(match.str(2)),
-        std::stoi(match.str(3)),
-        std::stoi(match.str(4))
-    };
+Area read_file(const std::string &filename) {
+    Tokenizer in(filename);
+    return parse(in);
 }
 
 /* Find optimal velocities and return highest y achieved */
-int highest_y(const Area target) {
+constexpr int highest_y(const Area target) {
     return target.minY * (target.minY + 1) / 2;
 }
 
 /* Return number of velocities using which we hit target */
-int num_of_velocities(const Area target) {
-    // Calculate min and max x velocity
-    int min_vx = (-1 + std::sqrt(1 + 8 * target.minX)) / 2;
+constexpr int num_of_velocities(const Area target) {
+    // Calculate min and max x velocity. Slower x velocities stop before they
+    // reach minX, since vx stops after vx * (vx + 1) / 2.
+    int min_vx = 0;
+    while ((min_vx + 1) * (min_vx + 2) / 2 <= target.minX) {
+        ++min_vx;
+    }
     int max_vx = target.maxX;
 
     // Calculate min and max y velocity
@@ -75,19 +78,26 @@ int num_of_velocities(const Area target) {
     return velocities;
 }
 
-void test() {
-    Area area = read_file("inputs/input17_test.txt");
-
-    assert(highest_y(area) == 45);
-    assert(num_of_velocities(area) == 112);
+/* Test small cases at compile time */
+constexpr bool test() {
+    Tokenizer in(EXAMPLE);
+    Area area = parse(in);
+    return highest_y(area) == 45 && num_of_velocities(area) == 112;
 }
 
+static_assert(test());
+
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_17", "inputs/input17.txt", read_file,
+        highest_y, num_of_velocities);
+}
+#else
 int main() {
-    test();
-    
     Area area = read_file("inputs/input17.txt");
     std::cout << highest_y(area) << '\n';
     std::cout << num_of_velocities(area) << '\n';
 
     return 0;
 }
+#endif
@@ -1,11 +1,13 @@
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include <cassert>
 #include <memory>
 #include <vector>
 #include <string>
 
+#include "benchmark.h"
+#include "tokenizer.h"
+
 struct SnailfishNumber {
     std::shared_ptr<SnailfishNumber> left;
     std::shared_ptr<SnailfishNumber> right;
@@ -29,6 +31,10 @@ struct SnailfishNumber {
         number = num.number;
     }
 
+    /* Assigned numbers share their hierarchy, they are only ever assigned
+     * temporaries */
+    SnailfishNumber &operator=(const SnailfishNumber &num) = default;
+
     /* Try to explode this number */
     int explode(int depth = 0,
                 std::shared_ptr<SnailfishNumber> first_left = nullptr,
@@ -221,13 +227,12 @@ SnailfishNumber parse_number(const std::string &number) {
 
 /* Read file and parse every line as a number */
 std::vector<SnailfishNumber> read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
+    Tokenizer in(filename);
     std::vector<SnailfishNumber> numbers;
 
-    std::string line;
-    while (std::getline(in, line)) {
-        numbers.push_back(parse_number(line));
+    std::string_view line;
+    while (in.next_line(line)) {
+        numbers.push_back(parse_number(std::string(line)));
     }
 
     return numbers;
@@ -301,6 +306,13 @@ void test() {
     assert(largest_magnitude(numbers) == 3993);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_18", "inputs/input18.txt", read_file,
+        [](const std::vector<SnailfishNumber> &numbers) { return add_numbers(numbers).mag(); },
+        largest_magnitude);
+}
+#else
 int main() {
     test();
 
@@ -310,4 +322,4 @@ int main() {
 
     return 0;
 }
-
+#endif
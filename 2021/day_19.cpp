@@ -1,5 +1,4 @@
 #include <iostream>
-#include <fstream>
 #include <cstdlib>
 #include <vector>
 #include <set>
@@ -9,6 +8,12 @@
 #include <iomanip>
 #include <cassert>
 
+#include "benchmark.h"
+#include "tokenizer.h"
+#include "grid.h"
+#include "cache.h"
+#include "instrument.h"
+
 struct Position {
     int x;
     int y;
@@ -26,7 +31,7 @@ typedef Position Beacon;
 
 struct Scanner {
     std::vector<Beacon> beacons;
-    std::vector<std::vector<int>> distances;
+    Grid<int> distances;
 };
 
 typedef std::pair<int, int> Match;
@@ -122,26 +127,30 @@ int distance(const Position &a, const Position &b, bool manhattan = false) {
 /* Compute distances between every combination of 2 beacons */
 void compute_matrix(Scanner &scanner) {
     auto &b = scanner.beacons;
-    scanner.distances = std::vector<std::vector<int>>(b.size(), std::vector<int>(b.size()));
+    scanner.distances = Grid<int>(b.size(), b.size());
 
     for (decltype(b.size()) i = 0; i < b.size(); ++i) {
-        scanner.distances[i][i] = 0;
+        scanner.distances(i, i) = 0;
         for (decltype(b.size()) j = i + 1; j < b.size(); ++j) {
             int d = distance(b[i], b[j]);
-            scanner.distances[i][j] = d;
-            scanner.distances[j][i] = d;
+            scanner.distances(i, j) = d;
+            scanner.distances(j, i) = d;
         }
     }
 }
 
 /* Find pairs of beacons with at least 12 distances in common */
 std::vector<Match> find_matches(const Scanner &first, const Scanner &second) {
+    INSTRUMENT_REGION("day_19 find_matches");
+    INSTRUMENT_COUNT("day_19 beacon pairs", first.beacons.size() * second.beacons.size());
     std::vector<std::pair<int, int>> matches;
 
     for (decltype(first.beacons.size()) i = 0; i < first.beacons.size(); ++i) {
-        std::set<int> first_distances(first.distances[i].begin(), first.distances[i].end()); 
+        auto first_row = first.distances.row(i);
+        std::set<int> first_distances(first_row.begin(), first_row.end());
         for (decltype(second.beacons.size()) j = 0; j < second.beacons.size(); ++j) {
-            std::set<int> second_distances(second.distances[j].begin(), second.distances[j].end()); 
+            auto second_row = second.distances.row(j);
+            std::set<int> second_distances(second_row.begin(), second_row.end());
             std::set<int> common_distances;
             std::set_intersection(first_distances.begin(), first_distances.end(),
                                   second_distances.begin(), second_distances.end(),
@@ -296,8 +305,8 @@ int largest_scanners_distance(std::map<int, Transformation> scanners) {
 
 /* Print 2D matrix, for debugging */
 void print_matrix(const std::vector<std::vector<int>> &matrix) {
-    for (int i = 0; i < matrix.size(); ++i) {
-        for (int j = 0; j < matrix[0].size(); ++j) {
+    for (std::size_t i = 0; i < matrix.size(); ++i) {
+        for (std::size_t j = 0; j < matrix[0].size(); ++j) {
             std::cout << std::setfill(' ') << std::setw(4) << matrix[i][j] << ' ';
         }
         std::cout << '\n';
@@ -305,25 +314,22 @@ void print_matrix(const std::vector<std::vector<int>> &matrix) {
     std::cout << '\n';
 }
 
-std::vector<Scanner> read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
+std::vector<Scanner> parse_file(const std::string &filename) {
+    Tokenizer in(filename);
 
-    std::string line;
+    std::string_view line;
     std::vector<Scanner> scanners;
 
-    while (std::getline(in, line)) {
+    while (in.next_line(line)) {
         Scanner scanner;
 
-        while (std::getline(in, line) && line.size() > 1) {
-            // Split line by commas
-            int comma_1 = line.find_first_of(',');
-            int comma_2 = line.find_last_of(',');
-            scanner.beacons.push_back({
-                std::stoi(line.substr(0, comma_1)),
-                std::stoi(line.substr(comma_1 + 1, comma_2 - comma_1 - 1)),
-                std::stoi(line.substr(comma_2 + 1)),
-            });
+        while (in.next_line(line) && line.size() > 1) {
+            Tokenizer coordinates(line);
+            int x, y, z;
+            coordinates.next_int(x);
+            coordinates.next_int(y);
+            coordinates.next_int(z);
+            scanner.beacons.push_back({x, y, z});
         }
 
         compute_matrix(scanner);
@@ -333,6 +339,41 @@ std::vector<Scanner> read_file(const std::string &filename) {
     return scanners;
 }
 
+/* Beacons and distance matrices of all scanners, in that order */
+void save_scanners(cache::Writer &out, const std::vector<Scanner> &scanners) {
+    out.write(static_cast<std::uint64_t>(scanners.size()));
+    for (const Scanner &scanner : scanners) {
+        out.write(std::span<const Beacon>(scanner.beacons));
+        out.write(std::span<const int>(scanner.distances.cells));
+    }
+}
+
+std::vector<Scanner> load_scanners(cache::Reader &in) {
+    std::vector<Scanner> scanners;
+    auto count = in.read<std::uint64_t>();
+
+    for (decltype(count) i = 0; i < count && in.ok; ++i) {
+        auto beacons = in.read_span<Beacon>();
+        auto distances = in.read_span<int>();
+        if (distances.size() != beacons.size() * beacons.size()) {
+            in.ok = false;
+            break;
+        }
+
+        Scanner &scanner = scanners.emplace_back();
+        scanner.beacons.assign(beacons.begin(), beacons.end());
+        scanner.distances = Grid<int>(beacons.size(), beacons.size());
+        std::copy(distances.begin(), distances.end(), scanner.distances.cells.begin());
+    }
+
+    return scanners;
+}
+
+/* Computing the distance matrices is the slow part of parsing */
+std::vector<Scanner> read_file(const std::string &filename) {
+    return cache::cached(filename, "day_19", 1, parse_file, save_scanners, load_scanners);
+}
+
 void test() {
     std::vector<Scanner> scanners = read_file("inputs/input19_test.txt");
     std::map<int, Transformation> scanners_relative;
@@ -340,6 +381,21 @@ void test() {
     assert(largest_scanners_distance(scanners_relative) == 3621);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_19", "inputs/input19.txt", read_file,
+        [](const std::vector<Scanner> &scanners) {
+            std::map<int, Transformation> scanners_relative;
+            return number_of_beacons(scanners, scanners_relative);
+        },
+        [](const std::vector<Scanner> &scanners) {
+            // Scanner positions are only known after locating all beacons
+            std::map<int, Transformation> scanners_relative;
+            number_of_beacons(scanners, scanners_relative);
+            return largest_scanners_distance(scanners_relative);
+        });
+}
+#else
 int main() {
     test();
 
@@ -350,4 +406,4 @@ int main() {
 
     return 0;
 }
-
+#endif
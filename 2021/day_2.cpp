@@ -1,84 +1,129 @@
 #include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
-#include <utility>
-#include <cassert>
 
-const int FORWARD = 0;
-const int UP = 1;
-const int DOWN = 2;
+#include "benchmark.h"
+#include "tokenizer.h"
 
-/* Parse input into vector of int pairs */
-std::vector<std::pair<int, int>> read_file(const std::string &filename) {
-    std::vector<std::pair<int, int>> input;
+/* Smallest part of the input worth a thread of its own */
+constexpr std::size_t MIN_CHUNK_SIZE = 1 << 20;
 
-    std::ifstream in;
-    in.open(filename);
-    
-    std::string direction;
+/* Example from the puzzle description */
+constexpr std::string_view EXAMPLE =
+    "forward 5\ndown 5\nforward 8\nup 3\ndown 8\nforward 2\n";
+
+/* Net effect of a sequence of commands on a submarine starting with aim 0.
+ * Starting with aim a instead only adds a * x to the depth, so the effect of
+ * two sequences after each other can be computed from their effects alone,
+ * and the input can be reduced in chunks that are combined afterwards. */
+struct Course {
+    long long x = 0;
+    long long depth = 0;
+    long long aim = 0;
+
+    /* Effect of this sequence followed by the next one */
+    constexpr Course then(const Course &next) const {
+        return { x + next.x, depth + next.depth + aim * next.x, aim + next.aim };
+    }
+};
+
+/* Parse the commands and reduce them to their net effect */
+constexpr Course reduce(Tokenizer &in) {
+    Course course;
+
+    std::string_view direction;
     int value;
-    while (in >> direction >> value) {
+    while (in.next_token(direction) && in.next_int(value)) {
         if (direction == "forward") {
-            input.push_back({FORWARD, value});
+            course.x += value;
+            course.depth += course.aim * value;
         } else if (direction == "up") {
-            input.push_back({UP, value});
+            course.aim -= value;
         } else if (direction == "down") {
-            input.push_back({DOWN, value});
-        } else {
-            input.push_back({-1, -1});
+            course.aim += value;
         }
     }
 
-    return input;
+    return course;
 }
 
-/* Return final horizontal and vertical position multiplied */
-int find_position(const std::vector<std::pair<int, int>> instructions) {
-    int x = 0, y = 0;
-
-    for (auto instruction : instructions) {
-        if (instruction.first == FORWARD) {
-            x += instruction.second;
-        } else if (instruction.first == UP) {
-            y -= instruction.second;
-        } else if (instruction.first == DOWN) {
-            y += instruction.second;
+/* Reduce the commands of text on up to <threads> threads, each of which takes
+ * a contiguous range of whole lines */
+Course reduce_parallel(std::string_view text, unsigned threads) {
+    threads = std::clamp<std::size_t>(text.size() / MIN_CHUNK_SIZE, 1, std::max(threads, 1u));
+
+    std::vector<Course> courses(threads);
+    std::vector<std::thread> workers;
+    std::size_t begin = 0;
+    for (unsigned i = 0; i < threads; ++i) {
+        // Every chunk but the last ends after the first newline past its share
+        std::size_t end = text.size();
+        if (i + 1 < threads) {
+            end = std::min(text.find('\n', std::max(begin, text.size() / threads * (i + 1))),
+                           text.size() - 1) + 1;
         }
+
+        workers.emplace_back([&courses, i, chunk = text.substr(begin, end - begin)]() {
+            Tokenizer in(chunk);
+            courses[i] = reduce(in);
+        });
+        begin = end;
     }
 
-    return x * y;
+    Course course;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers[i].join();
+        course = course.then(courses[i]);
+    }
+    return course;
 }
 
-/* Return final horizontal and vertical position multiplied using aim */
-int find_position_and_aim(const std::vector<std::pair<int, int>> instructions) {
-    int x = 0, y = 0, aim = 0;
-
-    for (auto instruction : instructions) {
-        if (instruction.first == FORWARD) {
-            x += instruction.second;
-            y += aim * instruction.second;
-        } else if (instruction.first == UP) {
-            aim -= instruction.second;
-        } else if (instruction.first == DOWN) {
-            aim += instruction.second;
-        }
-    }
+/* Read input file <filename> and reduce its commands to their net effect */
+Course read_file(const std::string &filename) {
+    Tokenizer in(filename);
+    return reduce_parallel(in.rest, std::thread::hardware_concurrency());
+}
 
-    return x * y;
+/* Return final horizontal and vertical position multiplied. Without aim, the
+ * commands change the depth the way they change the aim. */
+constexpr long long find_position(const Course &course) {
+    return course.x * course.aim;
 }
 
-void test() {
-    std::vector<std::pair<int, int>> input = read_file("inputs/input2_test.txt");
-    assert(find_position(input) == 150);
-    assert(find_position_and_aim(input) == 900);
+/* Return final horizontal and vertical position multiplied using aim */
+constexpr long long find_position_and_aim(const Course &course) {
+    return course.x * course.depth;
 }
 
+/* Test small cases at compile time, also when the commands are split in two */
+constexpr bool test() {
+    Tokenizer in(EXAMPLE);
+    Course course = reduce(in);
+
+    Tokenizer first(EXAMPLE.substr(0, 17));
+    Tokenizer second(EXAMPLE.substr(17));
+    Course combined = reduce(first).then(reduce(second));
+
+    return find_position(course) == 150 && find_position_and_aim(course) == 900 &&
+           find_position(combined) == 150 && find_position_and_aim(combined) == 900;
+}
+
+static_assert(test());
+
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_2", "inputs/input2.txt", read_file,
+        find_position, find_position_and_aim);
+}
+#else
 int main() {
-    test(); 
-    
-    std::vector<std::pair<int, int>> input = read_file("inputs/input2.txt");
-    std::cout << find_position(input) << std::endl;
-    std::cout << find_position_and_aim(input) << std::endl;
+    Course course = read_file("inputs/input2.txt");
+    std::cout << find_position(course) << std::endl;
+    std::cout << find_position_and_aim(course) << std::endl;
 
     return 0;
 }
+#endif
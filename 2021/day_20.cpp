@@ -1,14 +1,14 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
-#include <set>
 #include <vector>
 #include <array>
-#include <numeric>
 #include <algorithm>
 #include <cassert>
 
-typedef std::vector<std::string> Image;
+#include "benchmark.h"
+#include "tokenizer.h"
+#include "grid.h"
+
+typedef Grid<char> Image;
 typedef std::string EnhanceAlgo;
 
 const std::array<std::pair<int, int>, 9> WINDOW = {{
@@ -19,32 +19,21 @@ const std::array<std::pair<int, int>, 9> WINDOW = {{
 
 /* Return number of the window centered at given coordinates */
 int get_window_number(const Image &image, int x, int y) {
+    int i = image.index(y, x);
     int number = 0;
     for (auto [dy, dx] : WINDOW) {
-        number = number * 2 + (image[y + dy][x + dx] == '#'); 
+        number = number * 2 + (image[i + image.offset(dy, dx)] == '#'); 
     }
     return number;
 }
 
 /* Pad image using '.' in all directions */
 Image pad_image(const Image &image, int padding) {
-    Image result;
-    std::string pad_line(image[0].size() + 2 * padding, '.');
-    std::string pad_side(padding, '.');
+    Image result(image.rows + 2 * padding, image.cols + 2 * padding, 0, '.');
 
-    // Add top padding lines
-    for (int i = 0; i < padding; ++i) {
-        result.push_back(pad_line);
-    }
-    
-    // Add padding to the sides
-    for (const std::string &line : image) {
-        result.push_back(pad_side + line + pad_side);
-    }
-
-    // Add bottom padding lines
-    for (int i = 0; i < padding; ++i) {
-        result.push_back(pad_line);
+    for (int y = 0; y < image.rows; ++y) {
+        auto line = image.row(y);
+        std::copy(line.begin(), line.end(), &result(y + padding, padding));
     }
 
     return result;
@@ -58,46 +47,41 @@ int enhance_image(const Image &image, EnhanceAlgo algo, int steps) {
     Image padded = pad_image(image, 2 * steps);
 
     for (int i = 0; i < steps; ++i) {
-        Image new_image;
+        Image new_image(padded.rows - 2, padded.cols - 2);
 
         // Get new pixels for image without its border
-        for (decltype(padded.size()) y = 1; y < padded.size() - 1; ++y) {
-            std::ostringstream new_line;
-            for (decltype(padded[y].size()) x = 1; x < padded[y].size() - 1; ++x) {
-                new_line << algo[get_window_number(padded, x, y)]; 
+        for (int y = 0; y < new_image.rows; ++y) {
+            auto new_line = new_image.row(y);
+            for (int x = 0; x < new_image.cols; ++x) {
+                new_line[x] = algo[get_window_number(padded, x + 1, y + 1)]; 
             }
-            new_image.push_back(new_line.str());
         } 
 
-        padded = new_image;
+        padded.swap(new_image);
     }
 
     // Return number of turned on pixels
-    return std::accumulate(padded.begin(), padded.end(), 0, [](int a, std::string b) {
-        return a + std::count(b.begin(), b.end(), '#');
-    });
+    return std::count(padded.cells.begin(), padded.cells.end(), '#');
 }
 
 std::pair<Image, EnhanceAlgo> read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
+    Tokenizer in(filename);
 
-    std::ostringstream algo;
-    std::string line;
+    std::string algo;
+    std::string_view line;
     
     // Read lines until empty line
-    while (std::getline(in, line) && line.size() > 1) {
-        algo << line;
+    while (in.next_line(line) && line.size() > 1) {
+        algo += line;
     }
     
     // Save each image line as a string
-    Image image;
-
-    while (std::getline(in, line)) {
-        image.push_back(line);
+    std::vector<std::string_view> lines;
+    while (in.next_line(line)) {
+        lines.push_back(line);
     }
 
-    return { image, algo.str() };
+    return { make_grid(lines, 0, '.', [](char c) { return c; }), algo };
 }
 
 void test() {
@@ -108,6 +92,13 @@ void test() {
 }
 
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_20", "inputs/input20.txt", read_file,
+        [](const auto &data) { return enhance_image(data.first, data.second, 2); },
+        [](const auto &data) { return enhance_image(data.first, data.second, 50); });
+}
+#else
 int main() {
     test();
 
@@ -116,3 +107,4 @@ int main() {
     std::cout << enhance_image(image, algo, 50) << '\n'; 
     return 0;
 }
+#endif
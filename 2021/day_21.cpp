@@ -1,14 +1,17 @@
 #include <iostream>
-#include <fstream>
+#include <string_view>
 #include <utility>
-#include <cassert>
+#include <vector>
+
+#include "benchmark.h"
+#include "tokenizer.h"
 
 /* Deterministic die from the problem */
 struct Die {
     int curr = 0;
     int rolls = 0;
 
-    int roll() {
+    constexpr int roll() {
         curr = (curr) % 100 + 1;
         ++rolls;
         return curr;
@@ -16,12 +19,12 @@ struct Die {
 };
 
 /* Return new position */
-int move(int position, int steps) {
+constexpr int move(int position, int steps) {
     return (position + steps - 1) % 10 + 1;
 }
 
 /* Play a practice game using deterministic die */
-int practice_game(int first, int second) {
+constexpr int practice_game(int first, int second) {
     int positions[] = { first, second };
     int scores[] = { 0, 0 };
     int turn = 0;
@@ -37,106 +40,92 @@ int practice_game(int first, int second) {
     return die.rolls * scores[1 - winner];
 }
 
-/* Recursive function for playing the game */
-std::pair<long, long> play_game(int first, int second, int first_score, int second_score,
-                                int turn, int rolls, long memo[11][11][21][21][2][4][2]) {
-    // Check if solution is available
-    if (memo[first][second][first_score][second_score][turn][rolls][0] ||
-            memo[first][second][first_score][second_score][turn][rolls][1]) {
-        return {
-            memo[first][second][first_score][second_score][turn][rolls][0],
-            memo[first][second][first_score][second_score][turn][rolls][1]
-        };
+/* Number of ways three rolls of the Dirac die add up to each total */
+constexpr long ROLL_WAYS[10] = { 0, 0, 0, 1, 3, 6, 7, 6, 3, 1 };
+
+/* Return number of universes in which the player to move and the other
+ * player win. Results are memoized by positions and scores, where no result
+ * is known yet while both counts are 0. */
+constexpr std::pair<long, long> play_game(int position, int other_position, int score,
+                                          int other_score,
+                                          std::vector<std::pair<long, long>> &memo) {
+    auto &known = memo[((position - 1) * 10 + other_position - 1) * 21 * 21 +
+                       score * 21 + other_score];
+    if (known.first || known.second) {
+        return known;
     }
-    
-    std::pair<long, long> res;
-
-    // If player rolled 3 times, execute the move 
-    if (rolls < 3) {
-        long winnings[] = { 0, 0 };
-        // Split game into 3 universes
-        for (int roll = 1; roll <= 3; ++roll) {
-            if (turn) {
-                int new_second = move(second, roll);
-                res = play_game(first, new_second, first_score, second_score, turn, rolls + 1, memo);
-                // Save solution
-                memo[first][new_second][first_score][second_score][turn][rolls + 1][0] = res.first;
-                memo[first][new_second][first_score][second_score][turn][rolls + 1][1] = res.second;
-            } else {
-                int new_first = move(first, roll);
-                res = play_game(new_first, second, first_score, second_score, turn, rolls + 1, memo);
-                // Save solution
-                memo[new_first][second][first_score][second_score][turn][rolls + 1][0] = res.first;
-                memo[new_first][second][first_score][second_score][turn][rolls + 1][1] = res.second;
-            }
-
-            winnings[0] += res.first;
-            winnings[1] += res.second;
-        }
 
-        return { winnings[0], winnings[1] };
-    } else {
-        // Change player and add score
-        if (turn) {
-            int new_second_score = second_score + second;
-
-            // Check if player has won
-            if (new_second_score >= 21) return { 0, 1 };   
-
-            res = play_game(first, second, first_score, new_second_score, 1 - turn, 0, memo);
-            // Save solution
-            memo[first][second][first_score][new_second_score][1 - turn][0][0] = res.first;
-            memo[first][second][first_score][new_second_score][1 - turn][0][1] = res.second;
-        } else {
-            int new_first_score = first_score + first;
-
-            // Check if player has won
-            if (new_first_score >= 21) return { 1, 0 };   
-
-            res = play_game(first, second, new_first_score, second_score, 1 - turn, 0, memo);
-            // Save solution
-            memo[first][second][new_first_score][second_score][1 - turn][0][0] = res.first;
-            memo[first][second][new_first_score][second_score][1 - turn][0][1] = res.second;
+    // Split game into a universe for every total of the three rolls
+    std::pair<long, long> wins = { 0, 0 };
+    for (int roll = 3; roll <= 9; ++roll) {
+        int new_position = move(position, roll);
+        int new_score = score + new_position;
+
+        // Check if player has won, otherwise the other player moves next
+        if (new_score >= 21) {
+            wins.first += ROLL_WAYS[roll];
+            continue;
         }
 
-        return res;
+        auto [other, self] = play_game(other_position, new_position, other_score, new_score, memo);
+        wins.first += ROLL_WAYS[roll] * self;
+        wins.second += ROLL_WAYS[roll] * other;
     }
+
+    return known = wins;
 }
 
 /* Return number of wins for each player in all universes together */
-std::pair<long, long> real_game(int first, int second) {
+constexpr std::pair<long, long> real_game(int first, int second) {
     // Create table for memoization
-    // first * second * first_score * second_score * turn * rolls * 2 (result)
-    long memo[11][11][21][21][2][4][2] = {};
+    // position * other_position * score * other_score
+    std::vector<std::pair<long, long>> memo(10 * 10 * 21 * 21);
 
-    return play_game(first, second, 0, 0, 0, 0, memo);
+    return play_game(first, second, 0, 0, memo);
 }
 
-std::pair<int, int> read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
-    int first, second;
-
-    // Skip text
-    for (int i = 0; i < 28; ++i) in.get();
-    in >> first;
-    for (int i = 0; i < 28; ++i) in.get();
-    in >> second;
+/* Example from the puzzle description */
+constexpr std::string_view EXAMPLE =
+    "Player 1 starting position: 4\nPlayer 2 starting position: 8\n";
+
+constexpr std::pair<int, int> parse(Tokenizer &in) {
+    int player, first, second;
+
+    // Lines are "Player n starting position: p"
+    in.next_int(player);
+    in.next_int(first);
+    in.next_int(player);
+    in.next_int(second);
     return { first, second };
 }
 
-void test() {
-    auto [first, second] = read_file("inputs/input21_test.txt");
-    assert(move(7, 5) == 2);
-    assert(practice_game(first, second) == 739785);
-    
+std::pair<int, int> read_file(const std::string &filename) {
+    Tokenizer in(filename);
+    return parse(in);
+}
+
+/* Test small cases at compile time */
+constexpr bool test() {
+    Tokenizer in(EXAMPLE);
+    auto [first, second] = parse(in);
     auto res = real_game(first, second);
-    assert(res.first == 444356092776315l && res.second == 341960390180808l);
+    return move(7, 5) == 2 && practice_game(first, second) == 739785 &&
+           res.first == 444356092776315l && res.second == 341960390180808l;
 }
 
-int main() {
-    test();
+static_assert(test());
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_21", "inputs/input21.txt", read_file,
+        [](const auto &data) { return practice_game(data.first, data.second); },
+        [](const auto &data) {
+            auto res = real_game(data.first, data.second);
+            return std::max(res.first, res.second);
+        });
+}
+#else
+int main() {
     auto [first, second] = read_file("inputs/input21.txt");
     std::cout << practice_game(first, second) << '\n';
     auto res = real_game(first, second);
@@ -144,4 +133,4 @@ int main() {
      
     return 0;
 }
-
+#endif
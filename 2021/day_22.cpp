@@ -1,12 +1,13 @@
 #include <iostream>
-#include <fstream>
-#include <regex>
 #include <cassert>
 #include <algorithm>
 #include <vector>
 #include <optional>
 #include <numeric>
 
+#include "benchmark.h"
+#include "tokenizer.h"
+
 struct Point {
     int x;
     int y;
@@ -106,27 +107,21 @@ long turned_on_cubes(const std::vector<Step> &steps) {
 }
 
 std::vector<Step> read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
+    Tokenizer in(filename);
     std::vector<Step> steps;
     
-    std::string line;
-    std::regex step_regex("(on|off) x=(-?\\d+)..(-?\\d+),y=(-?\\d+)..(-?\\d+),z=(-?\\d+)..(-?\\d+)");
-    std::smatch match;
-
-    while (std::getline(in, line)) {
-        std::regex_match(line, match, step_regex);
-        steps.push_back({
-            match.str(1) == "on", {
-                std::stoi(match.str(2)),
-                std::stoi(match.str(4)),
-                std::stoi(match.str(6))
-            }, {
-                std::stoi(match.str(3)),
-                std::stoi(match.str(5)),
-                std::stoi(match.str(7))
-            }
-        });
+    // Lines are "on|off x=x1..x2,y=y1..y2,z=z1..z2"
+    std::string_view state;
+    int x1, x2, y1, y2, z1, z2;
+
+    while (in.next_token(state)) {
+        in.next_int(x1);
+        in.next_int(x2);
+        in.next_int(y1);
+        in.next_int(y2);
+        in.next_int(z1);
+        in.next_int(z2);
+        steps.push_back({ state == "on", { x1, y1, z1 }, { x2, y2, z2 } });
     }
 
     return steps;
@@ -139,6 +134,12 @@ void test() {
     assert(turned_on_cubes(steps) == 2758514936282235l);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_22", "inputs/input22.txt", read_file,
+        reboot, turned_on_cubes);
+}
+#else
 int main() {
     test();
 
@@ -148,4 +149,4 @@ int main() {
     
     return 0;
 }
-
+#endif
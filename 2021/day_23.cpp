@@ -1,13 +1,16 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <deque>
-#include <queue>
 #include <map>
-#include <set>
+#include <cstdint>
+#include <cstdlib>
 #include <algorithm>
 #include <cassert>
 
+#include "benchmark.h"
+#include "tokenizer.h"
+#include "search.h"
+
 std::map<char, int> ENERGIES = {
     { 'A', 1 }, { 'B', 10 }, { 'C', 100 }, { 'D', 1000 }
 };
@@ -32,126 +35,186 @@ struct Burrow {
     }
 };
 
-bool operator<(const Burrow &lhs, const Burrow &rhs) {
-    if (lhs.hallway != rhs.hallway) return lhs.hallway < rhs.hallway;
-    return lhs.rooms < rhs.rooms;
+/* Index of the hallway position in front of the room */
+int room_index(char room) {
+    return (room - 'A') * 2 + 2;
 }
 
-struct State {
-    Burrow situation;
-    int energy;
-};
+/* Burrows as numbers in base 5, with a digit for every hallway position and
+ * every room slot from the bottom up. Empty spaces are 0 and amphipods A-D are
+ * 1-4. */
+struct Organizer {
+    using State = std::uint64_t;
+
+    /* A move costs at most 1000 * (10 + 4), and the estimate never grows by
+     * more than the cost of the move */
+    static constexpr search::Cost MAX_STEP = 2 * 1000 * 14;
+
+    int hallway_size;
+    int room_size;
+    State goal;
+
+    Organizer(int hallway_size, int room_size)
+        : hallway_size(hallway_size), room_size(room_size) {
+        Burrow final;
+        final.hallway.assign(hallway_size, '.');
+        for (char room = 'A'; room <= 'D'; ++room) {
+            final.rooms[room].assign(room_size, room);
+        }
+        goal = encode(final);
+    }
 
-bool operator<(const State &lhs, const State &rhs) {
-    return lhs.energy > rhs.energy;
-}
+    State encode(const Burrow &situation) const {
+        State state = 0;
 
-/* Find all possible moves and add the to priority queue */
-void generate_moves(const State &state, std::priority_queue<State> &q,
-                    const std::set<Burrow> &visited, int room_size) {
-    Burrow situation = state.situation;
+        for (char c : situation.hallway) {
+            state = state * 5 + (c == '.' ? 0 : c - 'A' + 1);
+        }
 
-    // Try moves from rooms to hallway
-    for (char room = 'A'; room <= 'D'; ++room) {
-        // Check if there are any amphipods to move
-        if (situation.rooms.at(room).empty()) continue;
-
-        char amphipod = situation.rooms.at(room).back();
-        int room_index = (room - 'A') * 2 + 2;
-
-        // Do not move amphipod from the correct room
-        if (room == amphipod && situation.rooms.at(room).front() == room) continue;
-
-        // Move left (change = -1) and right (change = 1) from the room
-        for (int change = -1; change <= 1; change += 2) {
-            for (decltype(situation.hallway.size()) pos = room_index + change;
-                    pos < situation.hallway.size() && pos >= 0 &&
-                    situation.hallway[pos] == '.'; pos += change) {
-                // Move into room if there is space
-                if (pos == 2 || pos == 4 || pos == 6 || pos == 8) continue;
-
-                // Create new situation
-                Burrow new_situation = situation;
-                new_situation.rooms[room].pop_back();
-                new_situation.hallway[pos] = amphipod;
-
-                // Calculate energy
-                int path_length = (std::abs((int) pos - room_index) + room_size - new_situation.rooms.at(room).size());
-
-                // Add to queue
-                if (visited.find(new_situation) == visited.end()) {
-                    q.push({ new_situation, state.energy + path_length * ENERGIES.at(amphipod) });
-                }
+        for (char room = 'A'; room <= 'D'; ++room) {
+            const auto &amphipods = situation.rooms.at(room);
+            for (int i = 0; i < room_size; ++i) {
+                state = state * 5 + (i < (int) amphipods.size() ? amphipods[i] - 'A' + 1 : 0);
             }
         }
-    }
 
-    // Try moves from hallway into correct rooms
-    for (decltype(situation.hallway.size()) hall = 0; hall < situation.hallway.size(); ++hall) {
-        // Check if there is amphipod in the current hallway position
-        if (situation.hallway[hall] == '.') continue;
+        return state;
+    }
 
-        char amphipod = situation.hallway[hall];
+    /* Digits are read back from the last one, so rooms are filled from the
+     * top and the hallway from the right */
+    Burrow decode(State state) const {
+        Burrow situation;
 
-        // Check if amphipod's room is available
-        bool available = true;
-        for (char c : situation.rooms.at(amphipod)) {
-            available = available && c == amphipod;
+        for (char room = 'D'; room >= 'A'; --room) {
+            auto &amphipods = situation.rooms[room];
+            for (int i = 0; i < room_size; ++i, state /= 5) {
+                if (state % 5) {
+                    amphipods.push_front('A' + state % 5 - 1);
+                }
+            }
         }
-        if (!available) continue;
 
-        // Check if path to room is clear
-        int room_index = (amphipod - 'A') * 2 + 2;
-        if (hall < room_index) {
-            for (decltype(situation.hallway.size()) pos = hall + 1; pos < room_index; ++pos) {
-                available = available && situation.hallway[pos] == '.';
+        situation.hallway.assign(hallway_size, '.');
+        for (int pos = hallway_size - 1; pos >= 0; --pos, state /= 5) {
+            if (state % 5) {
+                situation.hallway[pos] = 'A' + state % 5 - 1;
             }
-        } else {
-            for (decltype(situation.hallway.size()) pos = hall - 1; pos > room_index; --pos) {
-                available = available && situation.hallway[pos] == '.';
+        }
+
+        return situation;
+    }
+
+    bool is_goal(State state) const {
+        return state == goal;
+    }
+
+    /* Energy to move every amphipod that is not settled at the bottom of its
+     * room right in front of the room, as if nothing was in the way */
+    search::Cost estimate(State state) const {
+        Burrow situation = decode(state);
+        search::Cost energy = 0;
+
+        for (int pos = 0; pos < hallway_size; ++pos) {
+            char amphipod = situation.hallway[pos];
+            if (amphipod != '.') {
+                energy += (std::abs(pos - room_index(amphipod)) + 1) * ENERGIES.at(amphipod);
             }
         }
-        if (!available) continue;
 
-        // Move is valid, create new situation and calculate energy
-        Burrow new_situation = situation;
-        new_situation.rooms[amphipod].push_back(amphipod);
-        new_situation.hallway[hall] = '.';
-        int path_length = (std::abs((int) hall - room_index) + room_size - situation.rooms.at(amphipod).size());
+        for (char room = 'A'; room <= 'D'; ++room) {
+            const auto &amphipods = situation.rooms.at(room);
+            int settled = 0;
+            while (settled < (int) amphipods.size() && amphipods[settled] == room) {
+                ++settled;
+            }
 
-        if (visited.find(new_situation) == visited.end()) {
-            q.push({ new_situation, state.energy + path_length * ENERGIES.at(amphipod) });
+            for (int i = settled; i < (int) amphipods.size(); ++i) {
+                int path_length = room_size - i + std::abs(room_index(room) - room_index(amphipods[i])) + 1;
+                energy += path_length * ENERGIES.at(amphipods[i]);
+            }
         }
+
+        return energy;
     }
-}
 
-/* Find energy cost for organizing amphipods into corrent rooms */
-int organize_amphipods(const Burrow &start, int room_size) {
-    // PQ for Dijkstra
-    std::priority_queue<State> q;
-    std::set<Burrow> visited;
-    q.push({ start, 0 });
+    /* Find all possible moves */
+    template <typename Emit>
+    void neighbors(State state, Emit emit) const {
+        Burrow situation = decode(state);
+
+        // Try moves from rooms to hallway
+        for (char room = 'A'; room <= 'D'; ++room) {
+            // Check if there are any amphipods to move
+            if (situation.rooms.at(room).empty()) continue;
+
+            char amphipod = situation.rooms.at(room).back();
+            int room_pos = room_index(room);
+
+            // Do not move amphipod from the correct room
+            if (room == amphipod && situation.rooms.at(room).front() == room) continue;
+
+            // Move left (change = -1) and right (change = 1) from the room
+            for (int change = -1; change <= 1; change += 2) {
+                for (int pos = room_pos + change; pos < hallway_size && pos >= 0 &&
+                        situation.hallway[pos] == '.'; pos += change) {
+                    // Move into room if there is space
+                    if (pos == 2 || pos == 4 || pos == 6 || pos == 8) continue;
+
+                    // Create new situation
+                    Burrow new_situation = situation;
+                    new_situation.rooms[room].pop_back();
+                    new_situation.hallway[pos] = amphipod;
+
+                    // Calculate energy
+                    int path_length = std::abs(pos - room_pos) + room_size - new_situation.rooms.at(room).size();
+                    emit(encode(new_situation), path_length * ENERGIES.at(amphipod));
+                }
+            }
+        }
 
-    while (!q.empty()) {
-        // Take cheapest situation
-        State state = q.top();
-        q.pop();
+        // Try moves from hallway into correct rooms
+        for (int hall = 0; hall < hallway_size; ++hall) {
+            // Check if there is amphipod in the current hallway position
+            if (situation.hallway[hall] == '.') continue;
 
-        // Skip states to which we have already found the shortest path
-        if (visited.find(state.situation) != visited.end()) continue;
+            char amphipod = situation.hallway[hall];
 
-        visited.insert(state.situation);
+            // Check if amphipod's room is available
+            bool available = true;
+            for (char c : situation.rooms.at(amphipod)) {
+                available = available && c == amphipod;
+            }
+            if (!available) continue;
 
-        // Check if situation is final
-        if (state.situation.is_final()) {
-            return state.energy;
+            // Check if path to room is clear
+            int room_pos = room_index(amphipod);
+            if (hall < room_pos) {
+                for (int pos = hall + 1; pos < room_pos; ++pos) {
+                    available = available && situation.hallway[pos] == '.';
+                }
+            } else {
+                for (int pos = hall - 1; pos > room_pos; --pos) {
+                    available = available && situation.hallway[pos] == '.';
+                }
+            }
+            if (!available) continue;
+
+            // Move is valid, create new situation and calculate energy
+            Burrow new_situation = situation;
+            new_situation.rooms[amphipod].push_back(amphipod);
+            new_situation.hallway[hall] = '.';
+            int path_length = std::abs(hall - room_pos) + room_size - situation.rooms.at(amphipod).size();
+            emit(encode(new_situation), path_length * ENERGIES.at(amphipod));
         }
-
-        // Find all possible moves and add them to queue
-        generate_moves(state, q, visited, room_size);
     }
+};
 
-    return -1;
+/* Find energy cost for organizing amphipods into corrent rooms */
+int organize_amphipods(const Burrow &start, int room_size) {
+    Organizer organizer(start.hallway.size(), room_size);
+    auto result = search::shortest_path(organizer, organizer.encode(start));
+    return result.found ? result.cost : -1;
 }
 
 /* Insert amphipods hidden by the folding */
@@ -173,23 +236,20 @@ void unfold(Burrow &situation) {
 }
 
 Burrow read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
+    Tokenizer in(filename);
     Burrow situation;
 
-    std::string line;
+    std::string_view line;
 
     // Skip first line
-    in >> line >> line;
+    in.next_line(line);
+    in.next_line(line);
 
     // Read hallway
     for (decltype(line.size()) i = 1; i < line.size() - 1; ++i) {
         situation.hallway.push_back(line[i]);
     }
 
-    // Skip one line
-    in >> line;
-
     // Create empty rooms
     situation.rooms['A'] = std::deque<char>();
     situation.rooms['B'] = std::deque<char>();
@@ -197,7 +257,7 @@ Burrow read_file(const std::string &filename) {
     situation.rooms['D'] = std::deque<char>();
 
     // Read side rooms
-    while (std::getline(in, line) && line[3] != '#') {
+    while (in.next_line(line) && line.size() > 3 && line[3] != '#') {
         for (decltype(line.size()) i = 3; i < 10; i += 2) {
             situation.rooms['A' + (i - 3) / 2].push_front(line[i]);
         }
@@ -213,6 +273,17 @@ void test() {
     assert(organize_amphipods(situation, 4) == 44169);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_23", "inputs/input23.txt", read_file,
+        [](const Burrow &situation) { return organize_amphipods(situation, 2); },
+        [](const Burrow &situation) {
+            Burrow unfolded = situation;
+            unfold(unfolded);
+            return organize_amphipods(unfolded, 4);
+        });
+}
+#else
 int main() {
     test();
 
@@ -223,3 +294,4 @@ int main() {
 
     return 0;
 }
+#endif
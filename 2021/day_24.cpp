@@ -1,9 +1,11 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
 
+#include "benchmark.h"
+#include "tokenizer.h"
+
 struct Parameters {
     int a;
     int b;
@@ -12,20 +14,22 @@ struct Parameters {
 
 /* Read parameters for every interation */
 std::vector<Parameters> read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
+    Tokenizer in(filename);
 
     std::vector<Parameters> parameters;
-    std::string line;
+    std::string_view line;
     int a, b, c;
 
-    while (std::getline(in, line)) {
-        for (int i = 0; i < 3; ++i) std::getline(in, line);
-        in >> line >> line >> a;
-        in >> line >> line >> b;
-        for (int i = 0; i < 10; ++i) std::getline(in, line);
-        in >> line >> line >> c;
-        for (int i = 0; i < 3; ++i) std::getline(in, line);
+    // Every iteration is a block of 18 instructions, which only differ in
+    // the numbers of its 5th, 6th and 16th instruction
+    while (in.next_line(line)) {
+        for (int i = 0; i < 4; ++i) in.next_line(line);
+        Tokenizer(line).next_int(a);
+        in.next_line(line);
+        Tokenizer(line).next_int(b);
+        for (int i = 0; i < 10; ++i) in.next_line(line);
+        Tokenizer(line).next_int(c);
+        for (int i = 0; i < 2; ++i) in.next_line(line);
 
         parameters.push_back({ a, b, c});
     }
@@ -81,6 +85,13 @@ long find_valid_model_num(const std::vector<Parameters> &parameters, bool max_mo
     return zs[0];
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_24", "inputs/input24.txt", read_file,
+        [](const auto &parameters) { return find_valid_model_num(parameters, true); },
+        [](const auto &parameters) { return find_valid_model_num(parameters, false); });
+}
+#else
 int main() {
     
     std::vector<Parameters> parameters = read_file("inputs/input24.txt"); 
@@ -89,4 +100,4 @@ int main() {
     
     return 0;
 }
-
+#endif
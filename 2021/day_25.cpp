@@ -1,20 +1,25 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <cassert>
 
+#include "benchmark.h"
+#include "tokenizer.h"
+#include "grid.h"
+
+typedef Grid<char> Cucumbers;
+
 /* Move all cucumbers in the selected herd */
-void move_cucumbers(const std::vector<std::string> &cucumbers,
-                    std::vector<std::string> &moved, char herd) {
-    for (int y = 0; y < cucumbers.size(); ++y) {
-        for (int x = 0; x < cucumbers[y].size(); ++x) {
-            if (cucumbers[y][x] == herd) {
-                if (herd == '>' && cucumbers[y][(x + 1) % cucumbers[y].size()] == '.') {
-                    moved[y][x] = '.';
-                    moved[y][(x + 1) % moved[y].size()] = herd;
-                } else if (herd == 'v' && cucumbers[(y + 1) % cucumbers.size()][x] == '.') {
-                    moved[y][x] = '.';
-                    moved[(y + 1) % moved.size()][x] = herd;
+void move_cucumbers(const Cucumbers &cucumbers, Cucumbers &moved, char herd) {
+    for (int y = 0; y < cucumbers.rows; ++y) {
+        auto line = cucumbers.row(y);
+        for (int x = 0; x < cucumbers.cols; ++x) {
+            if (line[x] == herd) {
+                if (herd == '>' && line[(x + 1) % cucumbers.cols] == '.') {
+                    moved(y, x) = '.';
+                    moved(y, (x + 1) % moved.cols) = herd;
+                } else if (herd == 'v' && cucumbers((y + 1) % cucumbers.rows, x) == '.') {
+                    moved(y, x) = '.';
+                    moved((y + 1) % moved.rows, x) = herd;
                 }
             }
         }
@@ -22,9 +27,12 @@ void move_cucumbers(const std::vector<std::string> &cucumbers,
 }
 
 /* Return step on which cucumbers stop moving */
-int cucumbers_stop(std::vector<std::string> cucumbers) {
+int cucumbers_stop(Cucumbers cucumbers) {
+    // Both grids keep their buffers over all steps
+    Cucumbers moved;
+
     for (int step = 1; true; ++step) {
-        std::vector<std::string> moved = cucumbers;
+        moved = cucumbers;
 
         // Move cucumbers facing east
         move_cucumbers(cucumbers, moved, '>'); 
@@ -39,36 +47,41 @@ int cucumbers_stop(std::vector<std::string> cucumbers) {
             return step;
         }
 
-        cucumbers = std::move(moved);
+        cucumbers.swap(moved);
     }
 
     return -1;
 }
 
-std::vector<std::string> read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
+Cucumbers read_file(const std::string &filename) {
+    Tokenizer in(filename);
     
-    std::vector<std::string> cucumbers;
-    std::string line;
-    while (std::getline(in, line)) {
-        cucumbers.push_back(line);
+    std::vector<std::string_view> lines;
+    std::string_view line;
+    while (in.next_line(line)) {
+        lines.push_back(line);
     }
 
-    return cucumbers;
+    return make_grid(lines, 0, '.', [](char c) { return c; });
 }
 
 void test() {
-    std::vector<std::string> cucumbers = read_file("inputs/input25_test.txt");
+    Cucumbers cucumbers = read_file("inputs/input25_test.txt");
     assert(cucumbers_stop(cucumbers) == 58);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_25", "inputs/input25.txt", read_file,
+        cucumbers_stop);
+}
+#else
 int main() {
     test();
 
-    std::vector<std::string> cucumbers = read_file("inputs/input25.txt");
+    Cucumbers cucumbers = read_file("inputs/input25.txt");
     std::cout << cucumbers_stop(cucumbers) << '\n';
     
     return 0;
 }
-
+#endif
@@ -1,113 +1,153 @@
 #include <iostream>
-#include <fstream>
-#include <vector>
-#include <cassert>
-#include <utility>
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <string>
-#include <cmath>
+#include <string_view>
+#include <vector>
 
-/* Read input data */
-std::vector<std::string> read_data(const std::string &filename) {
-    std::vector<std::string> data; 
-
-    std::ifstream in;
-    in.open(filename);
-    std::string line;
-    while (in >> line) {
-        data.push_back(line);
+#include "benchmark.h"
+#include "tokenizer.h"
+
+/* Diagnostic report with every line packed into an integer */
+struct Report {
+    int width = 0;
+    std::vector<std::uint64_t> numbers;
+};
+
+/* Example from the puzzle description */
+constexpr std::string_view EXAMPLE =
+    "00100\n11110\n10110\n10111\n10101\n01111\n00111\n11100\n10000\n11001\n00010\n01010\n";
+
+/* Parse lines of binary digits of up to 64 bits */
+constexpr Report parse(Tokenizer &in) {
+    Report report;
+
+    std::string_view line;
+    while (in.next_token(line)) {
+        std::uint64_t number = 0;
+        for (char c : line) {
+            number = 2 * number + (c == '1');
+        }
+        report.width = line.size();
+        report.numbers.push_back(number);
     }
 
-    return data;
+    return report;
 }
 
-/* Calculate power consumption */
-int calculate_power(const std::vector<std::string> &data) {
-    // Get length of inputs
-    auto length = data[0].size();
-    
-    std::vector<int> ones(length);
-
-    // Calculate number of zeros and ones
-    for (const std::string &input : data) {
-        for (decltype(input.size()) i = 0; i < input.size(); ++i) {
-            if (input[i] == '0') {
-                --ones[i];
-            } else if (input[i] == '1') {
-                ++ones[i];
-            }
+/* Read input data */
+Report read_data(const std::string &filename) {
+    Tokenizer in(filename);
+    return parse(in);
+}
+
+/* Count set bits of every bit position of the numbers. The counts are kept
+ * bit-sliced: bit j of planes[k] is bit k of the count of position j, so
+ * adding a number to all counts at once is a binary increment with the
+ * number as the carry into planes[0]. */
+constexpr std::array<std::uint64_t, 64> count_ones(const std::vector<std::uint64_t> &numbers) {
+    std::array<std::uint64_t, 64> planes{};
+    for (std::uint64_t carry : numbers) {
+        for (int k = 0; carry; ++k) {
+            std::uint64_t next = planes[k] & carry;
+            planes[k] ^= carry;
+            carry = next;
+        }
+    }
+
+    std::array<std::uint64_t, 64> ones{};
+    for (int k = 0; k < 64; ++k) {
+        for (int j = 0; j < 64; ++j) {
+            ones[j] |= (planes[k] >> j & 1) << k;
         }
     }
+    return ones;
+}
+
+/* Calculate power consumption */
+constexpr std::uint64_t calculate_power(const Report &report) {
+    std::array<std::uint64_t, 64> ones = count_ones(report.numbers);
 
     // Find gamma and epsilon rates
-    int gamma = 0, epsilon = 0;
-    for (int num_ones : ones) {
-        if (num_ones >= 0) {
-            gamma = 2 * gamma + 1;
-            epsilon *= 2;
+    std::uint64_t gamma = 0, epsilon = 0;
+    for (int i = 0; i < report.width; ++i) {
+        if (2 * ones[i] >= report.numbers.size()) {
+            gamma |= std::uint64_t(1) << i;
         } else {
-            gamma *= 2;
-            epsilon = 2 * epsilon + 1;
+            epsilon |= std::uint64_t(1) << i;
         }
     }
 
-   return gamma * epsilon;
+    return gamma * epsilon;
 }
 
-/* Calculate life support rating*/
-int calculate_life_support(const std::vector<std::string> &data) {
-    auto oxygen_candidates = data;
-    auto co2_candidates = data;
-    auto length = data[0].size();
-
-    // Find oxygen rating
-    for (decltype(data[0].size()) i = 0; i < length && oxygen_candidates.size(); ++i) {
-        // Find most common bit value
-        int ones = 0;
-        for (decltype(oxygen_candidates.size()) j = 0; j < oxygen_candidates.size(); ++j) {
-            if (oxygen_candidates[j][i] == '0') --ones;
-            else if (oxygen_candidates[j][i]) ++ones;
-        }
+/* Find the rating that keeps the numbers with the most common bit (or the
+ * least common one) at each position until one is left. The numbers are
+ * sorted, so the candidates always share all bits above the current one
+ * and form a range, which the first candidate with the bit set splits. If
+ * all candidates have the same bit, as repeated numbers do, they are all
+ * kept. */
+constexpr std::uint64_t find_rating(const std::vector<std::uint64_t> &sorted, int width,
+                                    bool most_common) {
+    if (sorted.empty()) {
+        return 0;
+    }
 
-        char keep = ones >= 0 ? '1' : '0';
-
-        // Filter candidates
-        std::erase_if(oxygen_candidates, [i, keep](auto &a) {
-            return a[i] != keep;
-        });
-    } 
-
-    // Find CO2 rating
-    for (decltype(data[0].size()) i = 0; i < length && co2_candidates.size(); ++i) {
-        // Find most common bit value
-        int ones = 0;
-        for (decltype(co2_candidates.size()) j = 0; j < co2_candidates.size(); ++j) {
-            if (co2_candidates[j][i] == '0') --ones;
-            else if (co2_candidates[j][i]) ++ones;
+    auto first = sorted.begin(), last = sorted.end();
+
+    for (int i = width - 1; i >= 0 && last - first > 1; --i) {
+        std::uint64_t bit = std::uint64_t(1) << i;
+        std::uint64_t prefix = *first & ~(2 * bit - 1);
+        auto split = std::lower_bound(first, last, prefix | bit);
+
+        bool keep_ones = (last - split >= split - first) == most_common;
+        if (split == first || split == last) {
+            continue;
+        } else if (keep_ones) {
+            first = split;
+        } else {
+            last = split;
         }
+    }
 
-        char keep = ones < 0 ? '1' : '0';
+    return *first;
+}
+
+/* Calculate life support rating*/
+constexpr std::uint64_t calculate_life_support(const Report &report) {
+    std::vector<std::uint64_t> sorted = report.numbers;
+    std::sort(sorted.begin(), sorted.end());
 
-        // Filter candidates
-        std::erase_if(co2_candidates, [i, keep](auto &a) {
-            return a[i] != keep;
-        });
-    } 
-    
-    return std::stoi(oxygen_candidates[0], nullptr, 2) * std::stoi(co2_candidates[0], nullptr, 2);
+    return find_rating(sorted, report.width, true) * find_rating(sorted, report.width, false);
 }
 
-void test() {
-    std::vector<std::string> test_data = read_data("inputs/input3_test.txt");
-    assert(calculate_power(test_data) == 198);
-    assert(calculate_life_support(test_data) == 230);
+/* Test small cases at compile time */
+constexpr bool test() {
+    Tokenizer in(EXAMPLE);
+    Report test_data = parse(in);
+
+    // Both ratings end up with repeated numbers
+    Tokenizer repeated_in(std::string_view("00100\n00100\n11110\n11110\n11111\n"));
+    Report repeated = parse(repeated_in);
+
+    return calculate_power(test_data) == 198 && calculate_life_support(test_data) == 230 &&
+           calculate_life_support(repeated) == 4 * 30 && calculate_life_support(Report()) == 0;
 }
 
-int main() {
-    test();
+static_assert(test());
 
-    std::vector<std::string> data = read_data("inputs/input3.txt");
-    std::cout << calculate_power(data) << std::endl;
-    std::cout << calculate_life_support(data) << std::endl;
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_3", "inputs/input3.txt", read_data,
+        calculate_power, calculate_life_support);
+}
+#else
+int main() {
+    Report report = read_data("inputs/input3.txt");
+    std::cout << calculate_power(report) << std::endl;
+    std::cout << calculate_life_support(report) << std::endl;
 
     return 0;
 }
+#endif
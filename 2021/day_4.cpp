@@ -1,49 +1,72 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
+#include <algorithm>
 #include <array>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <string_view>
 #include <utility>
-#include <cassert>
+
+#include "benchmark.h"
+#include "tokenizer.h"
 
 #define BOARD_SIZE 5
 
 typedef std::array<std::array<int, BOARD_SIZE>, BOARD_SIZE> Board;
 typedef std::pair<std::vector<int>, std::vector<Board>> Data;
 
-/* Read and parse input data */
-Data read_file(const std::string &filename) {
-    std::ifstream in;
-    in.open(filename);
+/* A board that won, with the index of the drawn number that completed it */
+struct Win {
+    std::size_t turn;
+    std::size_t board;
+    int score;
+};
+
+/* Marks of a board still in play */
+struct Marks {
+    std::uint32_t cells = 0;
+    int sum = 0;
+    std::array<int, BOARD_SIZE> rows{};
+    std::array<int, BOARD_SIZE> columns{};
+    bool won = false;
+};
+
+/* Example from the puzzle description */
+constexpr std::string_view EXAMPLE =
+    "7,4,9,5,11,17,23,2,0,14,21,24,10,16,13,6,15,25,12,22,18,20,8,19,3,26,1\n"
+    "\n"
+    "22 13 17 11  0\n 8  2 23  4 24\n21  9 14 16  7\n 6 10  3 18  5\n 1 12 20 15 19\n"
+    "\n"
+    " 3 15  0  2 22\n 9 18 13 17  5\n19  8  7 25 23\n20 11 10 24  4\n14 21 16 12  6\n"
+    "\n"
+    "14 21 17 24  4\n10 16 15  9 19\n18  8 23 26 20\n22 11 13  6  5\n 2  0 12  3  7\n";
 
+/* Parse the drawn numbers and the boards */
+constexpr Data parse(Tokenizer &in) {
     // Read bingo numbers
     std::vector<int> numbers;
-    std::string numbers_line_str;
-    std::getline(in, numbers_line_str);
-    std::stringstream numbers_line;  
-    numbers_line.str(numbers_line_str);
+    std::string_view numbers_line_str;
+    in.next_line(numbers_line_str);
+    Tokenizer numbers_line(numbers_line_str);
     
     int number;
-    char tmp;
-    while (numbers_line >> number) {
+    while (numbers_line.next_int(number)) {
         numbers.push_back(number);
-        
-        // Read comma character
-        numbers_line >> tmp; 
     }
 
     // Read boards
     std::vector<Board> boards;
-    while (in >> number) {
+    while (in.next_int(number)) {
         // Read new board
-        Board new_board;
+        Board new_board{};
         for (decltype(new_board.size()) i = 0; i < BOARD_SIZE; ++i) {
             for (decltype(new_board[i].size()) j = 0; j < BOARD_SIZE; ++j) {
                 new_board[i][j] = number; 
 
                 // Don't read the first number of the next board
                 if (i != BOARD_SIZE - 1 || j != BOARD_SIZE - 1) {
-                    in >> number;
+                    in.next_int(number);
                 }
             }
         }
@@ -53,80 +76,183 @@ Data read_file(const std::string &filename) {
     return std::make_pair(numbers, boards);
 }
 
-/* Return sum of all unmarked values */
-int _unmarked_sum(const Board &board) {
-    int sum = 0;
-    for (const auto line : board) {
-        for (const int value : line) {
-            // Unmarked numbers are positive
-            if (value > 0) {
-                sum += value;
+/* Read and parse input data */
+Data read_file(const std::string &filename) {
+    Tokenizer in(filename);
+    return parse(in);
+}
+
+/* Play bingo on all boards at once and return every board that wins, in the
+ * order they win. Boards winning on the same number are ordered by index,
+ * like when they are checked one by one.
+ *
+ * An inverted index lists the cells (board, row and column) of every number
+ * in board order, so each drawn number only visits its own cells, and every
+ * board counts the marks of its rows and columns. The whole game takes
+ * O(numbers + boards * cells) if the values on the boards span a range not
+ * much larger than the number of cells, as in the puzzle, and otherwise a
+ * logarithmic factor more. */
+constexpr std::vector<Win> play_bingo(const std::vector<int> &numbers,
+                                      const std::vector<Board> &boards) {
+    constexpr int CELLS = BOARD_SIZE * BOARD_SIZE;
+
+    // Values on the boards get dense ids, their offset from the smallest one
+    // if the range is small enough and otherwise their rank among the
+    // distinct values, so the index is never larger than the boards
+    int low = INT_MAX, high = INT_MIN;
+    for (const Board &board : boards) {
+        for (const auto &row : board) {
+            for (int value : row) {
+                low = std::min(low, value);
+                high = std::max(high, value);
             }
         }
     }
-    return sum;
-}
 
-/* Play bingo using given inputs */
-std::pair<std::vector<int>::size_type, int>
-bingo(const std::vector<int> &numbers, std::vector<Board> boards) {
-    // Create counter for rows and columns
-    std::vector<std::pair<std::array<int, BOARD_SIZE>, std::array<int, BOARD_SIZE>>> counts(boards.size());
-    // [( # marked in i-th row, # marked in j-th column )]
-    
-    // Clear every number ...
-    for (const int number : numbers) {
-        // ... on every board
-        for (decltype(boards.size()) k = 0; k < boards.size(); ++k) {
-            Board &board = boards[k];
-
-            for (decltype(board.size()) i = 0; i < board.size(); ++i) {
-                for (decltype(board[i].size()) j = 0; j < board[i].size(); ++j) {
-                    // Check for correct number and mark it if found
-                    if (number == board[i][j]) {
-                        board[i][j] = -1;
-                        ++counts[k].first[i];
-                        ++counts[k].second[j];
-
-                        // Check if game is finished
-                        if (counts[k].first[i] == BOARD_SIZE || counts[k].second[j] == BOARD_SIZE) {
-                            return std::make_pair(k, _unmarked_sum(board) * number);
-                        }
+    std::size_t size = 0;
+    std::vector<int> values;
+    bool offset = (long long) high - low < 4 * (long long) (boards.size() * CELLS);
+    if (boards.empty()) {
+        offset = true;
+    } else if (offset) {
+        size = (long long) high - low + 1;
+    } else {
+        for (const Board &board : boards) {
+            for (const auto &row : board) {
+                values.insert(values.end(), row.begin(), row.end());
+            }
+        }
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        size = values.size();
+    }
+
+    // Id of a value, or size if it is on no board
+    auto id = [&](int value) {
+        if (offset) {
+            return value < low || value > high ? size : std::size_t((long long) value - low);
+        }
+        auto it = std::lower_bound(values.begin(), values.end(), value);
+        return it == values.end() || *it != value ? size : std::size_t(it - values.begin());
+    };
+
+    // Cells of the number with id n are cells[start[n]] up to
+    // cells[start[n + 1]], as board * CELLS + row * BOARD_SIZE + column
+    std::vector<std::size_t> start(size + 1);
+    for (const Board &board : boards) {
+        for (const auto &row : board) {
+            for (int value : row) {
+                ++start[id(value) + 1];
+            }
+        }
+    }
+    for (std::size_t n = 0; n < size; ++n) {
+        start[n + 1] += start[n];
+    }
+
+    std::vector<std::size_t> cells(boards.size() * CELLS);
+    std::vector<std::size_t> next(start.begin(), start.end() - 1);
+    for (std::size_t k = 0; k < boards.size(); ++k) {
+        for (int cell = 0; cell < CELLS; ++cell) {
+            cells[next[id(boards[k][cell / BOARD_SIZE][cell % BOARD_SIZE])]++] = k * CELLS + cell;
+        }
+    }
+
+    std::vector<Marks> marks(boards.size());
+    std::vector<Win> wins;
+    for (std::size_t turn = 0; turn < numbers.size(); ++turn) {
+        int number = numbers[turn];
+        std::size_t n = id(number);
+        if (n == size) {
+            continue;
+        }
+
+        for (std::size_t c = start[n]; c < start[n + 1]; ++c) {
+            std::size_t k = cells[c] / CELLS;
+            int cell = cells[c] % CELLS, i = cell / BOARD_SIZE, j = cell % BOARD_SIZE;
+            Marks &board = marks[k];
+
+            // Numbers drawn again are already marked
+            if (board.won || board.cells >> cell & 1) {
+                continue;
+            }
+
+            board.cells |= std::uint32_t(1) << cell;
+            board.sum += number;
+
+            // Check if game is finished
+            if (++board.rows[i] == BOARD_SIZE || ++board.columns[j] == BOARD_SIZE) {
+                int total = 0;
+                for (const auto &row : boards[k]) {
+                    for (int value : row) {
+                        total += value;
                     }
                 }
+
+                board.won = true;
+                wins.push_back({ turn, k, (total - board.sum) * number });
             }
-        } 
+        }
     }
-    
-    // ( index of winning board, score )
-    return std::make_pair(-1, -1);
+
+    return wins;
 }
 
-/* Play bingo until the last board wins */
-int last_score(std::vector<int> numbers, std::vector<Board> boards) {
-    while (boards.size() > 1) {
-        auto result = bingo(numbers, boards);
-        
-        // Remove the winning board
-        boards.erase(boards.begin() + result.first);
+/* Play bingo using given inputs and return the index and score of the first
+ * winning board, or -1 for both if no board wins */
+constexpr std::pair<std::vector<int>::size_type, int>
+bingo(const std::vector<int> &numbers, const std::vector<Board> &boards) {
+    std::vector<Win> wins = play_bingo(numbers, boards);
+    if (wins.empty()) {
+        return std::make_pair(-1, -1);
     }
+    return std::make_pair(wins.front().board, wins.front().score);
+}
 
-    // Get the remaining board score
-    return bingo(numbers, boards).second;
+/* Play bingo until the last board wins */
+constexpr int last_score(const std::vector<int> &numbers, const std::vector<Board> &boards) {
+    std::vector<Win> wins = play_bingo(numbers, boards);
+    return wins.empty() ? -1 : wins.back().score;
 }
 
-void test() {
-    Data test_data = read_file("inputs/input4_test.txt");
-    assert(bingo(test_data.first, test_data.second).second == 4512);
-    assert(last_score(test_data.first, test_data.second) == 1924);
+/* Test small cases at compile time */
+constexpr bool test() {
+    Tokenizer in(EXAMPLE);
+    Data test_data = parse(in);
+    std::vector<Win> wins = play_bingo(test_data.first, test_data.second);
+
+    // A winning row with a negative number, next to a board with the largest
+    // values the tokenizer reads
+    Tokenizer extreme_in(std::string_view(
+        "-5,21,17,24,4\n"
+        "\n"
+        "2147483647 13 17 11  0\n 8  2 23  4 24\n21  9 14 16  7\n 6 10  3 18  5\n"
+        " 1 12 20 15 -2147483647\n"
+        "\n"
+        "-5 21 17 24  4\n10 16 15  9 19\n18  8 23 26 20\n22 11 13  6  5\n 2  0 12  3  7\n"));
+    Data extreme = parse(extreme_in);
+
+    return bingo(test_data.first, test_data.second).second == 4512 &&
+           last_score(test_data.first, test_data.second) == 1924 &&
+           wins.size() == 3 && wins[0].board == 2 && wins[1].board == 0 && wins[2].board == 1 &&
+           wins[0].turn == 11 && wins[2].turn == 14 &&
+           bingo(extreme.first, extreme.second) == std::make_pair<std::size_t, int>(1, 980);
 }
 
-int main() {
-    test();
+static_assert(test());
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_4", "inputs/input4.txt", read_file,
+        [](const Data &data) { return bingo(data.first, data.second).second; },
+        [](const Data &data) { return last_score(data.first, data.second); });
+}
+#else
+int main() {
     Data data = read_file("inputs/input4.txt");
     std::cout << bingo(data.first, data.second).second << std::endl;
     std::cout << last_score(data.first, data.second) << std::endl;
 
     return 0;
 }
+#endif
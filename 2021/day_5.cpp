@@ -1,12 +1,23 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <utility>
-#include <regex>
 #include <cassert>
-#include <cstring>
+#include <cstdint>
+#include <climits>
 #include <algorithm>
-#include <new>
+#include <thread>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "benchmark.h"
+#include "tokenizer.h"
+
+/* Largest bounding box counted on a grid of cells, one byte each */
+constexpr long long DENSE_CELLS = 1 << 26;
+
+/* Fewest rows worth a thread of their own */
+constexpr int MIN_BAND_ROWS = 64;
 
 struct Line {
     int x1;
@@ -15,116 +26,361 @@ struct Line {
     int y2;
 };
 
-/* Read and parse input data in vector of Lines */
-std::pair<std::vector<Line>, int *> read_file(const std::string &filename) {
-    std::vector<Line> lines;
+struct Bounds {
+    int x_min = INT_MAX;
+    int y_min = INT_MAX;
+    int x_max = INT_MIN;
+    int y_max = INT_MIN;
+};
+
+typedef std::pair<std::vector<Line>, Bounds> Data;
+
+enum Direction { HORIZONTAL, VERTICAL, DIAGONAL, ANTIDIAGONAL, OTHER };
+
+/* Coefficients a and b of the lines a * x + b * y = c in each direction */
+constexpr int COEFFICIENTS[4][2] = { { 0, 1 }, { 1, 0 }, { 1, -1 }, { 1, 1 } };
+
+/* A line clipped to a band of rows. Its points are those of the line
+ * a * x + b * y = c of its direction whose position, x for horizontal lines
+ * and y for the others, is between low and high. */
+struct Segment {
+    Direction direction;
+    int c;
+    int low;
+    int high;
+};
 
-    std::ifstream in;
-    in.open(filename);
-    std::string line_str;
+/* Read and parse input data */
+Data read_file(const std::string &filename) {
+    std::vector<Line> lines;
 
-    // Create regex for parsing data
-    std::regex regex("^(\\d+),(\\d+) -> (\\d+),(\\d+)$");
+    Tokenizer in(filename);
+    std::string_view line_str;
 
     // Keep track of the border coordinates
-    int x_min = 0, y_min = 0, x_max = 0, y_max = 0;
-
-    while (std::getline(in, line_str)) {
-        std::smatch match;
-        if (std::regex_match(line_str, match, regex)) {
-            Line line;
-            line.x1 = std::stoi(match[1]);
-            line.y1 = std::stoi(match[2]);
-            line.x2 = std::stoi(match[3]);
-            line.y2 = std::stoi(match[4]);
+    Bounds bounds;
+
+    // Lines are of the form x1,y1 -> x2,y2, anything else is skipped
+    while (in.next_line(line_str)) {
+        Tokenizer numbers(line_str);
+        Line line;
+        if (numbers.next_uint(line.x1) && numbers.next_uint(line.y1) &&
+            numbers.next_uint(line.x2) && numbers.next_uint(line.y2)) {
             lines.push_back(line);
 
-            if (line.x1 < x_min) x_min = line.x1;
-            if (line.x2 < x_min) x_min = line.x2;
-            if (line.x1 > x_max) x_max = line.x1;
-            if (line.x1 > x_max) x_max = line.x2;
+            bounds.x_min = std::min({ bounds.x_min, line.x1, line.x2 });
+            bounds.x_max = std::max({ bounds.x_max, line.x1, line.x2 });
+            bounds.y_min = std::min({ bounds.y_min, line.y1, line.y2 });
+            bounds.y_max = std::max({ bounds.y_max, line.y1, line.y2 });
+        }
+    }
 
-            if (line.y1 < y_min) y_min = line.y1;
-            if (line.y2 < y_min) y_min = line.y2;
-            if (line.y1 > y_max) y_max = line.y1;
-            if (line.y2 > y_max) y_max = line.y2;
+    return std::make_pair(lines, bounds);
+}
+
+Direction direction(const Line &line) {
+    if (line.y1 == line.y2) return HORIZONTAL;
+    if (line.x1 == line.x2) return VERTICAL;
+    if (line.x2 - line.x1 == line.y2 - line.y1) return DIAGONAL;
+    if (line.x2 - line.x1 == line.y1 - line.y2) return ANTIDIAGONAL;
+    return OTHER;
+}
+
+/* Point of a segment at a position */
+std::pair<int, int> point_at(const Segment &segment, int position) {
+    switch (segment.direction) {
+    case HORIZONTAL: return { position, segment.c };
+    case VERTICAL: return { segment.c, position };
+    case DIAGONAL: return { position + segment.c, position };
+    default: return { segment.c - position, position };
+    }
+}
+
+/* Clip a line to the rows first to last, false if it has no points there */
+bool clip(const Line &line, int first, int last, Segment &segment) {
+    Direction d = direction(line);
+    int top = std::max(std::min(line.y1, line.y2), first);
+    int bottom = std::min(std::max(line.y1, line.y2), last);
+    if (d == OTHER || top > bottom) {
+        return false;
+    }
+
+    if (d == HORIZONTAL) {
+        segment = { d, line.y1, std::min(line.x1, line.x2), std::max(line.x1, line.x2) };
+    } else {
+        segment = { d, COEFFICIENTS[d][0] * line.x1 + COEFFICIENTS[d][1] * line.y1, top, bottom };
+    }
+    return true;
+}
+
+/* Key of the line of a direction through all points with the same c */
+std::uint64_t line_key(int d, int c) {
+    return std::uint64_t(d) << 32 | std::uint32_t(c);
+}
+
+/* Value of a * x + b * y for the lines of a direction through a point */
+long long line_at(int d, long long x, long long y) {
+    return COEFFICIENTS[d][0] * x + COEFFICIENTS[d][1] * y;
+}
+
+/* Range of the lines of a direction that a segment goes through */
+std::pair<long long, long long> span(const Segment &segment, int d) {
+    auto [x1, y1] = point_at(segment, segment.low);
+    auto [x2, y2] = point_at(segment, segment.high);
+    return std::minmax(line_at(d, x1, y1), line_at(d, x2, y2));
+}
+
+/* Collect the points where segments of direction s cross those of
+ * direction t. Each segment of s lies on line p of s and spans a range of
+ * lines of t, and the other way round for those of t. A sweep over the lines
+ * of t keeps the segments of s spanning the current one ordered by p, and
+ * looks up those in the span of each segment of t on it. This only visits
+ * pairs that do cross, although some of them only between lattice points. */
+void find_crossings(const std::vector<Segment> &segments, Direction s, Direction t,
+                    std::unordered_set<std::uint64_t> &crossings) {
+    // Segments of s start before those of t are looked up and end after
+    enum Kind { START, LOOKUP, END };
+    struct Event {
+        long long q;
+        Kind kind;
+        std::size_t index;
+
+        bool operator<(const Event &other) const {
+            return q < other.q || (q == other.q && kind < other.kind);
+        }
+    };
+
+    std::vector<Event> events;
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        if (segments[i].direction == s) {
+            auto [first, last] = span(segments[i], t);
+            events.push_back({ first, START, i });
+            events.push_back({ last, END, i });
+        } else if (segments[i].direction == t) {
+            events.push_back({ segments[i].c, LOOKUP, i });
         }
+    }
+    std::sort(events.begin(), events.end());
 
-    } 
+    long long a1 = COEFFICIENTS[s][0], b1 = COEFFICIENTS[s][1];
+    long long a2 = COEFFICIENTS[t][0], b2 = COEFFICIENTS[t][1];
+    long long det = a1 * b2 - a2 * b1;
 
-    int *limits = new int[4];
-    limits[0] = x_min; limits[1] = y_min; limits[2] = x_max; limits[3] = y_max;
-    return std::make_pair(lines, limits);
+    std::set<std::pair<long long, std::size_t>> active;
+    for (const Event &event : events) {
+        const Segment &segment = segments[event.index];
+        if (event.kind == START) {
+            active.insert({ segment.c, event.index });
+        } else if (event.kind == END) {
+            active.erase({ segment.c, event.index });
+        } else {
+            auto [first, last] = span(segment, s);
+            for (auto it = active.lower_bound({ first, 0 });
+                 it != active.end() && it->first <= last; ++it) {
+                long long x = it->first * b2 - segment.c * b1;
+                long long y = a1 * segment.c - a2 * it->first;
+                if (x % det == 0 && y % det == 0) {
+                    crossings.insert(std::uint64_t(std::uint32_t(x / det)) << 32 |
+                                     std::uint32_t(y / det));
+                }
+            }
+        }
+    }
 }
 
-/* Find points where at least 2 vertical or horizontal lines intersect */
-int find_danger_points(const std::vector<Line> &lines, int height, int width) {
-    int diagram[height][width] = {0}; 
-    std::memset(diagram, 0, sizeof(diagram));
-    int danger_points = 0;
-    
-    for (const Line line : lines) {
-        // Only consider vertical and horizontal lines
-        if (line.x1 == line.x2) {            
-            for (int y = std::min(line.y1, line.y2); y <= std::max(line.y1, line.y2); ++y) {
-                ++diagram[y][line.x1];
-                if (diagram[y][line.x1] == 2) ++danger_points;
+/* Count points covered twice in the rows first to last on a grid of cells
+ * saturating at 2, of which the band owns its own rows */
+std::size_t count_dense(const std::vector<Segment> &segments, const Bounds &bounds,
+                        int first, std::uint8_t *rows) {
+    std::size_t width = bounds.x_max - bounds.x_min + 1, count = 0;
+
+    for (const Segment &segment : segments) {
+        for (int position = segment.low; position <= segment.high; ++position) {
+            auto [x, y] = point_at(segment, position);
+            std::uint8_t &cell = rows[(y - first) * width + (x - bounds.x_min)];
+            if (cell < 2 && ++cell == 2) ++count;
+        }
+    }
+
+    return count;
+}
+
+/* Count points covered twice in a band without visiting its points. Segments
+ * on the same line are merged into the ranges they cover and those covered
+ * at least twice, and the points where the merged segments of different
+ * lines cross are collected in a hash set. Points in the ranges of several
+ * lines are crossings as well, which corrects for them being counted once
+ * per line. */
+std::size_t count_sparse(const std::vector<Segment> &segments) {
+    std::unordered_map<std::uint64_t, std::vector<std::pair<int, int>>> ranges;
+    for (const Segment &segment : segments) {
+        auto &events = ranges[line_key(segment.direction, segment.c)];
+        events.push_back({ segment.low, 1 });
+        events.push_back({ segment.high + 1, -1 });
+    }
+
+    // Merge the segments of each line, and replace its events with the
+    // ranges covered twice
+    std::size_t count = 0;
+    std::vector<Segment> merged;
+    for (auto &[key, events] : ranges) {
+        std::sort(events.begin(), events.end());
+        std::vector<std::pair<int, int>> overlaps;
+        int depth = 0;
+        for (std::size_t i = 0; i < events.size();) {
+            int position = events[i].first;
+            if (depth == 0) {
+                merged.push_back({ Direction(key >> 32), std::int32_t(key), position, 0 });
+            }
+            while (i < events.size() && events[i].first == position) {
+                depth += events[i++].second;
+            }
+            if (depth == 0) {
+                merged.back().high = position - 1;
+            } else if (depth >= 2) {
+                overlaps.push_back({ position, events[i].first - 1 });
+                count += events[i].first - position;
+            }
+        }
+        events = std::move(overlaps);
+    }
+
+    std::unordered_set<std::uint64_t> crossings;
+    for (int s = HORIZONTAL; s <= ANTIDIAGONAL; ++s) {
+        for (int t = s + 1; t <= ANTIDIAGONAL; ++t) {
+            find_crossings(merged, Direction(s), Direction(t), crossings);
+        }
+    }
+
+    for (std::uint64_t crossing : crossings) {
+        int x = std::int32_t(crossing >> 32), y = std::int32_t(crossing);
+        count += 1;
+
+        for (int d = HORIZONTAL; d <= ANTIDIAGONAL; ++d) {
+            auto it = ranges.find(line_key(d, COEFFICIENTS[d][0] * x + COEFFICIENTS[d][1] * y));
+            if (it == ranges.end()) {
+                continue;
             }
-        } 
 
-        if (line.y1 == line.y2) {
-            for (int x = std::min(line.x1, line.x2); x <= std::max(line.x1, line.x2); ++x) {
-                ++diagram[line.y1][x];
-                if (diagram[line.y1][x] == 2) ++danger_points;
+            int position = d == HORIZONTAL ? x : y;
+            auto range = std::upper_bound(it->second.begin(), it->second.end(),
+                                          std::make_pair(position, INT_MAX));
+            if (range != it->second.begin() && std::prev(range)->second >= position) {
+                count -= 1;
             }
         }
-   }
-    
-    return danger_points;
+    }
+
+    return count;
 }
 
-/* Find points where at least 2 lines intersect */
-int find_danger_points_diag(const std::vector<Line> &lines, int height, int width) {
-    int diagram[height][width] = {0}; 
-    std::memset(diagram, 0, sizeof(diagram));
-    int danger_points = 0;
+/* Count points where at least 2 lines overlap, considering only horizontal
+ * and vertical lines unless diagonal is set. The rows are split into bands
+ * counted on their own thread each, on a grid if dense is set and otherwise
+ * from the segments alone. */
+std::size_t count_danger_points(const std::vector<Line> &lines, const Bounds &bounds,
+                                bool diagonal, bool dense, unsigned threads) {
+    if (lines.empty()) {
+        return 0;
+    }
 
-    for (const Line line : lines) {
-        int dx = line.x1 == line.x2 ? 0 : (line.x2 - line.x1) / (std::max(line.x1, line.x2) - std::min(line.x1, line.x2));
-        int dy = line.y1 == line.y2 ? 0 : (line.y2 - line.y1) / (std::max(line.y1, line.y2) -  std::min(line.y1, line.y2));
+    long long height = (long long) bounds.y_max - bounds.y_min + 1;
+    long long width = (long long) bounds.x_max - bounds.x_min + 1;
+    threads = std::clamp<long long>(threads, 1, height);
 
-        for (int x = line.x1, y = line.y1; ; x += dx, y += dy) {
-            ++diagram[y][x];
-            if (diagram[y][x] == 2) ++danger_points;
+    std::vector<std::uint8_t> grid(dense ? height * width : 0);
+    std::vector<std::size_t> counts(threads);
+    std::vector<std::thread> workers;
 
-            if (x == line.x2 && y == line.y2) break;
-        }
-   }
-    
-    return danger_points;
+    for (unsigned i = 0; i < threads; ++i) {
+        int first = bounds.y_min + height * i / threads;
+        int last = bounds.y_min + height * (i + 1) / threads - 1;
+
+        workers.emplace_back([&, i, first, last]() {
+            std::vector<Segment> segments;
+            Segment segment;
+            for (const Line &line : lines) {
+                if (clip(line, first, last, segment) &&
+                    (diagonal || segment.direction == HORIZONTAL || segment.direction == VERTICAL)) {
+                    segments.push_back(segment);
+                }
+            }
+
+            counts[i] = dense ? count_dense(segments, bounds, first,
+                                            grid.data() + (first - bounds.y_min) * width)
+                              : count_sparse(segments);
+        });
+    }
+
+    std::size_t count = 0;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers[i].join();
+        count += counts[i];
+    }
+    return count;
+}
+
+/* Whether the lines fit a grid of cells */
+bool fits_grid(const Bounds &bounds) {
+    return ((long long) bounds.x_max - bounds.x_min + 1) *
+           ((long long) bounds.y_max - bounds.y_min + 1) <= DENSE_CELLS;
+}
+
+unsigned band_threads(const Bounds &bounds) {
+    return std::clamp((bounds.y_max - bounds.y_min + 1) / MIN_BAND_ROWS, 1,
+                      std::max<int>(std::thread::hardware_concurrency(), 1));
+}
+
+/* Find points where at least 2 vertical or horizontal lines intersect */
+std::size_t find_danger_points(const std::vector<Line> &lines, const Bounds &bounds) {
+    // Without lines the bounds are still at their sentinels
+    if (lines.empty()) {
+        return 0;
+    }
+    return count_danger_points(lines, bounds, false, fits_grid(bounds), band_threads(bounds));
+}
+
+/* Find points where at least 2 lines intersect */
+std::size_t find_danger_points_diag(const std::vector<Line> &lines, const Bounds &bounds) {
+    if (lines.empty()) {
+        return 0;
+    }
+    return count_danger_points(lines, bounds, true, fits_grid(bounds), band_threads(bounds));
 }
 
 void test() {
-    auto file_data = read_file("inputs/input5_test.txt");
-    std::vector<Line> test_data = file_data.first;
-    int *limits = file_data.second;
+    auto [test_data, bounds] = read_file("inputs/input5_test.txt");
+
+    assert(find_danger_points(test_data, bounds) == 5);
+    assert(find_danger_points_diag(test_data, bounds) == 12);
 
-    assert(find_danger_points(test_data, limits[3] - limits[1] + 1, limits[2] - limits[0] + 1) == 5); 
-    assert(find_danger_points_diag(test_data, limits[3] - limits[1] + 1, limits[2] - limits[0] + 1) == 12); 
-    
-    delete[] limits;
+    // Both ways of counting, across bands
+    for ([[maybe_unused]] bool dense : { false, true }) {
+        for ([[maybe_unused]] unsigned threads : { 1, 3, 10 }) {
+            assert(count_danger_points(test_data, bounds, false, dense, threads) == 5);
+            assert(count_danger_points(test_data, bounds, true, dense, threads) == 12);
+        }
+    }
+
+    // No lines at all
+    assert(find_danger_points({}, Bounds()) == 0);
+    assert(find_danger_points_diag({}, Bounds()) == 0);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_5", "inputs/input5.txt", read_file,
+        [](const Data &data) { return find_danger_points(data.first, data.second); },
+        [](const Data &data) { return find_danger_points_diag(data.first, data.second); });
+}
+#else
 int main() {
     test();
 
-    auto file_data = read_file("inputs/input5.txt");
-    std::vector<Line> data = file_data.first;
-    int *limits = file_data.second;
-    std::cout << find_danger_points(data, limits[3] - limits[1] + 1, limits[2] - limits[0] + 1) << std::endl; 
-    std::cout << find_danger_points_diag(data, limits[3] - limits[1] + 1, limits[2] - limits[0] + 1) << std::endl; 
-
-    delete[] limits;
+    auto [data, bounds] = read_file("inputs/input5.txt");
+    std::cout << find_danger_points(data, bounds) << std::endl;
+    std::cout << find_danger_points_diag(data, bounds) << std::endl;
 
     return 0;
 }
+#endif
@@ -1,32 +1,38 @@
 #include <iostream>
-#include <fstream>
 #include <sstream>
 #include <vector>
-#include <cassert>
 #include <algorithm>
 #include <iterator>
 #include <array>
 #include <numeric>
+#include <cstdint>
+#include <string>
+#include <string_view>
 
-/* Reads the initial states of starting fish */
-std::vector<int> read_file(const std::string &filename) {
-    std::vector<int> data;
+#include "benchmark.h"
+#include "tokenizer.h"
 
-    std::ifstream in;
-    in.open(filename);
+/* Example from the puzzle description */
+constexpr std::string_view EXAMPLE = "3,4,3,1,2\n";
+
+/* Parses the initial states of starting fish */
+constexpr std::vector<int> parse(Tokenizer &in) {
+    std::vector<int> data;
     int state;
-    char temp;
 
-    while (in >> state) {
+    while (in.next_int(state)) {
         data.push_back(state); 
-
-        // Read separating comma
-        in >> temp;
     }
     
     return data;
 }
 
+/* Reads the initial states of starting fish */
+std::vector<int> read_file(const std::string &filename) {
+    Tokenizer in(filename);
+    return parse(in);
+}
+
 /* Return a string of the current state */
 std::string _state_string(const std::vector<int> &fish) {
     std::stringstream s;
@@ -39,7 +45,7 @@ std::string _state_string(const std::vector<int> &fish) {
 }
 
 /* Simulate fish reproduction */
-std::vector<int>::size_type num_of_fish(std::vector<int> fish, int days) {
+constexpr std::vector<int>::size_type num_of_fish(std::vector<int> fish, int days) {
     for (int i = 0; i < days; ++i) {
         int newFish = 0;
 
@@ -61,7 +67,7 @@ std::vector<int>::size_type num_of_fish(std::vector<int> fish, int days) {
 }
 
 /* Transform list of states in an array of counters */
-std::array<unsigned long long, 9> transform_state(const std::vector<int> &fish) {
+constexpr std::array<unsigned long long, 9> transform_state(const std::vector<int> &fish) {
     std::array<unsigned long long, 9> states{};
     
     for (const int f : fish) {
@@ -71,42 +77,277 @@ std::array<unsigned long long, 9> transform_state(const std::vector<int> &fish)
     return states;
 }
 
-/* Calculate number of fish using array of counters */
-unsigned long long num_of_fish_better(const std::vector<int> &fish, int days) {
-    std::array<unsigned long long, 9> states = transform_state(fish);
+/* Unsigned integer of any size, as little endian digits in base 2^32
+ * without leading zeros */
+struct BigNumber {
+    std::vector<std::uint32_t> limbs;
 
-    for (int i = 0; i < days; ++i) {
-        std::array<unsigned long long, 9> newStates{};
+    constexpr BigNumber(unsigned long long value = 0) {
+        for (; value; value >>= 32) {
+            limbs.push_back(std::uint32_t(value));
+        }
+    }
+
+    constexpr BigNumber operator+(const BigNumber &other) const {
+        BigNumber sum;
+        sum.limbs.resize(std::max(limbs.size(), other.limbs.size()) + 1);
+        std::uint64_t carry = 0;
+        for (std::size_t i = 0; i < sum.limbs.size(); ++i) {
+            carry += (i < limbs.size() ? limbs[i] : 0ull) + (i < other.limbs.size() ? other.limbs[i] : 0ull);
+            sum.limbs[i] = std::uint32_t(carry);
+            carry >>= 32;
+        }
+
+        if (sum.limbs.back() == 0) {
+            sum.limbs.pop_back();
+        }
+        return sum;
+    }
 
-        // All states decrease for every fish
+    constexpr BigNumber operator*(const BigNumber &other) const {
+        BigNumber product;
+        if (limbs.empty() || other.limbs.empty()) {
+            return product;
+        }
+
+        product.limbs.assign(limbs.size() + other.limbs.size(), 0);
+        for (std::size_t i = 0; i < limbs.size(); ++i) {
+            std::uint64_t carry = 0;
+            for (std::size_t j = 0; j < other.limbs.size() || carry; ++j) {
+                carry += product.limbs[i + j] +
+                         std::uint64_t(limbs[i]) * (j < other.limbs.size() ? other.limbs[j] : 0);
+                product.limbs[i + j] = std::uint32_t(carry);
+                carry >>= 32;
+            }
+        }
+
+        while (product.limbs.back() == 0) {
+            product.limbs.pop_back();
+        }
+        return product;
+    }
+
+    constexpr bool operator==(const BigNumber &other) const = default;
+
+    /* Decimal digits, by repeated division by 10^9 */
+    std::string to_string() const {
+        std::vector<std::uint32_t> rest(limbs.rbegin(), limbs.rend());
+        std::vector<std::uint32_t> chunks;
+        while (!rest.empty()) {
+            std::uint64_t remainder = 0;
+            for (std::uint32_t &limb : rest) {
+                remainder = remainder << 32 | limb;
+                limb = std::uint32_t(remainder / 1000000000);
+                remainder %= 1000000000;
+            }
+            chunks.push_back(std::uint32_t(remainder));
+            rest.erase(rest.begin(), std::find_if(rest.begin(), rest.end(), [](std::uint32_t limb) { return limb != 0; }));
+        }
+
+        std::string digits = chunks.empty() ? "0" : std::to_string(chunks.back());
+        for (auto chunk = chunks.rbegin() + !chunks.empty(); chunk != chunks.rend(); ++chunk) {
+            std::string part = std::to_string(*chunk);
+            digits += std::string(9 - part.size(), '0') + part;
+        }
+        return digits;
+    }
+};
+
+std::ostream &operator<<(std::ostream &out, const BigNumber &number) {
+    return out << number.to_string();
+}
+
+/* Exact counts. These grow by a factor of about 1.09 a day, so this only
+ * works for up to around a million days. */
+struct Exact {
+    typedef BigNumber Number;
+
+    constexpr Number from(unsigned long long count) const { return count; }
+    constexpr Number add(const Number &a, const Number &b) const { return a + b; }
+    constexpr Number multiply(const Number &a, const Number &b) const { return a * b; }
+};
+
+/* Counts modulo a modulus, for any number of days */
+struct Modulo {
+    typedef std::uint64_t Number;
+
+    std::uint64_t modulus;
+
+    constexpr Number from(unsigned long long count) const { return count % modulus; }
+
+    constexpr Number add(Number a, Number b) const {
+        return a >= modulus - b ? a - (modulus - b) : a + b;
+    }
+
+    constexpr Number multiply(Number a, Number b) const {
+        return (unsigned __int128) a * b % modulus;
+    }
+};
+
+/* Counts of fish by state */
+typedef std::array<unsigned long long, 9> States;
+
+/* Initial fish by state and a number of days to count them after */
+struct Query {
+    States states;
+    unsigned long long days;
+};
+
+/* Counts fish after any number of days with powers of the 9x9 matrix T that
+ * moves the counts of fish by state one day ahead. The fish after d days are
+ * 1 T^d s for the initial counts s, and the row vector 1 T^d, the fish that
+ * descend from a single fish in each state, is built from the squares
+ * T^(2^k) for the bits of d in O(log d). The squares are cached, so they are
+ * shared by all counts of the same engine. */
+template <typename Arithmetic>
+class Lanternfish {
+public:
+    typedef typename Arithmetic::Number Number;
+
+    /* Vectors of 9 numbers, and 9x9 matrices in row-major order */
+    typedef std::vector<Number> Vector;
+    typedef std::vector<Number> Matrix;
+
+    constexpr explicit Lanternfish(Arithmetic arithmetic = {}) : arithmetic(arithmetic) {
+        Matrix day(81, arithmetic.from(0));
+
+        // All states decrease for every fish, and fish at state 0 are reset
+        // to 6 and create a new fish each
         for (int j = 0; j < 8; ++j) {
-            newStates[j] = states[j + 1];
+            day[j * 9 + j + 1] = arithmetic.from(1);
+        }
+        day[6 * 9] = arithmetic.from(1);
+        day[8 * 9] = arithmetic.from(1);
+
+        squares.push_back(day);
+    }
+
+    /* Fish that descend from a single fish in each state after days */
+    constexpr Vector descendants(unsigned long long days) {
+        Vector fish(9, arithmetic.from(1));
+
+        for (std::size_t k = 0; days >> k; ++k) {
+            if (k == squares.size()) {
+                squares.push_back(multiply(squares.back(), squares.back(), 9));
+            }
+            if (days >> k & 1) {
+                fish = multiply(fish, squares[k], 1);
+            }
+        }
+
+        return fish;
+    }
+
+    /* Number of fish after days */
+    constexpr Number count(const States &states, unsigned long long days) {
+        return dot(descendants(days), states);
+    }
+
+    /* Numbers of fish for a batch of queries. Queries for the same number of
+     * days share their descendants. */
+    constexpr std::vector<Number> count(const std::vector<Query> &queries) {
+        std::vector<std::size_t> order(queries.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&queries](std::size_t a, std::size_t b) {
+            return queries[a].days < queries[b].days;
+        });
+
+        std::vector<Number> counts(queries.size());
+        Vector fish;
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            const Query &query = queries[order[i]];
+            if (i == 0 || query.days != queries[order[i - 1]].days) {
+                fish = descendants(query.days);
+            }
+            counts[order[i]] = dot(fish, query.states);
         }
 
-        // Fish at state 0 are reset to 6 and ...
-        newStates[6] += states[0];
-        // ... we create one new fish for every one
-        newStates[8] += states[0];
+        return counts;
+    }
+
+private:
+    constexpr Number dot(const Vector &fish, const States &states) const {
+        Number total = arithmetic.from(0);
+        for (int s = 0; s < 9; ++s) {
+            total = arithmetic.add(total, arithmetic.multiply(fish[s], arithmetic.from(states[s])));
+        }
+        return total;
+    }
 
-        states = newStates;
+    /* Product of a matrix of rows by 9 numbers and a 9x9 matrix */
+    constexpr Matrix multiply(const Matrix &a, const Matrix &b, int rows) const {
+        Matrix product(rows * 9, arithmetic.from(0));
+        for (int i = 0; i < rows; ++i) {
+            for (int k = 0; k < 9; ++k) {
+                // Powers of the matrix of a day are mostly zeros
+                if (a[i * 9 + k] == arithmetic.from(0)) {
+                    continue;
+                }
+                for (int j = 0; j < 9; ++j) {
+                    if (b[k * 9 + j] == arithmetic.from(0)) {
+                        continue;
+                    }
+                    product[i * 9 + j] = arithmetic.add(product[i * 9 + j],
+                                                        arithmetic.multiply(a[i * 9 + k], b[k * 9 + j]));
+                }
+            }
+        }
+        return product;
     }
 
-    return std::accumulate(states.cbegin(), states.cend(), 0ull, std::plus<unsigned long long>());
+    Arithmetic arithmetic;
+    std::vector<Matrix> squares;
+};
+
+/* Calculate the exact number of fish with matrix powers */
+constexpr BigNumber num_of_fish_better(const std::vector<int> &fish, unsigned long long days) {
+    return Lanternfish<Exact>().count(transform_state(fish), days);
 }
 
-void test() {
-    std::vector<int> test_data = read_file("inputs/input6_test.txt");
-    assert(num_of_fish(test_data, 80) == 5934);
-    assert(num_of_fish_better(test_data, 256) == 26984457539);
+/* Calculate the number of fish modulo a modulus with matrix powers */
+constexpr std::uint64_t num_of_fish_modulo(const std::vector<int> &fish, unsigned long long days,
+                                           std::uint64_t modulus) {
+    return Lanternfish<Modulo>(Modulo{ modulus }).count(transform_state(fish), days);
 }
 
-int main() {
-    test(); 
+/* Test small cases at compile time */
+constexpr bool test() {
+    Tokenizer in(EXAMPLE);
+    std::vector<int> test_data = parse(in);
+    return num_of_fish(test_data, 80) == 5934 && num_of_fish_better(test_data, 256) == 26984457539;
+}
+
+static_assert(test());
+
+/* Test counts modulo a number at compile time, apart from the above to stay
+ * within the limit of constant evaluation */
+constexpr bool test_modulo() {
+    Tokenizer in(EXAMPLE);
+    std::vector<int> test_data = parse(in);
+    States states = transform_state(test_data);
+    std::vector<std::uint64_t> batch = Lanternfish<Modulo>(Modulo{ 1000000007 }).count({
+        { states, 256 }, { {}, 256 }, { { 1 }, 0 }, { states, 18 }, { states, 1000000000000 },
+    });
+
+    return num_of_fish_modulo(test_data, 256, -1) == 26984457539 &&
+           batch[0] == 26984457539 % 1000000007 && batch[1] == 0 && batch[2] == 1 && batch[3] == 26 &&
+           batch[4] == 995077479;
+}
+
+static_assert(test_modulo());
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_6", "inputs/input6.txt", read_file,
+        [](const std::vector<int> &data) { return num_of_fish(data, 80); },
+        [](const std::vector<int> &data) { return num_of_fish_better(data, 256); });
+}
+#else
+int main() {
     std::vector<int> data = read_file("inputs/input6.txt");
     std::cout << num_of_fish(data, 80) << std::endl;
     std::cout << num_of_fish_better(data, 256) << std::endl;
 
     return 0;
 }
-
+#endif
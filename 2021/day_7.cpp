@@ -1,116 +1,194 @@
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <algorithm>
 #include <numeric>
-#include <cassert>
+#include <string_view>
 
-std::vector<int> read_file(const std::string &filename) {
-    std::vector<int> input;
+#include "benchmark.h"
+#include "tokenizer.h"
+
+/* Example from the puzzle description */
+constexpr std::string_view EXAMPLE = "16,1,2,0,4,2,7,1,2,14\n";
 
-    std::ifstream in; 
-    in.open(filename);
+constexpr std::vector<int> parse(Tokenizer &in) {
+    std::vector<int> input;
     int num;
-    char temp;
 
-    while (in >> num) {
+    while (in.next_int(num)) {
         input.push_back(num);
-
-        in >> temp;
     }
 
     return input;
 }
 
-/* Calculate optimum horizontal positions to minimize moves */
-int align_crabs(std::vector<int> positions) {
-    std::sort(positions.begin(), positions.end());
-
-    int left = 0;
-    int right = std::accumulate(positions.cbegin(), positions.cend(), 0, std::plus<int>());
-    right -= (positions.size() - 1) * left;
-
-    int optimum = positions[0];
-    int fuel = left + right;
-    
-    decltype(positions.size()) i = 0;
-
-    for (int pos = 1; pos <= positions[positions.size() - 1]; ++pos) {
-        // Find number of crabs at pos-1 (how much crabs move to the other size)
-        int change = 0;
-        while (i < positions.size() && positions[i] == pos - 1) {
-            ++i;
-            ++change;
-        }
+std::vector<int> read_file(const std::string &filename) {
+    Tokenizer in(filename);
+    return parse(in);
+}
 
-        // Distance of crabs to the left increases
-        left += i + change;
-        // Distance of crabs to the right decreases
-        right -= positions.size() - i + change;
+/* Numbers of crabs at each position from the leftmost one, with the total
+ * number of crabs and the sums of their positions and squared positions.
+ * Squares of a million crabs ten million positions apart overflow long long,
+ * so they are summed in 128 bits. */
+struct Histogram {
+    int min;
+    std::vector<int> counts;
+    long long crabs = 0;
+    long long sum = 0;
+    __int128 squares = 0;
+};
+
+constexpr Histogram histogram(const std::vector<int> &positions) {
+    // A single position without crabs, which costs nothing to align on
+    if (positions.empty()) {
+        return Histogram{ 0, std::vector<int>(1) };
+    }
 
-        if (left + right < fuel) {
-            optimum = i;
-            fuel = left + right;
+    auto [min, max] = std::minmax_element(positions.cbegin(), positions.cend());
+    Histogram h{ *min, std::vector<int>(*max - *min + 1) };
+
+    for (const int pos : positions) {
+        long long i = pos - h.min;
+        ++h.counts[i];
+        ++h.crabs;
+        h.sum += i;
+        h.squares += (__int128) i * i;
+    }
+
+    return h;
+}
+
+/* Least fuel to align all crabs on one position, where fuel(distances,
+ * squares) is the fuel for the sums of the distances and squared distances
+ * of all crabs to that position. Both sums follow in O(1) from the positions
+ * up to the candidate, so all candidates take O(n + R) for R positions. */
+template <typename Fuel>
+constexpr long long sweep(const Histogram &h, Fuel fuel) {
+    long long left_crabs = 0, left_sum = 0;
+    __int128 best = -1;
+
+    for (long long p = 0; p < (long long) h.counts.size(); ++p) {
+        left_crabs += h.counts[p];
+        left_sum += h.counts[p] * p;
+
+        long long distances = p * left_crabs - left_sum + (h.sum - left_sum) - p * (h.crabs - left_crabs);
+        __int128 squares = (__int128) p * p * h.crabs - (__int128) 2 * p * h.sum + h.squares;
+        __int128 total = fuel(distances, squares);
+        if (best < 0 || total < best) {
+            best = total;
         }
     }
 
-    return fuel;
+    return best;
+}
+
+/* Calculate least fuel to align crabs if every step costs 1 */
+constexpr long long align_crabs(const std::vector<int> &positions) {
+    return sweep(histogram(positions), [](long long distances, __int128) { return distances; });
 }
 
-int align_crabs_linear(const std::vector<int> &positions) {
-    // Create a vector where value is number of crabs at position
-    int min_value = *std::min_element(positions.cbegin(), positions.cend());
-    int max_value = *std::max_element(positions.cbegin(), positions.cend());
-    std::vector<int> positions_vec(max_value - min_value + 1);
+/* Calculate least fuel to align crabs if every step costs 1 more than the last */
+constexpr long long align_crabs_linear(const std::vector<int> &positions) {
+    return sweep(histogram(positions), [](long long distances, __int128 squares) {
+        return (squares + distances) / 2;
+    });
+}
+
+/* Fuel to align all crabs on a position, in 128 bits as positions far from
+ * the best one can cost more than long long holds */
+template <typename Cost>
+constexpr __int128 fuel_at(const std::vector<int> &positions, long long target, Cost cost) {
+    __int128 total = 0;
     for (const int pos : positions) {
-        ++positions_vec[pos - min_value];
+        total += cost(pos > target ? pos - target : target - pos);
     }
+    return total;
+}
 
-    // Calculate initial price
-    int left = 0;
-    int right = 0; 
-    for (decltype(positions_vec.size()) i = 1; i < positions_vec.size(); ++i) {
-        right += positions_vec[i] * i * (i + 1) / 2;
+/* Same as align_crabs in O(n), as the median minimizes the sum of distances */
+constexpr long long align_crabs_median(std::vector<int> positions) {
+    if (positions.empty()) {
+        return 0;
     }
 
-    int optimum = 0;
-    int fuel = left + right;
+    auto median = positions.begin() + positions.size() / 2;
+    std::nth_element(positions.begin(), median, positions.end());
+    return fuel_at(positions, *median, [](long long d) { return d; });
+}
+
+/* Same as align_crabs_linear in O(n). The fuel is half the sum of squared
+ * distances plus half the sum of distances, so the optimum is within 1/2 of
+ * the mean, and one of the 4 positions around it. */
+constexpr long long align_crabs_mean(const std::vector<int> &positions) {
+    if (positions.empty()) {
+        return 0;
+    }
 
-    // Check every possible position
-    for (int current_pos = 1; current_pos < positions_vec.size(); ++current_pos) {
-        // Increase price to the left for every crab on that side
-        for (int j = 0; j < current_pos; ++j) {
-            left += positions_vec[j] * (current_pos - j);
-        }
+    auto triangle = [](long long d) { return d * (d + 1) / 2; };
+    auto [min, max] = std::minmax_element(positions.cbegin(), positions.cend());
+    long long mean = std::accumulate(positions.cbegin(), positions.cend(), 0ll) / (long long) positions.size();
 
-        // Decrease price to the right for every crab on that side
-        for (int j = current_pos; j < positions_vec.size(); ++j) {
-            right -= positions_vec[j] * (j - current_pos + 1);
+    __int128 best = -1;
+    for (long long p = std::max<long long>(mean - 1, *min); p <= std::min<long long>(mean + 2, *max); ++p) {
+        __int128 total = fuel_at(positions, p, triangle);
+        if (best < 0 || total < best) {
+            best = total;
         }
+    }
+    return best;
+}
+
+/* Least fuel to align crabs where moving a distance d costs cost(d), for any
+ * convex cost. The total is then convex in the position too, so a binary
+ * search for where it stops decreasing takes O(n log R). */
+template <typename Cost>
+constexpr long long align_crabs_convex(const std::vector<int> &positions, Cost cost) {
+    if (positions.empty()) {
+        return 0;
+    }
+
+    auto [min, max] = std::minmax_element(positions.cbegin(), positions.cend());
+    long long low = *min, high = *max;
 
-        // Check if current price is better
-        if (left + right < fuel) {
-            optimum = current_pos;
-            fuel = left + right;
+    while (low < high) {
+        long long middle = low + (high - low) / 2;
+        if (fuel_at(positions, middle, cost) <= fuel_at(positions, middle + 1, cost)) {
+            high = middle;
+        } else {
+            low = middle + 1;
         }
     }
 
-    return fuel;
+    return fuel_at(positions, low, cost);
 }
 
-void test() {
-    std::vector<int> test_data = read_file("inputs/input7_test.txt");
-
-    assert(align_crabs(test_data) == 37);
-    assert(align_crabs_linear(test_data) == 168);
+/* Test small cases at compile time */
+constexpr bool test() {
+    Tokenizer in(EXAMPLE);
+    std::vector<int> test_data = parse(in);
+    auto step = [](long long d) { return d; };
+    auto triangle = [](long long d) { return d * (d + 1) / 2; };
+
+    return align_crabs(test_data) == 37 && align_crabs_linear(test_data) == 168 &&
+           align_crabs_median(test_data) == 37 && align_crabs_mean(test_data) == 168 &&
+           align_crabs_convex(test_data, step) == 37 && align_crabs_convex(test_data, triangle) == 168 &&
+           align_crabs({}) == 0 && align_crabs_linear({}) == 0 && align_crabs_median({}) == 0 &&
+           align_crabs_mean({}) == 0 && align_crabs_convex({}, step) == 0;
 }
 
-int main() {
-    test(); 
+static_assert(test());
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_7", "inputs/input7.txt", read_file,
+        align_crabs, align_crabs_linear);
+}
+#else
+int main() {
     std::vector<int> data = read_file("inputs/input7.txt");
     std::cout << align_crabs(data) << std::endl;
     std::cout << align_crabs_linear(data) << std::endl;
 
     return 0;
 }
+#endif
@@ -1,161 +1,172 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <array>
-#include <utility>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <thread>
 #include <vector>
 #include <algorithm>
 #include <cassert>
 
-typedef std::pair<std::array<std::string, 10>, std::array<std::string, 4>> Entry;
+#include "benchmark.h"
+#include "tokenizer.h"
+#include "cache.h"
 
-const int NUM_OF_SEGMENTS[] = { 6, 2, 5, 5, 4, 5, 6, 3, 7, 6 };
-const std::vector<int> DIGITS_OF_SEGMENTS[] = {
-    {},
-    {},
-    { 1 },
-    { 7 },
-    { 4 },
-    { 2, 3, 5 },
-    { 0, 6, 9 },
-    { 8 },
+/* Patterns of wires as bitmasks, bit 0 for wire a up to bit 6 for wire g */
+struct Entry {
+    std::array<std::uint8_t, 10> patterns;
+    std::array<std::uint8_t, 4> outputs;
 };
 
-std::vector<Entry> read_file(const std::string &filename) {
+const int NUM_OF_SEGMENTS[] = { 6, 2, 5, 5, 4, 5, 6, 3, 7, 6 };
+
+/* Fewest entries worth a thread of their own */
+constexpr std::size_t MIN_CHUNK_ENTRIES = 1 << 16;
+
+constexpr std::uint8_t to_mask(std::string_view word) {
+    std::uint8_t mask = 0;
+    for (const char c : word) {
+        mask |= 1 << (c - 'a');
+    }
+    return mask;
+}
+
+std::vector<Entry> parse_file(const std::string &filename) {
     std::vector<Entry> data;
 
-    std::ifstream in;
-    in.open(filename);
+    Tokenizer in(filename);
+
+    std::string_view token;
+    while (in.next_token(token)) {
+        Entry entry;
 
-    std::string word;
-    while (in >> word) {
         // Read combinations before |
-        std::array<std::string, 10> nums;
         for (int i = 0; i < 10; ++i) {
-            std::sort(word.begin(), word.end());
-            nums[i] = word;
-            in >> word;
+            entry.patterns[i] = to_mask(token);
+            in.next_token(token);
         }
 
         // Read combinations after |
-        std::array<std::string, 4> result;
         for (int i = 0; i < 4; ++i) {
-            in >> word;
-            std::sort(word.begin(), word.end());
-            result[i] = word;
+            in.next_token(token);
+            entry.outputs[i] = to_mask(token);
         }
 
-        data.push_back(std::make_pair(nums, result));
+        data.push_back(entry);
     }
 
     return data;
 }
 
-/* Count how many times do 1, 4, 7 and 8 appear in the result */
-int num_of_appearances(const std::vector<Entry> &data) {
-    int count = 0;
-
-    for (const Entry e : data) {
-        for (const std::string num : e.second) {
-            // Check if number is 1, 4, 7 or 8
-            if (num.size() == NUM_OF_SEGMENTS[1] || num.size() == NUM_OF_SEGMENTS[4] ||
-                    num.size() == NUM_OF_SEGMENTS[7] || num.size() == NUM_OF_SEGMENTS[8]) {
-                ++count;
-            }
-        }
-    }
+void save_entries(cache::Writer &out, const std::vector<Entry> &data) {
+    out.write(std::span<const Entry>(data));
+}
 
-    return count;
+std::vector<Entry> load_entries(cache::Reader &in) {
+    auto entries = in.read_span<Entry>();
+    return std::vector<Entry>(entries.begin(), entries.end());
 }
 
-/* Calculate intersection of two display representations */
-std::string string_intersection(const std::string &a, const std::string &b) {
-    std::stringstream result;
+std::vector<Entry> read_file(const std::string &filename) {
+    return cache::cached(filename, "day_8", 2, parse_file, save_entries, load_entries);
+}
 
-    for (const char ca : a) {
-        for (const char cb : b) {
-            if (ca == cb) {
-                result << ca;
+/* Sum of f over all entries, split in chunks on their own thread each */
+template <typename F>
+long long parallel_sum(const std::vector<Entry> &data, F f) {
+    std::size_t threads = std::clamp<std::size_t>(data.size() / MIN_CHUNK_ENTRIES, 1,
+                                                  std::max(std::thread::hardware_concurrency(), 1u));
+
+    std::vector<long long> sums(threads);
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i]() {
+            std::span<const Entry> chunk(data.begin() + data.size() * i / threads,
+                                         data.begin() + data.size() * (i + 1) / threads);
+            for (const Entry &e : chunk) {
+                sums[i] += f(e);
             }
-        }
+        });
     }
 
-    return result.str();
+    long long sum = 0;
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers[i].join();
+        sum += sums[i];
+    }
+    return sum;
 }
 
-/* Determine wiring and return sum of results */
-int outputs_sum(const std::vector<Entry> &data) {
-    int sum = 0;
-
-    for (const Entry e : data) {
-        // Determine candidates for every digit
-        std::array<std::vector<std::string>, 10> candidates;
-
-        // This is a candidate for digits with the same number of display parts turned on
-        for (const std::string combination : e.first) {
-            for (int digit : DIGITS_OF_SEGMENTS[combination.size()]) {
-                candidates[digit].push_back(combination);
-            }
+/* Count how many times do 1, 4, 7 and 8 appear in the result */
+long long num_of_appearances(const std::vector<Entry> &data) {
+    return parallel_sum(data, [](const Entry &e) {
+        int count = 0;
+        for (const std::uint8_t num : e.outputs) {
+            // Check if number is 1, 4, 7 or 8
+            int size = std::popcount(num);
+            count += size == NUM_OF_SEGMENTS[1] || size == NUM_OF_SEGMENTS[4] ||
+                     size == NUM_OF_SEGMENTS[7] || size == NUM_OF_SEGMENTS[8];
         }
+        return count;
+    });
+}
 
-        // 3 needs to have segments of 1
-        std::erase_if(candidates[3], [candidates](std::string c) {
-            std::string one = candidates[1][0];
-            return one.size() != string_intersection(one, c).size();
-        });
-
-        // 9 needs to have segments of 3
-        std::erase_if(candidates[9], [candidates](std::string c) {
-            std::string three = candidates[3][0];
-            return three.size() != string_intersection(three, c).size();
-        });
-
-        // 5 is contained in 9 and is not 3
-        std::erase_if(candidates[5], [candidates](std::string c) {
-            std::string nine = candidates[9][0];
-            return c == candidates[3][0] || string_intersection(nine, c).size() != 5;
-        });
-
-        // 2 is not 3 or 5
-        std::erase_if(candidates[2], [candidates](std::string c) {
-            return c == candidates[3][0] || c == candidates[5][0];
-        });
-
-        // 0 contains 1 and is not 9
-        std::erase_if(candidates[0], [candidates](std::string c) {
-            std::string one = candidates[1][0];
-            return c == candidates[9][0] || one.size() != string_intersection(one, c).size();
-        });
+/* Digit of a pattern, given the patterns of 1 and 4. Each digit has its own
+ * number of segments and of segments shared with 1 and 4. */
+constexpr int decode_digit(std::uint8_t pattern, std::uint8_t one, std::uint8_t four) {
+    switch (std::popcount(pattern)) {
+    case 2: return 1;
+    case 3: return 7;
+    case 4: return 4;
+    case 7: return 8;
+    case 5:
+        if ((pattern & one) == one) return 3;
+        return std::popcount<std::uint8_t>(pattern & four) == 3 ? 5 : 2;
+    default:
+        if ((pattern & four) == four) return 9;
+        return (pattern & one) == one ? 0 : 6;
+    }
+}
 
-        // 6 is not 0 or 9
-        std::erase_if(candidates[6], [candidates](std::string c) {
-            return c == candidates[0][0] || c == candidates[9][0];
-        });
+/* Determine wiring and return the displayed number */
+constexpr int decode(const Entry &e) {
+    std::uint8_t one = 0, four = 0;
+    for (const std::uint8_t pattern : e.patterns) {
+        if (std::popcount(pattern) == NUM_OF_SEGMENTS[1]) one = pattern;
+        if (std::popcount(pattern) == NUM_OF_SEGMENTS[4]) four = pattern;
+    }
 
-        // Increase sum by current result
-        int temp = 0;
-        for (const std::string num : e.second) {
-            for (int i = 0; i <= 9; ++i) {
-                if (candidates[i][0] == num) {
-                    temp = 10 * temp + i;
-                }
-            }
-        }
+    std::array<std::uint8_t, 128> digits{};
+    for (const std::uint8_t pattern : e.patterns) {
+        digits[pattern] = decode_digit(pattern, one, four);
+    }
 
-        sum += temp;
+    int number = 0;
+    for (const std::uint8_t num : e.outputs) {
+        number = 10 * number + digits[num];
     }
+    return number;
+}
 
-    return sum;
+/* Determine wiring and return sum of results */
+long long outputs_sum(const std::vector<Entry> &data) {
+    return parallel_sum(data, decode);
 }
 
 void test() {
     std::vector<Entry> test_data = read_file("inputs/input8_test.txt");
 
     assert(num_of_appearances(test_data) == 26);
-    assert(string_intersection("bcdf", "acfg") == "cf");
+    assert((to_mask("bcdf") & to_mask("acfg")) == to_mask("cf"));
     assert(outputs_sum(test_data) == 61229);
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_8", "inputs/input8.txt", read_file,
+        num_of_appearances, outputs_sum);
+}
+#else
 int main() {
     test();
 
@@ -165,3 +176,4 @@ int main() {
 
     return 0;
 }
+#endif
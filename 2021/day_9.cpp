@@ -1,149 +1,213 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cassert>
 #include <vector>
-#include <stack>
-#include <utility>
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <thread>
+
+#include "benchmark.h"
+#include "tokenizer.h"
+#include "grid.h"
 
 const int NEIGHBORS[4][2] = {
     { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1}
 };
 
-std::vector<std::vector<int>> read_file(const std::string filename) {
-    std::vector<std::vector<int>> result;
-    
-    std::ifstream in;
-    in.open(filename);
+typedef Grid<int> HeightMap;
 
-    std::string line;
-    while (std::getline(in, line)) {
-        char c;
-        std::istringstream ss(line);
-        std::vector<int> nums_line;
+/* Height of the padding, which is never a low point or part of a basin */
+const int BORDER = 9;
 
-        while (ss >> c) {
-            nums_line.push_back(c - '0');
-        }
-        result.push_back(nums_line);
+/* Fewest rows worth a thread of their own */
+const int MIN_STRIP_ROWS = 128;
+
+HeightMap read_file(const std::string filename) {
+    Tokenizer in(filename);
+
+    std::vector<std::string_view> lines;
+    std::string_view line;
+    while (in.next_line(line)) {
+        lines.push_back(line);
     } 
 
-    return result;
+    return make_grid(lines, 1, BORDER, [](char c) { return c - '0'; });
+}
+
+/* Return whether cell at index i is lower than all its neighbors */
+bool is_low_point(const HeightMap &data, int i) {
+    for (int k = 0; k < 4; ++k) {
+        if (data[i + data.offset(NEIGHBORS[k][0], NEIGHBORS[k][1])] <= data[i]) {
+            return false;
+        }
+    }
+    return true;
 }
 
 /* Find low points and sum their risk levels */
-int risk_levels_sum(const std::vector<std::vector<int>> &data) {
+int risk_levels_sum(const HeightMap &data) {
     int sum = 0;
 
-    // For every cell ...
-    for (decltype(data.size()) i = 0; i < data.size(); ++i) {
-        for (decltype(data[i].size()) j = 0; j < data[i].size(); ++j) {
-            bool lowest = true;
-            // ... check every neighbor 
-            for (int k = 0; k < 4 && lowest; ++k) {
-                decltype(i) new_i = i + NEIGHBORS[k][0];
-                decltype(j) new_j = j + NEIGHBORS[k][1];
-
-                if (new_i >= 0 && new_i < data.size() && new_j >= 0 && new_j < data[new_i].size()) {
-                    lowest = data[new_i][new_j] > data[i][j];  
-                }
-            }
-
-            sum += lowest * (data[i][j] + 1);
+    // For every cell check every neighbor
+    for (int y = 0; y < data.rows; ++y) {
+        for (int x = 0; x < data.cols; ++x) {
+            int i = data.index(y, x);
+            sum += is_low_point(data, i) * (data[i] + 1);
         }
     }
 
     return sum;
 }
 
-/* Find size of the basin centered at row i and column j */
-int basin_size(std::vector<std::vector<int>> data, int i, int j) {
-    std::stack<std::pair<int, int>> points;
-    points.push(std::make_pair(i, j));
-    data[i][j] = -1;
-
-    int size = 0;
-
-    // Take one point from stack and add their higer neighbors
-    while (!points.empty()) {
-        auto point = points.top();
-        ++size;
-        points.pop();
-
-        for (int k = 0; k < 4; ++k) {
-            decltype(i) new_i = point.first + NEIGHBORS[k][0];
-            decltype(j) new_j = point.second + NEIGHBORS[k][1];
-
-            // Check if neighbor is higher but not 9 
-            if (new_i >= 0 && new_i < data.size() &&
-                    new_j >= 0 && new_j < data[new_i].size() &&
-                    data[new_i][new_j] > data[point.first][point.second] &&
-                    data[new_i][new_j] != 9) {
-                points.push(std::make_pair(new_i, new_j));
-                data[new_i][new_j] = -1;
-            }
+/* Sizes of all basins and the sum of the risk levels of their low points */
+struct Basins {
+    std::vector<int> sizes;
+    int risk_sum = 0;
+};
+
+/* Union-find over the cells of a grid, where the root of each set holds its
+ * size */
+struct Components {
+    std::vector<int> parent;
+    std::vector<int> size;
+
+    explicit Components(std::size_t cells) : parent(cells), size(cells, 1) {
+        std::iota(parent.begin(), parent.end(), 0);
+    }
+
+    int find(int i) {
+        while (parent[i] != i) {
+            i = parent[i] = parent[parent[i]];
         }
+        return i;
     }
 
-    return size;
-}
+    void unite(int a, int b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return;
+        }
+        if (size[a] < size[b]) {
+            std::swap(a, b);
+        }
+        parent[b] = a;
+        size[a] += size[b];
+    }
+};
 
-/* Find three largest basins and return their size */
-int largest_basins(const std::vector<std::vector<int>> &data) {
-    int first = 0;
-    int second = 0;
-    int third = 0;
-
-    // For every cell ...
-    for (decltype(data.size()) i = 0; i < data.size(); ++i) {
-        for (decltype(data[i].size()) j = 0; j < data[i].size(); ++j) {
-            bool lowest = true;
-            // ... check every neighbor 
-            for (int k = 0; k < 4 && lowest; ++k) {
-                decltype(i) new_i = i + NEIGHBORS[k][0];
-                decltype(j) new_j = j + NEIGHBORS[k][1];
-
-                if (new_i >= 0 && new_i < data.size() && new_j >= 0 && new_j < data[new_i].size()) {
-                    lowest = data[new_i][new_j] > data[i][j];  
+/* Label all basins at once. Basins are the areas of cells other than 9, so
+ * every cell joins the basins of its left and upper neighbors. Strips of rows
+ * are labeled on their own thread each, as unions within a strip only touch
+ * its own cells, and the rows where strips meet are joined afterwards. */
+Basins find_basins(const HeightMap &data, unsigned threads) {
+    threads = std::clamp(threads, 1u, std::max(static_cast<unsigned>(data.rows), 1u));
+
+    Components components(data.cells.size());
+    std::vector<int> risks(threads);
+    std::vector<std::thread> workers;
+    auto strip = [&data, threads](unsigned i) { return static_cast<int>(data.rows * i / threads); };
+
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i]() {
+            for (int y = strip(i); y < strip(i + 1); ++y) {
+                for (int x = 0; x < data.cols; ++x) {
+                    int cell = data.index(y, x);
+                    if (data[cell] == BORDER) {
+                        continue;
+                    }
+
+                    risks[i] += is_low_point(data, cell) * (data[cell] + 1);
+
+                    // The padding left of the first column is 9 as well
+                    if (data[cell - 1] != BORDER) {
+                        components.unite(cell, cell - 1);
+                    }
+                    if (y > strip(i) && data[cell - data.stride] != BORDER) {
+                        components.unite(cell, cell - data.stride);
+                    }
                 }
             }
+        });
+    }
 
-            // If we found a low points, calculate basin size
-            if (lowest) {
-                int size = basin_size(data, i, j);
-
-                // Check if this basin is current top 3
-                if (size > first) {
-                    third = second;
-                    second = first;
-                    first = size;
-                } else if (size > second) {
-                    third = second;
-                    second = size;
-                } else if (size > third) {
-                    third = size;
-                }
+    Basins basins;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers[i].join();
+        basins.risk_sum += risks[i];
+    }
+
+    // Join basins across the first row of every strip
+    for (unsigned i = 1; i < threads; ++i) {
+        for (int x = 0; x < data.cols; ++x) {
+            int cell = data.index(strip(i), x);
+            if (data[cell] != BORDER && data[cell - data.stride] != BORDER) {
+                components.unite(cell, cell - data.stride);
             }
         }
     }
 
-    return first * second * third;
+    for (int y = 0; y < data.rows; ++y) {
+        for (int x = 0; x < data.cols; ++x) {
+            int cell = data.index(y, x);
+            if (data[cell] != BORDER && components.parent[cell] == cell) {
+                basins.sizes.push_back(components.size[cell]);
+            }
+        }
+    }
+
+    return basins;
+}
+
+Basins find_basins(const HeightMap &data) {
+    unsigned threads = std::clamp(data.rows / MIN_STRIP_ROWS, 1,
+                                  std::max(static_cast<int>(std::thread::hardware_concurrency()), 1));
+    return find_basins(data, threads);
+}
+
+/* Product of the k largest sizes, selected without sorting all of them */
+long long largest_product(std::vector<int> sizes, std::size_t k) {
+    if (sizes.size() < k) {
+        return 0;
+    }
+
+    std::nth_element(sizes.begin(), sizes.begin() + k - 1, sizes.end(), std::greater<int>());
+    return std::accumulate(sizes.begin(), sizes.begin() + k, 1ll, std::multiplies<long long>());
+}
+
+/* Find three largest basins and return the product of their sizes */
+long long largest_basins(const HeightMap &data) {
+    return largest_product(find_basins(data).sizes, 3);
 }
 
 void test() {
-    std::vector<std::vector<int>> test_data = read_file("inputs/input9_test.txt");
+    HeightMap test_data = read_file("inputs/input9_test.txt");
     
     assert(risk_levels_sum(test_data) == 15);
-    assert(basin_size(test_data, 4, 6) == 9);
     assert(largest_basins(test_data) == 1134);
+
+    // Basins of 3, 9, 14 and 9 cells, however the rows are split
+    for (unsigned threads = 1; threads <= 5; ++threads) {
+        Basins basins = find_basins(test_data, threads);
+        std::sort(basins.sizes.begin(), basins.sizes.end());
+        assert(basins.sizes == std::vector<int>({ 3, 9, 9, 14 }));
+        assert(basins.risk_sum == 15);
+    }
 }
 
+#ifdef BENCHMARK
+int main(int argc, char *argv[]) {
+    return benchmark::run(argc, argv, "day_9", "inputs/input9.txt", read_file,
+        risk_levels_sum, largest_basins);
+}
+#else
 int main() {
     test();
     
-    std::vector<std::vector<int>> data = read_file("inputs/input9.txt");
+    HeightMap data = read_file("inputs/input9.txt");
     std::cout << risk_levels_sum(data) << std::endl;
     std::cout << largest_basins(data) << std::endl;
     
     return 0;
 }
+#endif
@@ -0,0 +1,719 @@
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+/* Generator of synthetic inputs for stress benchmarks.
+ *
+ *     ./generate <day> [scale] [seed] > inputs/input15_large.txt
+ *     ./build/day_15_bench inputs/input15_large.txt
+ *
+ * Every day has its own generator, which writes a valid input at the given
+ * scale to the standard output. The meaning of the scale depends on the day
+ * (number of lines, side of a grid, ...) and its default is roughly the size
+ * of the puzzle input. Days with inputs of a fixed size ignore it, but it
+ * has to be at least 1 like for all others. The same seed always gives the
+ * same input.
+ *
+ *     ./generate 5 30000 1 1000000 > inputs/input5_sparse.txt
+ *
+ * Days whose input lies on a plane take its extent as an optional fourth
+ * argument, to stretch the same number of things over a larger area.
+ */
+
+typedef std::mt19937_64 Random;
+
+/* Coordinates are from [0, extent) on days that support it */
+long extent = 1000;
+
+/* Return a uniformly distributed number from [lo, hi] */
+long uniform(Random &rng, long lo, long hi) {
+    return std::uniform_int_distribution<long>(lo, hi)(rng);
+}
+
+bool coin(Random &rng, double probability = 0.5) {
+    return std::bernoulli_distribution(probability)(rng);
+}
+
+/* Square grid of characters picked at random from the given ones */
+void random_grid(std::ostream &out, long side, Random &rng, const std::string &chars) {
+    std::string line(side, ' ');
+    for (long y = 0; y < side; ++y) {
+        for (char &c : line) {
+            c = chars[uniform(rng, 0, chars.size() - 1)];
+        }
+        out << line << '\n';
+    }
+}
+
+/* Sonar depths, a random walk that mostly goes deeper */
+void generate_1(std::ostream &out, long scale, Random &rng) {
+    long depth = 100;
+    for (long i = 0; i < scale; ++i) {
+        depth = std::max(0L, depth + uniform(rng, -5, 15));
+        out << depth << '\n';
+    }
+}
+
+/* The submarine never goes above the surface */
+void generate_2(std::ostream &out, long scale, Random &rng) {
+    const char *commands[] = { "forward", "down", "up" };
+    long depth = 0;
+    for (long i = 0; i < scale; ++i) {
+        long command = uniform(rng, 0, 2), amount = uniform(rng, 1, 9);
+        if (command == 2 && amount > depth) {
+            command = 1;
+        }
+        depth += command == 1 ? amount : command == 2 ? -amount : 0;
+        out << commands[command] << ' ' << amount << '\n';
+    }
+}
+
+void generate_3(std::ostream &out, long scale, Random &rng) {
+    std::string line(12, '0');
+    for (long i = 0; i < scale; ++i) {
+        for (char &c : line) {
+            c = '0' + coin(rng);
+        }
+        out << line << '\n';
+    }
+}
+
+/* Scale is the number of boards. All numbers of the boards are drawn, so
+ * every board wins at some point. */
+void generate_4(std::ostream &out, long scale, Random &rng) {
+    long numbers = std::max(100L, scale);
+    std::vector<long> draws(numbers);
+    for (long i = 0; i < numbers; ++i) {
+        draws[i] = i;
+    }
+    std::shuffle(draws.begin(), draws.end(), rng);
+
+    for (long i = 0; i < numbers; ++i) {
+        out << (i ? "," : "") << draws[i];
+    }
+    out << '\n';
+
+    for (long board = 0; board < scale; ++board) {
+        std::set<long> used;
+        out << '\n';
+        for (int row = 0; row < 5; ++row) {
+            for (int col = 0; col < 5; ++col) {
+                long number;
+                do {
+                    number = uniform(rng, 0, numbers - 1);
+                } while (!used.insert(number).second);
+                out << (col ? " " : "") << (number < 10 ? " " : "") << number;
+            }
+            out << '\n';
+        }
+    }
+}
+
+/* Horizontal, vertical and diagonal lines on an extent by extent diagram,
+ * 1000x1000 by default. Lines are at most 1000 long whatever the extent, so
+ * a larger one spreads them out and few of them cross. */
+void generate_5(std::ostream &out, long scale, Random &rng) {
+    long longest = std::min(extent, 1000L) - 1;
+    for (long i = 0; i < scale; ++i) {
+        long x1, y1, x2, y2;
+        do {
+            x1 = x2 = uniform(rng, 0, extent - 1);
+            y1 = y2 = uniform(rng, 0, extent - 1);
+
+            long length = uniform(rng, -longest, longest);
+            switch (uniform(rng, 0, 2)) {
+            case 0:
+                x2 = x1 + length;
+                break;
+            case 1:
+                y2 = y1 + length;
+                break;
+            default:
+                x2 = x1 + length;
+                y2 = y1 + (coin(rng) ? length : -length);
+            }
+        } while ((x1 == x2 && y1 == y2) || x2 < 0 || x2 >= extent || y2 < 0 || y2 >= extent);
+
+        out << x1 << ',' << y1 << " -> " << x2 << ',' << y2 << '\n';
+    }
+}
+
+void generate_6(std::ostream &out, long scale, Random &rng) {
+    for (long i = 0; i < scale; ++i) {
+        out << (i ? "," : "") << uniform(rng, 1, 5);
+    }
+    out << '\n';
+}
+
+void generate_7(std::ostream &out, long scale, Random &rng) {
+    for (long i = 0; i < scale; ++i) {
+        out << (i ? "," : "") << uniform(rng, 0, 1999);
+    }
+    out << '\n';
+}
+
+/* Ten scrambled digit patterns and four output digits per display */
+void generate_8(std::ostream &out, long scale, Random &rng) {
+    const char *digits[10] = {
+        "abcefg", "cf", "acdeg", "acdfg", "bcdf",
+        "abdfg", "abdefg", "acf", "abcdefg", "abcdfg"
+    };
+
+    auto scrambled = [&](const std::string &wiring, int digit) {
+        std::string pattern;
+        for (const char *c = digits[digit]; *c; ++c) {
+            pattern += wiring[*c - 'a'];
+        }
+        std::shuffle(pattern.begin(), pattern.end(), rng);
+        return pattern;
+    };
+
+    for (long i = 0; i < scale; ++i) {
+        std::string wiring = "abcdefg";
+        std::shuffle(wiring.begin(), wiring.end(), rng);
+
+        std::array<int, 10> order = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+        std::shuffle(order.begin(), order.end(), rng);
+        for (int digit : order) {
+            out << scrambled(wiring, digit) << ' ';
+        }
+
+        out << '|';
+        for (int j = 0; j < 4; ++j) {
+            out << ' ' << scrambled(wiring, uniform(rng, 0, 9));
+        }
+        out << '\n';
+    }
+}
+
+/* Basins grow from random low points and are separated by walls of 9s, so
+ * that they stay small like in the puzzle */
+void generate_9(std::ostream &out, long scale, Random &rng) {
+    const int NEIGHBORS[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1} };
+    long cells = scale * scale;
+    std::vector<long> basin(cells, -1), height(cells);
+    std::vector<long> queue;
+
+    for (long i = 0; i < cells / 60 + 1; ++i) {
+        long cell = uniform(rng, 0, cells - 1);
+        if (basin[cell] < 0) {
+            basin[cell] = cell;
+            height[cell] = 0;
+            queue.push_back(cell);
+        }
+    }
+
+    // Heights are the distances from the low points of the basins
+    for (std::size_t i = 0; i < queue.size(); ++i) {
+        long y = queue[i] / scale, x = queue[i] % scale;
+        for (auto [dy, dx] : NEIGHBORS) {
+            long new_y = y + dy, new_x = x + dx;
+            long next = new_y * scale + new_x;
+            if (new_y >= 0 && new_y < scale && new_x >= 0 && new_x < scale && basin[next] < 0) {
+                basin[next] = basin[queue[i]];
+                height[next] = std::min(8L, height[queue[i]] + 1);
+                queue.push_back(next);
+            }
+        }
+    }
+
+    std::string line(scale, ' ');
+    for (long y = 0; y < scale; ++y) {
+        for (long x = 0; x < scale; ++x) {
+            long cell = y * scale + x;
+            bool wall = (x + 1 < scale && basin[cell + 1] != basin[cell]) ||
+                        (y + 1 < scale && basin[cell + scale] != basin[cell]);
+            line[x] = wall && height[cell] ? '9' : '0' + height[cell];
+        }
+        out << line << '\n';
+    }
+}
+
+/* Lines of chunks, half of them corrupted and the rest incomplete */
+void generate_10(std::ostream &out, long scale, Random &rng) {
+    const std::string open = "([{<", close = ")]}>";
+
+    for (long i = 0; i < scale; ++i) {
+        std::string line, stack;
+        long length = uniform(rng, 90, 110);
+        long corrupt_at = coin(rng) ? uniform(rng, length / 2, length - 1) : length;
+        bool corrupted = false;
+
+        for (long j = 0; j < length; ++j) {
+            if (j >= corrupt_at && !stack.empty()) {
+                // Close with any bracket but the expected one
+                std::size_t expected = open.find(stack.back());
+                line += close[(expected + uniform(rng, 1, 3)) % 4];
+                corrupted = true;
+                break;
+            }
+
+            if (stack.empty() || coin(rng, 0.55)) {
+                stack += open[uniform(rng, 0, 3)];
+                line += stack.back();
+            } else {
+                line += close[open.find(stack.back())];
+                stack.pop_back();
+            }
+        }
+
+        // Incomplete lines must leave some chunk open
+        if (stack.empty() && !corrupted) {
+            line += open[uniform(rng, 0, 3)];
+        }
+        out << line << '\n';
+    }
+}
+
+/* Return the first step in which all octopuses flash, or 0 if they do not
+ * synchronize in the given number of steps */
+long octopuses_sync(std::vector<int> energy, long side, long steps) {
+    for (long step = 1; step <= steps; ++step) {
+        std::vector<long> flashing;
+        for (long i = 0; i < (long) energy.size(); ++i) {
+            if (++energy[i] == 10) {
+                flashing.push_back(i);
+            }
+        }
+
+        for (std::size_t i = 0; i < flashing.size(); ++i) {
+            long y = flashing[i] / side, x = flashing[i] % side;
+            for (long new_y = std::max(0L, y - 1); new_y <= std::min(side - 1, y + 1); ++new_y) {
+                for (long new_x = std::max(0L, x - 1); new_x <= std::min(side - 1, x + 1); ++new_x) {
+                    if (++energy[new_y * side + new_x] == 10) {
+                        flashing.push_back(new_y * side + new_x);
+                    }
+                }
+            }
+        }
+
+        if (flashing.size() == energy.size()) {
+            return step;
+        }
+        for (int &e : energy) {
+            e = e >= 10 ? 0 : e;
+        }
+    }
+
+    return 0;
+}
+
+/* Random grids are drawn until one synchronizes, because part 2 runs until
+ * it does. Big grids rarely do, so after a while the last one is used. */
+void generate_11(std::ostream &out, long scale, Random &rng) {
+    std::vector<int> energy(scale * scale);
+    for (int attempt = 0; attempt < 1000; ++attempt) {
+        for (int &e : energy) {
+            e = uniform(rng, 0, 9);
+        }
+        if (octopuses_sync(energy, scale, 10000)) {
+            break;
+        }
+    }
+
+    for (long i = 0; i < scale * scale; ++i) {
+        out << char('0' + energy[i]) << ((i + 1) % scale ? "" : "\n");
+    }
+}
+
+/* Scale is the number of small caves. Big caves are never connected to each
+ * other, so the number of paths stays finite, but it grows exponentially. */
+void generate_12(std::ostream &out, long scale, Random &rng) {
+    scale = std::min(scale, 600L);
+    std::vector<std::string> small, big;
+    std::set<std::string> used;
+
+    auto name = [&](char first) {
+        std::string name;
+        do {
+            name = { char(first + uniform(rng, 0, 25)), char(first + uniform(rng, 0, 25)) };
+        } while (!used.insert(name).second);
+        return name;
+    };
+
+    for (long i = 0; i < scale; ++i) {
+        small.push_back(name('a'));
+    }
+    for (long i = 0; i < scale / 3 + 1; ++i) {
+        big.push_back(name('A'));
+    }
+
+    // Every cave has a few edges to small caves, start and end
+    std::vector<std::string> caves = small;
+    caves.insert(caves.end(), big.begin(), big.end());
+    std::set<std::pair<std::string, std::string>> edges;
+    for (const std::string &cave : caves) {
+        long degree = uniform(rng, 1, 2);
+        for (long i = 0; i < degree; ++i) {
+            const std::string &other = small[uniform(rng, 0, small.size() - 1)];
+            if (other != cave) {
+                edges.insert(std::minmax(cave, other));
+            }
+        }
+    }
+    for (const char *end : { "start", "end" }) {
+        for (int i = 0; i < 2; ++i) {
+            edges.insert({ end, caves[uniform(rng, 0, caves.size() - 1)] });
+        }
+    }
+
+    for (const auto &[a, b] : edges) {
+        out << a << '-' << b << '\n';
+    }
+}
+
+/* Scale is the number of dots. They are placed on the final 40x6 code and
+ * randomly mirrored over each fold, so no dot ever lies on a fold line. */
+void generate_13(std::ostream &out, long scale, Random &rng) {
+    std::vector<std::pair<char, long>> folds;
+    long width = 40, height = 6;
+    const char *axes = "yyyxyxyxyxyx";
+    for (const char *axis = axes; *axis; ++axis) {
+        long &size = *axis == 'x' ? width : height;
+        folds.push_back({ *axis, size });
+        size = 2 * size + 1;
+    }
+    std::reverse(folds.begin(), folds.end());
+
+    std::unordered_set<long> dots;
+    for (long attempt = 0; (long) dots.size() < scale && attempt < 100 * scale; ++attempt) {
+        long x = uniform(rng, 0, 39), y = uniform(rng, 0, 5);
+        for (auto it = folds.rbegin(); it != folds.rend(); ++it) {
+            long &coordinate = it->first == 'x' ? x : y;
+            coordinate = coin(rng) ? coordinate : 2 * it->second - coordinate;
+        }
+
+        if (dots.insert(y * width + x).second) {
+            out << x << ',' << y << '\n';
+        }
+    }
+
+    out << '\n';
+    for (auto [axis, line] : folds) {
+        out << "fold along " << axis << '=' << line << '\n';
+    }
+}
+
+/* Scale is the length of the template. There are rules for all pairs. */
+void generate_14(std::ostream &out, long scale, Random &rng) {
+    const std::string elements = "BCFHKNOPSV";
+    for (long i = 0; i < scale; ++i) {
+        out << elements[uniform(rng, 0, elements.size() - 1)];
+    }
+    out << "\n\n";
+
+    for (char a : elements) {
+        for (char b : elements) {
+            out << a << b << " -> " << elements[uniform(rng, 0, elements.size() - 1)] << '\n';
+        }
+    }
+}
+
+void generate_15(std::ostream &out, long scale, Random &rng) {
+    random_grid(out, scale, rng, "123456789");
+}
+
+/* Append value to bits as a big endian number of the given width */
+void append_bits(std::string &bits, long value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        bits += '0' + (value >> i & 1);
+    }
+}
+
+/* Return bits of a random packet with the given number of packets in it */
+std::string packet_bits(long packets, Random &rng) {
+    std::string bits;
+    append_bits(bits, uniform(rng, 0, 7), 3);
+
+    if (packets == 1) {
+        append_bits(bits, 4, 3);
+        long value = uniform(rng, 0, 255);
+        append_bits(bits, 16 | (value >> 4), 5);
+        append_bits(bits, value & 15, 5);
+        return bits;
+    }
+
+    // Comparisons have exactly two sub-packets, the other operators any number
+    const int types[] = { 0, 1, 2, 3, 5, 6, 7 };
+    int type = packets > 2 ? types[uniform(rng, 0, 6)] : types[uniform(rng, 0, 3)];
+    long count = type >= 5 ? 2 : std::min(packets - 1, uniform(rng, 1, 8));
+
+    std::string children;
+    long left = packets - 1;
+    for (long i = 0; i < count; ++i) {
+        long size = i == count - 1 ? left : uniform(rng, 1, left - (count - i - 1));
+        children += packet_bits(size, rng);
+        left -= size;
+    }
+
+    append_bits(bits, type, 3);
+    if (children.size() < (1u << 15) && coin(rng)) {
+        bits += '0';
+        append_bits(bits, children.size(), 15);
+    } else {
+        bits += '1';
+        append_bits(bits, count, 11);
+    }
+
+    return bits + children;
+}
+
+/* Scale is the number of packets in the transmission */
+void generate_16(std::ostream &out, long scale, Random &rng) {
+    std::string bits = packet_bits(std::max(1L, scale), rng);
+    bits.resize((bits.size() + 3) / 4 * 4, '0');
+
+    for (std::size_t i = 0; i < bits.size(); i += 4) {
+        out << "0123456789ABCDEF"[std::stoi(bits.substr(i, 4), nullptr, 2)];
+    }
+    out << '\n';
+}
+
+/* Scale bounds the coordinates of the target area */
+void generate_17(std::ostream &out, long scale, Random &rng) {
+    long x1 = uniform(rng, 20, 20 + scale);
+    long x2 = x1 + uniform(rng, 10, 10 + scale / 4);
+    long y2 = -uniform(rng, 5, 5 + scale / 3);
+    long y1 = y2 - uniform(rng, 5, 5 + scale / 4);
+    out << "target area: x=" << x1 << ".." << x2 << ", y=" << y1 << ".." << y2 << '\n';
+}
+
+/* Return a reduced snailfish number nested in depth pairs */
+std::string snailfish_number(int depth, Random &rng) {
+    if (depth == 4 || (depth > 0 && coin(rng, 0.3))) {
+        return std::to_string(uniform(rng, 0, 9));
+    }
+    return '[' + snailfish_number(depth + 1, rng) + ',' + snailfish_number(depth + 1, rng) + ']';
+}
+
+void generate_18(std::ostream &out, long scale, Random &rng) {
+    for (long i = 0; i < scale; ++i) {
+        out << snailfish_number(0, rng) << '\n';
+    }
+}
+
+typedef std::array<long, 3> Point;
+
+/* Scale is the number of scanners. Every scanner is placed so that it
+ * overlaps one of the previous scanners, and 12 new beacons are placed in
+ * the overlap. Each scanner reports all beacons in range in its own
+ * randomly rotated coordinates. */
+void generate_19(std::ostream &out, long scale, Random &rng) {
+    const long RANGE = 1000;
+
+    // All 24 rotations are the signed permutations with determinant 1
+    std::vector<std::array<int, 6>> rotations;
+    std::array<int, 3> axes = { 0, 1, 2 };
+    do {
+        int inversions = (axes[0] > axes[1]) + (axes[0] > axes[2]) + (axes[1] > axes[2]);
+        for (int signs = 0; signs < 8; ++signs) {
+            std::array<int, 3> s = { signs & 1 ? -1 : 1, signs & 2 ? -1 : 1, signs & 4 ? -1 : 1 };
+            if ((inversions % 2 ? -1 : 1) * s[0] * s[1] * s[2] == 1) {
+                rotations.push_back({ axes[0], axes[1], axes[2], s[0], s[1], s[2] });
+            }
+        }
+    } while (std::next_permutation(axes.begin(), axes.end()));
+
+    std::vector<Point> scanners = { { 0, 0, 0 } };
+    std::set<Point> beacons;
+
+    auto add_beacons = [&](const Point &lo, const Point &hi, int count) {
+        for (int i = 0; i < count; ++i) {
+            beacons.insert({ uniform(rng, lo[0], hi[0]), uniform(rng, lo[1], hi[1]),
+                             uniform(rng, lo[2], hi[2]) });
+        }
+    };
+
+    add_beacons({ -RANGE, -RANGE, -RANGE }, { RANGE, RANGE, RANGE }, 25);
+    for (long i = 1; i < scale; ++i) {
+        // Keep scanners apart, so that each of them overlaps only a few others
+        Point parent, scanner, lo, hi;
+        bool crowded = true;
+        for (int attempt = 0; crowded && attempt < 100; ++attempt) {
+            parent = scanners[uniform(rng, 0, scanners.size() - 1)];
+            for (int k = 0; k < 3; ++k) {
+                scanner[k] = parent[k] + uniform(rng, -RANGE * 6 / 5, RANGE * 6 / 5);
+            }
+
+            crowded = false;
+            for (const Point &other : scanners) {
+                long distance = 0;
+                for (int k = 0; k < 3; ++k) {
+                    distance = std::max(distance, std::abs(scanner[k] - other[k]));
+                }
+                crowded |= distance < RANGE;
+            }
+        }
+
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = std::max(parent[k], scanner[k]) - RANGE;
+            hi[k] = std::min(parent[k], scanner[k]) + RANGE;
+        }
+        scanners.push_back(scanner);
+
+        add_beacons(lo, hi, 12);
+        add_beacons({ scanner[0] - RANGE, scanner[1] - RANGE, scanner[2] - RANGE },
+                    { scanner[0] + RANGE, scanner[1] + RANGE, scanner[2] + RANGE }, 13);
+    }
+
+    for (std::size_t i = 0; i < scanners.size(); ++i) {
+        const auto &r = i ? rotations[uniform(rng, 0, rotations.size() - 1)] : rotations[0];
+
+        out << (i ? "\n" : "") << "--- scanner " << i << " ---\n";
+        for (const Point &beacon : beacons) {
+            Point relative;
+            bool visible = true;
+            for (int k = 0; k < 3; ++k) {
+                relative[k] = beacon[k] - scanners[i][k];
+                visible &= std::abs(relative[k]) <= RANGE;
+            }
+
+            if (visible) {
+                out << r[3] * relative[r[0]] << ',' << r[4] * relative[r[1]] << ','
+                    << r[5] * relative[r[2]] << '\n';
+            }
+        }
+    }
+}
+
+/* The algorithm lights all dark pixels and darkens all lit pixels, so the
+ * infinite background blinks but the number of lit pixels stays finite */
+void generate_20(std::ostream &out, long scale, Random &rng) {
+    std::string algo(512, '.');
+    for (char &c : algo) {
+        c = coin(rng) ? '#' : '.';
+    }
+    algo.front() = '#';
+    algo.back() = '.';
+
+    out << algo << "\n\n";
+    random_grid(out, scale, rng, "#.");
+}
+
+void generate_21(std::ostream &out, long, Random &rng) {
+    out << "Player 1 starting position: " << uniform(rng, 1, 10) << '\n';
+    out << "Player 2 starting position: " << uniform(rng, 1, 10) << '\n';
+}
+
+/* Scale is the number of steps. The first 20 steps are in the initialization
+ * area, the rest are big cuboids far out of it. */
+void generate_22(std::ostream &out, long scale, Random &rng) {
+    for (long i = 0; i < scale; ++i) {
+        bool initialization = i < 20;
+        long limit = initialization ? 50 : 100000;
+        long size = initialization ? 50 : 40000;
+
+        out << (i < 10 || coin(rng, 0.6) ? "on" : "off");
+        for (const char *axis : { " x=", ",y=", ",z=" }) {
+            long from = uniform(rng, -limit, limit - size / 4);
+            long to = std::min(limit, from + uniform(rng, size / 4, size));
+            out << axis << from << ".." << to;
+        }
+        out << '\n';
+    }
+}
+
+void generate_23(std::ostream &out, long, Random &rng) {
+    std::string amphipods = "AABBCCDD";
+    std::shuffle(amphipods.begin(), amphipods.end(), rng);
+
+    out << "#############\n#...........#\n";
+    for (int row = 0; row < 2; ++row) {
+        out << (row ? "  #" : "###");
+        for (int room = 0; room < 4; ++room) {
+            out << amphipods[row * 4 + room] << '#';
+        }
+        out << (row ? "\n" : "##\n");
+    }
+    out << "  #########\n";
+}
+
+/* MONAD with seven pushing and seven popping blocks, paired like brackets.
+ * Digits of a pair differ by at most 8, so some model number is valid. */
+void generate_24(std::ostream &out, long, Random &rng) {
+    std::array<long, 14> a, b, c;
+
+    // Random balanced sequence of pushes and pops
+    std::vector<int> stack;
+    int pushes = 0;
+    for (int i = 0; i < 14; ++i) {
+        bool push = stack.empty() || (pushes < 7 && coin(rng));
+        c[i] = uniform(rng, 1, 16);
+        if (push) {
+            a[i] = 1;
+            b[i] = uniform(rng, 10, 16);
+            stack.push_back(i);
+            ++pushes;
+        } else {
+            a[i] = 26;
+            b[i] = uniform(rng, -8, 8) - c[stack.back()];
+            stack.pop_back();
+        }
+    }
+
+    for (int i = 0; i < 14; ++i) {
+        out << "inp w\nmul x 0\nadd x z\nmod x 26\n"
+            << "div z " << a[i] << '\n'
+            << "add x " << b[i] << '\n'
+            << "eql x w\neql x 0\nmul y 0\nadd y 25\nmul y x\nadd y 1\nmul z y\n"
+            << "mul y 0\nadd y w\n"
+            << "add y " << c[i] << '\n'
+            << "mul y x\nadd z y\n";
+    }
+}
+
+/* Part 1 runs until the herds stop moving, which takes longer the bigger
+ * the grid is */
+void generate_25(std::ostream &out, long scale, Random &rng) {
+    random_grid(out, scale, rng, ">v.");
+}
+
+struct Generator {
+    void (*generate)(std::ostream &, long, Random &);
+    long scale;
+};
+
+const Generator GENERATORS[25] = {
+    { generate_1, 2000 }, { generate_2, 1000 }, { generate_3, 1000 },
+    { generate_4, 100 }, { generate_5, 500 }, { generate_6, 300 },
+    { generate_7, 1000 }, { generate_8, 200 }, { generate_9, 100 },
+    { generate_10, 100 }, { generate_11, 10 }, { generate_12, 10 },
+    { generate_13, 900 }, { generate_14, 20 }, { generate_15, 100 },
+    { generate_16, 300 }, { generate_17, 150 }, { generate_18, 100 },
+    { generate_19, 30 }, { generate_20, 100 }, { generate_21, 1 },
+    { generate_22, 420 }, { generate_23, 1 }, { generate_24, 1 },
+    { generate_25, 140 },
+};
+
+int usage(const char *program) {
+    std::cerr << "Usage: " << program << " <day> [scale] [seed] [extent]\n";
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    int day = argc > 1 ? std::atoi(argv[1]) : 0;
+    if (day < 1 || day > 25) {
+        return usage(argv[0]);
+    }
+
+    const Generator &generator = GENERATORS[day - 1];
+    long scale = argc > 2 ? std::atol(argv[2]) : generator.scale;
+    Random rng(argc > 3 ? std::atol(argv[3]) : day);
+    extent = argc > 4 ? std::atol(argv[4]) : extent;
+    if (scale < 1 || extent < 2) {
+        return usage(argv[0]);
+    }
+
+    std::ios::sync_with_stdio(false);
+    generator.generate(std::cout, scale, rng);
+
+    return 0;
+}
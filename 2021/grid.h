@@ -0,0 +1,101 @@
+#pragma once
+
+/* Two dimensional grid shared by the grid days.
+ *
+ * All cells live in a single row-major buffer. A grid can be surrounded by
+ * a border of padding cells set to a sentinel value, so that neighbors of
+ * every inner cell can be read without bounds checks. Cells are addressed
+ * by row and column of the inner grid, or by their index in the buffer,
+ * which makes neighbors a constant offset away. Copying a grid copies one
+ * buffer and swapping it copies nothing.
+ */
+
+#include <algorithm>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+template <typename T>
+struct Grid {
+    int rows = 0;
+    int cols = 0;
+    int padding = 0;
+    int stride = 0;
+    std::vector<T> cells;
+
+    Grid() = default;
+
+    /* Inner cells are set to value and padding cells to border */
+    Grid(int rows, int cols, int padding = 0, T value = T(), T border = T())
+        : rows(rows), cols(cols), padding(padding), stride(cols + 2 * padding),
+          cells(static_cast<std::size_t>(stride) * (rows + 2 * padding), border) {
+        if (value != border) {
+            for (int y = 0; y < rows; ++y) {
+                auto inner = row(y);
+                std::fill(inner.begin(), inner.end(), value);
+            }
+        }
+    }
+
+    int index(int y, int x) const {
+        return (y + padding) * stride + x + padding;
+    }
+
+    /* Distance between the indices of a cell and its neighbor */
+    int offset(int dy, int dx) const {
+        return dy * stride + dx;
+    }
+
+    T &operator()(int y, int x) {
+        return cells[index(y, x)];
+    }
+
+    const T &operator()(int y, int x) const {
+        return cells[index(y, x)];
+    }
+
+    T &operator[](int i) {
+        return cells[i];
+    }
+
+    const T &operator[](int i) const {
+        return cells[i];
+    }
+
+    /* Inner cells of row y */
+    std::span<T> row(int y) {
+        return std::span<T>(cells).subspan(index(y, 0), cols);
+    }
+
+    std::span<const T> row(int y) const {
+        return std::span<const T>(cells).subspan(index(y, 0), cols);
+    }
+
+    void swap(Grid &other) noexcept {
+        std::swap(rows, other.rows);
+        std::swap(cols, other.cols);
+        std::swap(padding, other.padding);
+        std::swap(stride, other.stride);
+        cells.swap(other.cells);
+    }
+
+    bool operator==(const Grid &) const = default;
+};
+
+/* Build a grid from lines of text, converting each character to a cell */
+template <typename T, typename Convert>
+Grid<T> make_grid(const std::vector<std::string_view> &lines, int padding,
+                  T border, Convert convert) {
+    int cols = lines.empty() ? 0 : lines[0].size();
+    Grid<T> grid(lines.size(), cols, padding, border, border);
+
+    for (int y = 0; y < grid.rows; ++y) {
+        auto row = grid.row(y);
+        for (int x = 0; x < cols; ++x) {
+            row[x] = convert(lines[y][x]);
+        }
+    }
+
+    return grid;
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+/* Instrumentation of hot paths, compiled in with -DINSTRUMENT (the
+ * INSTRUMENT option in CMake). Without it the macros below expand to nothing.
+ *
+ * INSTRUMENT_REGION(name) times the rest of the enclosing scope, and
+ * INSTRUMENT_COUNT(name, n) adds n to a named event counter. On Linux every
+ * region also counts cycles, instructions, last level cache misses and branch
+ * misses of its thread with perf_event_open, as far as the kernel allows (see
+ * perf_event_paranoid). All regions and events are reported to stderr at
+ * exit. Totals include nested regions.
+ */
+
+#ifdef INSTRUMENT
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace instrument {
+
+enum Counter { CYCLES, INSTRUCTIONS, LLC_MISSES, BRANCH_MISSES, COUNTERS };
+
+/* Regions and events are constant initialized statics that are never
+ * destroyed, so they can still be read when the report runs at exit. */
+struct Region {
+    const char *name;
+    std::atomic<bool> registered{false};
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> nanoseconds{0};
+    /* Calls that could read the hardware counters, and their totals */
+    std::atomic<std::uint64_t> counted_calls{0};
+    std::atomic<std::uint64_t> counters[COUNTERS]{};
+
+    constexpr explicit Region(const char *name) : name(name) { }
+};
+
+struct Event {
+    const char *name;
+    std::atomic<bool> registered{false};
+    std::atomic<std::uint64_t> count{0};
+
+    constexpr explicit Event(const char *name) : name(name) { }
+};
+
+struct Registry {
+    std::mutex lock;
+    std::vector<const Region *> regions;
+    std::vector<const Event *> events;
+
+    ~Registry() {
+        report();
+    }
+
+    void report() const {
+        if (!regions.empty()) {
+            std::fprintf(stderr, "%-24s %10s %12s %14s %14s %6s %12s %12s\n",
+                         "region", "calls", "total ms", "cycles", "instructions",
+                         "IPC", "LLC misses", "br misses");
+        }
+
+        for (auto region : regions) {
+            std::fprintf(stderr, "%-24s %10llu %12.3f", region->name,
+                         (unsigned long long) region->calls.load(),
+                         region->nanoseconds.load() / 1e6);
+
+            if (!region->counted_calls.load()) {
+                std::fprintf(stderr, " %14s %14s %6s %12s %12s\n",
+                             "-", "-", "-", "-", "-");
+                continue;
+            }
+
+            std::uint64_t c[COUNTERS];
+            for (int i = 0; i < COUNTERS; ++i) {
+                c[i] = region->counters[i].load();
+            }
+            double ipc = c[CYCLES] ? (double) c[INSTRUCTIONS] / c[CYCLES] : 0;
+            std::fprintf(stderr, " %14llu %14llu %6.2f %12llu %12llu\n",
+                         (unsigned long long) c[CYCLES],
+                         (unsigned long long) c[INSTRUCTIONS], ipc,
+                         (unsigned long long) c[LLC_MISSES],
+                         (unsigned long long) c[BRANCH_MISSES]);
+        }
+
+        for (auto event : events) {
+            std::fprintf(stderr, "%-24s %10llu\n", event->name,
+                         (unsigned long long) event->count.load());
+        }
+    }
+};
+
+inline Registry &registry() {
+    static Registry registry;
+    return registry;
+}
+
+/* Hardware counters of the current thread, opened as one group on first use.
+ * Counters the hardware does not have are left out of the group. */
+struct Counters {
+    int group = -1;
+    int fds[COUNTERS];
+    int slots[COUNTERS];
+
+    Counters() {
+#ifdef __linux__
+        static const std::uint64_t configs[COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+
+        int slot = 0;
+        for (int i = 0; i < COUNTERS; ++i) {
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.disabled = group == -1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+
+            fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+            slots[i] = fds[i] < 0 ? -1 : slot++;
+            if (fds[i] >= 0 && group == -1) {
+                group = fds[i];
+            }
+        }
+
+        if (group >= 0) {
+            ioctl(group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    ~Counters() {
+#ifdef __linux__
+        for (int i = COUNTERS - 1; i >= 0; --i) {
+            if (fds[i] >= 0) {
+                close(fds[i]);
+            }
+        }
+#endif
+    }
+
+    Counters(const Counters &) = delete;
+    Counters &operator=(const Counters &) = delete;
+
+    /* Return false if this thread has no counters */
+    bool read(std::uint64_t values[COUNTERS]) const {
+#ifdef __linux__
+        if (group < 0) {
+            return false;
+        }
+
+        // The group is read as the number of counters followed by their values
+        std::uint64_t group_values[1 + COUNTERS];
+        if (::read(group, group_values, sizeof(group_values)) <= 0) {
+            return false;
+        }
+
+        for (int i = 0; i < COUNTERS; ++i) {
+            values[i] = slots[i] < 0 ? 0 : group_values[1 + slots[i]];
+        }
+        return true;
+#else
+        (void) values;
+        return false;
+#endif
+    }
+};
+
+inline const Counters &thread_counters() {
+    thread_local Counters counters;
+    return counters;
+}
+
+/* Registration only writes the flag once, later calls on the hot path just
+ * read it */
+inline void register_region(Region &region) {
+    if (!region.registered.load(std::memory_order_relaxed) &&
+        !region.registered.exchange(true)) {
+        Registry &r = registry();
+        std::lock_guard guard(r.lock);
+        r.regions.push_back(&region);
+    }
+}
+
+inline void register_event(Event &event) {
+    if (!event.registered.load(std::memory_order_relaxed) &&
+        !event.registered.exchange(true)) {
+        Registry &r = registry();
+        std::lock_guard guard(r.lock);
+        r.events.push_back(&event);
+    }
+}
+
+/* Time the lifetime of the scope and add it to the region */
+struct Scope {
+    Region &region;
+    bool counted;
+    std::uint64_t counters[COUNTERS];
+    std::chrono::steady_clock::time_point start;
+
+    explicit Scope(Region &region) : region(region) {
+        register_region(region);
+        counted = thread_counters().read(counters);
+        start = std::chrono::steady_clock::now();
+    }
+
+    ~Scope() {
+        auto end = std::chrono::steady_clock::now();
+        std::uint64_t end_counters[COUNTERS];
+        bool end_counted = counted && thread_counters().read(end_counters);
+
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+        region.calls.fetch_add(1, std::memory_order_relaxed);
+        region.nanoseconds.fetch_add(ns.count(), std::memory_order_relaxed);
+        if (!end_counted) {
+            return;
+        }
+
+        region.counted_calls.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < COUNTERS; ++i) {
+            region.counters[i].fetch_add(end_counters[i] - counters[i],
+                                         std::memory_order_relaxed);
+        }
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+};
+
+inline void add(Event &event, std::uint64_t n) {
+    register_event(event);
+    event.count.fetch_add(n, std::memory_order_relaxed);
+}
+
+}
+
+#define INSTRUMENT_CONCAT_(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_(a, b)
+#define INSTRUMENT_UNIQUE(prefix) INSTRUMENT_CONCAT(prefix, __LINE__)
+
+#define INSTRUMENT_REGION(name) \
+    static constinit instrument::Region INSTRUMENT_UNIQUE(instrument_region_)(name); \
+    instrument::Scope INSTRUMENT_UNIQUE(instrument_scope_)(INSTRUMENT_UNIQUE(instrument_region_))
+
+#define INSTRUMENT_COUNT(name, n) \
+    do { \
+        static constinit instrument::Event instrument_event(name); \
+        instrument::add(instrument_event, n); \
+    } while (0)
+
+#else
+
+#define INSTRUMENT_REGION(name)
+#define INSTRUMENT_COUNT(name, n) ((void) 0)
+
+#endif
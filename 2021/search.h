@@ -0,0 +1,296 @@
+#pragma once
+
+/* Shortest paths over implicit graphs, shared by the search days.
+ *
+ * A day describes its graph with a struct like
+ *
+ *     struct Graph {
+ *         using State = ...;                    // integral encoding of a state
+ *         static constexpr search::Cost MAX_STEP = 9;
+ *
+ *         template <typename Emit>
+ *         void neighbors(State state, Emit emit);   // emit(next, edge_cost)
+ *         bool is_goal(State state);
+ *
+ *         search::Cost estimate(State state);   // optional, turns on A*
+ *         std::size_t size();                   // optional, see below
+ *         static constexpr bool PREDECESSORS = true;   // optional
+ *     };
+ *
+ * and search::shortest_path runs Dijkstra on it, or A* if it has an estimate
+ * of the remaining cost. The estimate must be consistent, i.e. never drop by
+ * more than the cost of an edge, so that keys leave the queue in order.
+ *
+ * MAX_STEP bounds how much the key of a state can grow along one edge, which
+ * is the largest edge cost plus the largest growth of the estimate. A small
+ * bound selects a bucket queue (Dial's algorithm), otherwise a radix heap is
+ * used. A graph with MAX_STEP = 0 declares that keys are not monotone, e.g.
+ * because its estimate is not consistent, and gets a binary heap.
+ *
+ * States of a graph with size() are dense indices below it and their
+ * distances are kept in a vector, other states are hashed. A graph with
+ * PREDECESSORS records for each reached state all its predecessors on
+ * shortest paths, which together form the DAG of all shortest paths.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace search {
+
+typedef std::uint64_t Cost;
+
+constexpr Cost UNREACHED = std::numeric_limits<Cost>::max();
+
+/* Largest MAX_STEP served by a bucket queue */
+constexpr Cost BUCKET_LIMIT = 1 << 12;
+
+template <typename State>
+struct Entry {
+    Cost key;
+    Cost cost;
+    State state;
+};
+
+/* Dial's bucket queue. Keys in the queue are never more than the number of
+ * buckets apart, so a circular array of buckets holds them in order. Only
+ * the bucket of the last popped key matters, so current is the key modulo
+ * the number of buckets. */
+template <typename State>
+struct BucketQueue {
+    std::vector<std::vector<Entry<State>>> buckets;
+    Cost mask;
+    Cost current = 0;
+    std::size_t size = 0;
+
+    explicit BucketQueue(Cost max_step)
+        : buckets(std::bit_ceil(max_step + 1)), mask(buckets.size() - 1) { }
+
+    bool empty() const {
+        return size == 0;
+    }
+
+    void push(const Entry<State> &entry) {
+        ++size;
+        buckets[entry.key & mask].push_back(entry);
+    }
+
+    Entry<State> pop() {
+        while (buckets[current & mask].empty()) {
+            ++current;
+        }
+        auto &bucket = buckets[current & mask];
+        Entry<State> entry = bucket.back();
+        bucket.pop_back();
+        --size;
+        return entry;
+    }
+};
+
+/* Radix heap for monotone keys. Bucket i holds keys that first differ from
+ * the last popped key in bit i - 1, so each entry moves down at most once per
+ * bit of the keys. */
+template <typename State>
+struct RadixHeap {
+    std::vector<Entry<State>> buckets[65];
+    Cost last = 0;
+    std::size_t size = 0;
+
+    explicit RadixHeap(Cost) { }
+
+    static int bucket(Cost key, Cost last) {
+        return key == last ? 0 : 64 - std::countl_zero(key ^ last);
+    }
+
+    bool empty() const {
+        return size == 0;
+    }
+
+    void push(const Entry<State> &entry) {
+        ++size;
+        buckets[bucket(entry.key, last)].push_back(entry);
+    }
+
+    Entry<State> pop() {
+        if (buckets[0].empty()) {
+            int i = 1;
+            while (buckets[i].empty()) ++i;
+
+            // Redistribute the bucket with the smallest keys around its minimum
+            last = buckets[i][0].key;
+            for (const auto &entry : buckets[i]) {
+                last = std::min(last, entry.key);
+            }
+            for (const auto &entry : buckets[i]) {
+                buckets[bucket(entry.key, last)].push_back(entry);
+            }
+            buckets[i].clear();
+        }
+
+        Entry<State> entry = buckets[0].back();
+        buckets[0].pop_back();
+        --size;
+        return entry;
+    }
+};
+
+template <typename State>
+struct BinaryHeap {
+    static bool later(const Entry<State> &a, const Entry<State> &b) {
+        return a.key > b.key;
+    }
+
+    std::priority_queue<Entry<State>, std::vector<Entry<State>>, decltype(&later)> heap{ &later };
+
+    explicit BinaryHeap(Cost) { }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    void push(const Entry<State> &entry) {
+        heap.push(entry);
+    }
+
+    Entry<State> pop() {
+        Entry<State> entry = heap.top();
+        heap.pop();
+        return entry;
+    }
+};
+
+template <typename Graph>
+concept Dense = requires(Graph &graph) { graph.size(); };
+
+template <typename Graph>
+concept Informed = requires(Graph &graph, typename Graph::State state) { graph.estimate(state); };
+
+template <typename Graph>
+concept Recording = requires { Graph::PREDECESSORS; } && Graph::PREDECESSORS;
+
+template <typename Graph>
+using Queue = std::conditional_t<Graph::MAX_STEP != 0 && Graph::MAX_STEP <= BUCKET_LIMIT,
+    BucketQueue<typename Graph::State>,
+    std::conditional_t<Graph::MAX_STEP != 0,
+        RadixHeap<typename Graph::State>,
+        BinaryHeap<typename Graph::State>>>;
+
+/* Distances of dense states */
+template <typename State>
+struct DenseLabels {
+    std::vector<Cost> distances;
+
+    explicit DenseLabels(std::size_t size) : distances(size, UNREACHED) { }
+
+    Cost get(State state) const {
+        return distances[state];
+    }
+
+    void set(State state, Cost cost) {
+        distances[state] = cost;
+    }
+};
+
+/* Distances of hashed states */
+template <typename State>
+struct SparseLabels {
+    std::unordered_map<State, Cost> distances;
+
+    Cost get(State state) const {
+        auto it = distances.find(state);
+        return it == distances.end() ? UNREACHED : it->second;
+    }
+
+    void set(State state, Cost cost) {
+        distances[state] = cost;
+    }
+};
+
+template <typename State>
+struct Result {
+    bool found = false;
+    Cost cost = UNREACHED;
+    /* Goal states reached at the lowest cost, all of them if predecessors
+     * are recorded, otherwise the first one */
+    std::vector<State> goals;
+    /* Predecessors of every reached state on its shortest paths, if recorded */
+    std::unordered_map<State, std::vector<State>> predecessors;
+};
+
+/* Find the cheapest path from start to a goal state */
+template <typename Graph>
+Result<typename Graph::State> shortest_path(Graph &graph, typename Graph::State start) {
+    using State = typename Graph::State;
+
+    auto labels = [&graph] {
+        if constexpr (Dense<Graph>) {
+            return DenseLabels<State>(graph.size());
+        } else {
+            return SparseLabels<State>();
+        }
+    }();
+
+    auto estimate = [&graph](State state) -> Cost {
+        if constexpr (Informed<Graph>) {
+            return graph.estimate(state);
+        } else {
+            return 0;
+        }
+    };
+
+    Result<State> result;
+    Queue<Graph> queue(Graph::MAX_STEP);
+    labels.set(start, 0);
+    queue.push({ estimate(start), 0, start });
+
+    while (!queue.empty()) {
+        Entry<State> entry = queue.pop();
+
+        // Skip states that were reached more cheaply since they were queued
+        if (entry.cost != labels.get(entry.state)) {
+            continue;
+        }
+
+        // With recorded predecessors, other shortest paths to a goal may
+        // still be queued, so the search only stops after the goal's cost
+        if (result.found && entry.key > result.cost) {
+            break;
+        }
+
+        if (graph.is_goal(entry.state)) {
+            result.found = true;
+            result.cost = entry.cost;
+            result.goals.push_back(entry.state);
+            if constexpr (!Recording<Graph>) break;
+            continue;
+        }
+
+        graph.neighbors(entry.state, [&](State next, Cost edge) {
+            Cost cost = entry.cost + edge;
+            Cost known = labels.get(next);
+
+            if constexpr (Recording<Graph>) {
+                if (cost == known) {
+                    result.predecessors[next].push_back(entry.state);
+                } else if (cost < known) {
+                    result.predecessors[next].assign(1, entry.state);
+                }
+            }
+
+            if (cost < known) {
+                labels.set(next, cost);
+                queue.push({ cost + estimate(next), cost, next });
+            }
+        });
+    }
+
+    return result;
+}
+
+}
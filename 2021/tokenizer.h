@@ -0,0 +1,146 @@
+#pragma once
+
+/* Input tokenizer shared by the read_file functions of all days.
+ *
+ * The whole input file is memory mapped, or read into a single buffer if it
+ * cannot be mapped, and scanned in place. Lines and tokens are returned as
+ * std::string_view into the input, so they are only valid as long as the
+ * tokenizer that returned them. A file that cannot be opened gives an empty
+ * input, like the std::ifstream it replaces.
+ *
+ * Scanning text is constexpr, so days can parse the examples embedded in
+ * their source and check them with static_assert.
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct Tokenizer {
+    std::string_view rest;
+    void *mapping = nullptr;
+    std::size_t mapping_size = 0;
+    std::string buffer;
+
+    /* Scan text owned by someone else, e.g. a line of another tokenizer */
+    constexpr explicit Tokenizer(std::string_view text) : rest(text) { }
+
+    explicit Tokenizer(const std::string &filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                mapping = data;
+                mapping_size = st.st_size;
+                // Inputs are scanned once from front to back
+                madvise(data, mapping_size, MADV_SEQUENTIAL);
+                rest = std::string_view(static_cast<const char *>(data), mapping_size);
+            }
+        }
+
+        // Pipes and other files without a size can't be mapped
+        if (!mapping) {
+            char chunk[1 << 16];
+            ssize_t n;
+            while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+                buffer.append(chunk, n);
+            }
+            rest = buffer;
+        }
+
+        close(fd);
+    }
+
+    constexpr ~Tokenizer() {
+        if (mapping) {
+            munmap(mapping, mapping_size);
+        }
+    }
+
+    Tokenizer(const Tokenizer &) = delete;
+    Tokenizer &operator=(const Tokenizer &) = delete;
+
+    static constexpr bool is_digit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static constexpr bool is_space(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    /* Read the next line without its newline, like std::getline */
+    constexpr bool next_line(std::string_view &line) {
+        if (rest.empty()) {
+            return false;
+        }
+
+        auto end = rest.find('\n');
+        line = rest.substr(0, end);
+        rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+        return true;
+    }
+
+    /* Read the next whitespace separated token, like operator>> on a string */
+    constexpr bool next_token(std::string_view &token) {
+        const char *p = rest.data(), *end = p + rest.size();
+        while (p != end && is_space(*p)) ++p;
+        if (p == end) {
+            rest = std::string_view(end, 0);
+            return false;
+        }
+
+        const char *start = p;
+        while (p != end && !is_space(*p)) ++p;
+        token = std::string_view(start, p - start);
+        rest = std::string_view(p, end - p);
+        return true;
+    }
+
+    /* Read the next unsigned integer, skipping anything in front of it. The
+     * value is set to zero if there is none. */
+    template <typename T>
+    constexpr bool next_uint(T &value) {
+        const char *p = rest.data(), *end = p + rest.size();
+        while (p != end && !is_digit(*p)) ++p;
+        if (p == end) {
+            value = 0;
+            rest = std::string_view(end, 0);
+            return false;
+        }
+
+        T result = 0;
+        for (; p != end && is_digit(*p); ++p) {
+            result = result * 10 + (*p - '0');
+        }
+
+        value = result;
+        rest = std::string_view(p, end - p);
+        return true;
+    }
+
+    /* Read the next integer like next_uint. It is negative if a minus sign
+     * directly precedes its digits. */
+    template <typename T>
+    constexpr bool next_int(T &value) {
+        bool negative = false;
+        while (!rest.empty() && !is_digit(rest.front())) {
+            negative = rest.front() == '-';
+            rest.remove_prefix(1);
+        }
+
+        T magnitude;
+        bool found = next_uint(magnitude);
+        value = negative ? -magnitude : magnitude;
+        return found;
+    }
+};
@@ -0,0 +1,69 @@
+#!/bin/bash
+# This script benchmarks the given days (all days by default) in the single
+# runner and records or checks a baseline of their timings. Options after --
+# are passed to aoc_all_bench. Each phase runs 20 times on one worker by
+# default, as the peak RSS of a phase is only measured on a single worker.
+#
+# With -r it records a baseline file, and with -c it runs the same benchmarks
+# and compares them to a recorded baseline, failing if any phase got
+# significantly slower (see src/compare.c). With -s the days run on inputs of
+# the given scale from the generator instead of the puzzle inputs.
+# Example: ./bench.sh -r baseline.csv -s 1000 9 16
+#          ./bench.sh -c baseline.csv -s 1000 9 16
+
+usage() {
+    echo "Usage: $0 -r baseline | -c baseline [-s scale] [days...] [-- options]"
+    exit 1
+}
+
+record=""
+compare=""
+scale=""
+while getopts "r:c:s:" option; do
+    case "$option" in
+        r) record="$OPTARG" ;;
+        c) compare="$OPTARG" ;;
+        s) scale="$OPTARG" ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+if [[ -z "$record" && -z "$compare" || -n "$record" && -n "$compare" ]]; then
+    usage
+fi
+
+days=()
+while [[ $# -gt 0 && "$1" != "--" ]]; do
+    days+=("$1")
+    shift
+done
+[[ "$1" == "--" ]] && shift
+
+if [[ ${#days[@]} -eq 0 ]]; then
+    days=($(seq 1 25))
+fi
+
+cd build || (echo "Build directory not found. Run build.sh first." && exit 1)
+make aoc_all_bench generate compare > /dev/null 2>&1 || exit
+cd ..
+
+inputs="inputs"
+if [[ -n "$scale" ]]; then
+    inputs="build/inputs_$scale"
+    mkdir -p "$inputs"
+    for day in "${days[@]}"; do
+        input="$inputs/day_$(printf "%02d" "$day").txt"
+        [[ -f "$input" ]] || ./build/generate "$day" "$scale" > "$input" || exit
+    done
+fi
+
+output="${record:-$(mktemp)}"
+./build/aoc_all_bench -j 1 -n 20 -i "$inputs" -b "${scale:-puzzle}" "$@" "${days[@]}" \
+    > "$output" || exit
+
+if [[ -n "$compare" ]]; then
+    ./build/compare "$compare" "$output"
+    status=$?
+    rm "$output"
+    exit $status
+fi
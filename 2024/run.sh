@@ -1,12 +1,22 @@
 #!/bin/bash
-# This script compiles and runs the solution for a given day.
+# This script compiles and runs the solution for a given day. With "all", it
+# runs all days (or the listed ones) concurrently in a single process.
 
 if [[ -z "$1" ]]; then
     echo "Please provide the day number as an argument."
     echo "Example: $0 1"
+    echo "Example: $0 all [-j workers] [-i inputs] [days...]"
     exit 1
 fi
 
+if [[ "$1" == "all" ]]; then
+    cd build || (echo "Build directory not found. Run build.sh first." && exit 1)
+    make aoc_all > /dev/null 2>&1 || exit
+    cd ..
+    ./build/aoc_all "${@:2}"
+    exit
+fi
+
 # Pad the day number with a leading zero if necessary
 if [[ ${#1} -eq 1 ]]; then
     day="0$1"
@@ -0,0 +1,466 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <sys/resource.h>
+
+#include "utils.h"
+
+#define DAYS 25
+#define MAX_PATH 256
+
+// Each day is parsed once and then both of its parts are run, so there are at
+// most three tasks per day in every repetition.
+#define MAX_TASKS (3 * DAYS)
+
+#define SOLUTIONS                                                            \
+    X(01) X(02) X(03) X(04) X(05) X(06) X(07) X(08) X(09) X(10) X(11) X(12) \
+    X(13) X(14) X(15) X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23) X(24) \
+    X(25)
+
+#define X(day) extern const Solution solution_##day;
+SOLUTIONS
+#undef X
+
+const Solution *solutions[DAYS] = {
+#define X(day) &solution_##day,
+    SOLUTIONS
+#undef X
+};
+
+typedef enum Phase { PARSE, PART_1, PART_2, PARTS } Phase;
+
+const char *phase_names[] = {"parse", "part1", "part2"};
+
+// Heap use of a task. Live bytes count the usable size of the blocks, and can
+// drop below zero when a task frees what an earlier one allocated. The peak
+// is the highest live count during the task.
+typedef struct Memory {
+    size_t allocations;
+    size_t bytes;
+    ptrdiff_t live;
+    ptrdiff_t peak;
+} Memory;
+
+typedef struct Task {
+    size_t day;
+    Phase phase;
+} Task;
+
+typedef struct Day {
+    char filename[MAX_PATH];
+    void *input;
+    size_t parts_left;
+    char answers[2][ANSWER_SIZE];
+    // Time in ms of every repetition of each phase
+    double *times[3];
+    // Heap use of the last repetition, and the highest peak RSS of all
+    Memory memory[3];
+    long peak_rss_kb[3];
+} Day;
+
+typedef struct Pool {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    Task tasks[MAX_TASKS];
+    size_t head, tail;
+    size_t pending;
+    size_t repetition;
+    // The peak RSS belongs to the whole process, so it is only measured per
+    // task when tasks run one at a time
+    bool measure_rss;
+    Day days[DAYS];
+} Pool;
+
+void submit(Pool *pool, Task task);
+void *worker(void *arg);
+int compare_times(const void *a, const void *b);
+
+// In benchmark builds every heap allocation of the process is counted for the
+// task running on the calling thread, before it is passed on to glibc's
+// allocator. Other builds leave the allocator alone and report no heap use.
+#if defined(BENCHMARK) && defined(__GLIBC__)
+#define COUNT_HEAP true
+#else
+#define COUNT_HEAP false
+#endif
+
+static _Thread_local Memory memory;
+
+#if COUNT_HEAP
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *ptr);
+
+static void *count_allocation(void *ptr, size_t size) {
+    if (ptr) {
+        ++memory.allocations;
+        memory.bytes += size;
+        memory.live += malloc_usable_size(ptr);
+        memory.peak = memory.live > memory.peak ? memory.live : memory.peak;
+    }
+    return ptr;
+}
+
+static void count_free(void *ptr) {
+    if (ptr) {
+        memory.live -= malloc_usable_size(ptr);
+    }
+}
+
+void *malloc(size_t size) {
+    return count_allocation(__libc_malloc(size), size);
+}
+
+void *calloc(size_t count, size_t size) {
+    return count_allocation(__libc_calloc(count, size), count * size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    count_free(ptr);
+    return count_allocation(__libc_realloc(ptr, size), size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+    return count_allocation(__libc_memalign(alignment, size), size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    *ptr = count_allocation(__libc_memalign(alignment, size), size);
+    return *ptr ? 0 : ENOMEM;
+}
+
+void free(void *ptr) {
+    count_free(ptr);
+    __libc_free(ptr);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    long repetitions = 1;
+    const char *inputs = "inputs";
+    const char *baseline = 0;
+    bool selected[DAYS] = {0};
+    bool any_selected = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+            workers = atol(argv[++i]);
+        } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            repetitions = atol(argv[++i]);
+        } else if (!strcmp(argv[i], "-i") && i + 1 < argc) {
+            inputs = argv[++i];
+        } else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+            baseline = argv[++i];
+        } else if (atoi(argv[i]) >= 1 && atoi(argv[i]) <= DAYS) {
+            selected[atoi(argv[i]) - 1] = true;
+            any_selected = true;
+        } else {
+            fprintf(
+                stderr,
+                "Usage: %s [-j workers] [-n repetitions] [-i inputs] "
+                "[-b scale] [days...]\n",
+                argv[0]
+            );
+            return EXIT_FAILURE;
+        }
+    }
+    workers = workers > 0 ? workers : 1;
+    repetitions = repetitions > 0 ? repetitions : 1;
+
+    Pool *pool = calloc(1, sizeof(Pool));
+    pool->measure_rss = workers == 1;
+    pthread_mutex_init(&pool->lock, 0);
+    pthread_cond_init(&pool->cond, 0);
+
+    for (size_t i = 0; i < DAYS; ++i) {
+        selected[i] |= !any_selected;
+        if (!selected[i]) {
+            continue;
+        }
+
+        Day *day = &pool->days[i];
+        snprintf(
+            day->filename, MAX_PATH, "%s/day_%s.txt", inputs, solutions[i]->day
+        );
+        if (access(day->filename, R_OK)) {
+            fprintf(stderr, "Skipping missing input %s\n", day->filename);
+            selected[i] = false;
+            continue;
+        }
+        for (Phase phase = PARSE; phase <= PART_2; ++phase) {
+            day->times[phase] = calloc(repetitions, sizeof(double));
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t *threads = malloc(workers * sizeof(pthread_t));
+    for (long r = 0; r < repetitions; ++r) {
+        // Queue parsing of all days with an available input
+        pool->repetition = r;
+        pool->head = pool->tail = 0;
+        for (size_t i = 0; i < DAYS; ++i) {
+            if (selected[i]) {
+                submit(pool, (Task){i, PARSE});
+            }
+        }
+
+        for (long i = 0; i < workers; ++i) {
+            pthread_create(&threads[i], 0, worker, pool);
+        }
+        for (long i = 0; i < workers; ++i) {
+            pthread_join(threads[i], 0);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (baseline) {
+        printf(
+            "day,phase,scale,repetitions,median_ns,ops_per_sec,"
+            "peak_live_bytes,peak_rss_kb,samples_ns\n"
+        );
+    } else {
+        printf(
+            "day,phase,answer,ms,allocations,allocated_bytes,peak_live_bytes,"
+            "peak_rss_kb\n"
+        );
+    }
+    for (size_t i = 0; i < DAYS; ++i) {
+        if (!selected[i]) {
+            continue;
+        }
+
+        Day *day = &pool->days[i];
+        const char *d = solutions[i]->day;
+        for (Phase phase = PARSE; phase <= PART_2; ++phase) {
+            if (phase == PART_2 && !solutions[i]->part_2) {
+                continue;
+            }
+
+            double *times = day->times[phase];
+            qsort(times, repetitions, sizeof(double), compare_times);
+            double median = times[repetitions / 2];
+            Memory *m = &day->memory[phase];
+
+            // Columns that were not measured are left empty
+            if (baseline) {
+                printf(
+                    "%s,%s,%s,%ld,%.0f,%.2f,", d, phase_names[phase], baseline,
+                    repetitions, median * 1e6,
+                    1e3 / (median > 1e-6 ? median : 1e-6)
+                );
+                if (COUNT_HEAP) {
+                    printf("%td", m->peak);
+                }
+            } else {
+                printf("%s,%s,", d, phase_names[phase]);
+                if (phase != PARSE) {
+                    printf("\"%s\"", day->answers[phase - 1]);
+                }
+                printf(",%.3f,", median);
+                if (COUNT_HEAP) {
+                    printf("%zu,%zu,%td", m->allocations, m->bytes, m->peak);
+                } else {
+                    printf(",,");
+                }
+            }
+
+            putchar(',');
+            if (pool->measure_rss) {
+                printf("%ld", day->peak_rss_kb[phase]);
+            }
+            for (long r = 0; baseline && r < repetitions; ++r) {
+                printf("%s%.0f", r ? " " : ",", times[r] * 1e6);
+            }
+            putchar('\n');
+            free(times);
+        }
+    }
+
+    double total = (end.tv_sec - start.tv_sec) * 1e3
+                   + (end.tv_nsec - start.tv_nsec) / 1e6;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    fprintf(
+        stderr, "Total: %.3f ms on %ld workers, peak RSS %ld kB\n", total,
+        workers, usage.ru_maxrss
+    );
+    if (!pool->measure_rss) {
+        fprintf(stderr, "Peak RSS of each phase is only measured with -j 1\n");
+    }
+    if (!COUNT_HEAP) {
+        fprintf(stderr, "Heap use is only counted by aoc_all_bench\n");
+    }
+
+    free(threads);
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+
+    return EXIT_SUCCESS;
+}
+
+int compare_times(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Adds a task to the queue. Pending tasks keep the workers alive.
+void submit(Pool *pool, Task task) {
+    pthread_mutex_lock(&pool->lock);
+    pool->tasks[pool->tail++] = task;
+    ++pool->pending;
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Lets the kernel's peak RSS start again from the current RSS, if allowed
+void reset_peak_rss(void) {
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd >= 0) {
+        if (write(fd, "5", 1) < 0) {
+            perror("clear_refs");
+        }
+        close(fd);
+    }
+}
+
+// Returns the peak RSS in kB, or 0 where it is not known
+long peak_rss_kb(void) {
+    FILE *status = fopen("/proc/self/status", "r");
+    char line[256];
+    long kb = 0;
+    while (status && fgets(line, sizeof(line), status)) {
+        if (!strncmp(line, "VmHWM:", 6)) {
+            kb = atol(line + 6);
+        }
+    }
+    if (status) {
+        fclose(status);
+    }
+    return kb;
+}
+
+// Starts measuring the time and memory of a task on this thread
+void start_task(Pool *pool, struct timespec *start) {
+    memory = (Memory){0};
+    if (pool->measure_rss) {
+        reset_peak_rss();
+    }
+    clock_gettime(CLOCK_MONOTONIC, start);
+}
+
+double elapsed_ms(struct timespec start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start.tv_sec) * 1e3
+           + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+// Saves the time and memory of the phase of the day run by this task
+void finish_task(Pool *pool, Day *day, Phase phase, struct timespec start) {
+    day->times[phase][pool->repetition] = elapsed_ms(start);
+    day->memory[phase] = memory;
+    if (pool->measure_rss) {
+        long kb = peak_rss_kb();
+        if (kb > day->peak_rss_kb[phase]) {
+            day->peak_rss_kb[phase] = kb;
+        }
+    }
+}
+
+void run_part(Pool *pool, size_t i, Phase part) {
+    const Solution *solution = solutions[i];
+    Day *day = &pool->days[i];
+
+    struct timespec start;
+    start_task(pool, &start);
+    if (part == PART_1) {
+        solution->part_1(day->input, day->answers[0]);
+    } else {
+        solution->part_2(day->input, day->answers[1]);
+    }
+    finish_task(pool, day, part, start);
+}
+
+// Runs a single task. Parsing a day queues its parts, either as two
+// independent tasks or as a single one if the parts have to run in order.
+// The last finished part frees the parsed input.
+void run_task(Pool *pool, Task task) {
+    const Solution *solution = solutions[task.day];
+    Day *day = &pool->days[task.day];
+
+    if (task.phase == PARSE) {
+        struct timespec start;
+        start_task(pool, &start);
+        day->input = solution->parse(day->filename);
+        finish_task(pool, day, PARSE, start);
+
+        if (solution->sequential || !solution->part_2) {
+            day->parts_left = 1;
+            submit(pool, (Task){task.day, PARTS});
+        } else {
+            day->parts_left = 2;
+            submit(pool, (Task){task.day, PART_1});
+            submit(pool, (Task){task.day, PART_2});
+        }
+        return;
+    }
+
+    if (task.phase == PARTS) {
+        run_part(pool, task.day, PART_1);
+        if (solution->part_2) {
+            run_part(pool, task.day, PART_2);
+        }
+    } else {
+        run_part(pool, task.day, task.phase);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    bool last = --day->parts_left == 0;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (last) {
+        solution->free(day->input);
+    }
+}
+
+void *worker(void *arg) {
+    Pool *pool = arg;
+
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->head == pool->tail && pool->pending) {
+            pthread_cond_wait(&pool->cond, &pool->lock);
+        }
+
+        // Nothing is queued or running, so no more tasks can appear
+        if (!pool->pending) {
+            pthread_mutex_unlock(&pool->lock);
+            return 0;
+        }
+
+        Task task = pool->tasks[pool->head++];
+        pthread_mutex_unlock(&pool->lock);
+
+        run_task(pool, task);
+
+        pthread_mutex_lock(&pool->lock);
+        if (!--pool->pending) {
+            pthread_cond_broadcast(&pool->cond);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+// Opt-in cache of parsed inputs.
+//
+// If the AOC_CACHE environment variable names a directory, days that support
+// it save their parsed input there as a flat binary file named after the day
+// and a hash of the input file. Later runs on the same input map that file and
+// rebuild the parsed input from it instead of parsing the input again. Without
+// AOC_CACHE nothing is read or written.
+//
+// A day opens the cache with cache_open and tries to load its input with
+// cache_read. If that fails, it parses the input and saves it with
+// cache_write, in the same order it loads it. The day passes a layout version,
+// which it bumps whenever it changes what it saves, so that old cache files
+// are not read.
+//
+// A cache file is only used if the size of the input and two independent 64
+// bit hashes of it match those in its header.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils.h"
+
+#define CACHE_PATH 256
+#define CACHE_MAGIC "AOCCACH2"
+
+// Values are 8 byte aligned, so arrays can be used in place in the mapping
+#define CACHE_ALIGNMENT 8
+
+typedef struct CacheHeader {
+    char magic[8];
+    uint32_t layout;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t input_size;
+    uint64_t hash;
+    uint64_t check;
+} CacheHeader;
+
+typedef enum CacheMode { CACHE_OFF, CACHE_READ, CACHE_WRITE } CacheMode;
+
+typedef struct Cache {
+    CacheMode mode;
+    char path[CACHE_PATH];
+    uint32_t layout;
+    // Size and two hashes with different seeds of the input
+    uint64_t input_size;
+    uint64_t hash;
+    uint64_t check;
+    // Mapped cache file and the part of it not read yet when reading
+    char *mapping;
+    size_t mapping_size;
+    char *rest;
+    size_t rest_size;
+    // Temporary file that replaces the cache file when writing
+    FILE *out;
+} Cache;
+
+// Finalizer of MurmurHash3, every input bit affects every output bit
+static inline uint64_t cache_mix(uint64_t x) {
+    x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdull;
+    x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53ull;
+    return x ^ (x >> 33);
+}
+
+static inline uint64_t cache_fold(uint64_t h, uint64_t word, uint64_t seed) {
+    h = (h << 29 | h >> 35) ^ cache_mix(word ^ seed);
+    return h * 0x9e3779b97f4a7c15ull;
+}
+
+// Hash of the input, eight bytes at a time. Each word is mixed on its own
+// before it is folded into the state, so a change in any byte of it changes
+// all bits of the result.
+static inline uint64_t cache_hash(
+    const char *data, size_t size, uint64_t seed
+) {
+    uint64_t h = cache_mix(seed ^ size);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        h = cache_fold(h, word, seed);
+    }
+
+    // The rest is padded with zeros, which the size in the seed tells apart
+    uint64_t word = 0;
+    if (i < size) {
+        memcpy(&word, data + i, size - i);
+    }
+    return cache_mix(cache_fold(h, word, seed));
+}
+
+// Maps the cache file at path if it was written for the layout and input
+static inline bool cache_map(Cache *cache) {
+    int fd = open(cache->path, O_RDONLY);
+    struct stat st;
+    if (fd < 0) {
+        return false;
+    }
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(CacheHeader)) {
+        close(fd);
+        return false;
+    }
+
+    char *mapping = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    CacheHeader header;
+    memcpy(&header, mapping, sizeof(header));
+    if (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic))
+        || header.layout != cache->layout
+        || header.input_size != cache->input_size || header.hash != cache->hash
+        || header.check != cache->check
+        || header.size != st.st_size - sizeof(CacheHeader)) {
+        munmap(mapping, st.st_size);
+        return false;
+    }
+
+    cache->mapping = mapping;
+    cache->mapping_size = st.st_size;
+    cache->rest = mapping + sizeof(CacheHeader);
+    cache->rest_size = header.size;
+    return true;
+}
+
+// Opens the cache of the parsed input file of the day. The cache can be read
+// if it exists, otherwise it is written.
+static inline Cache cache_open(
+    const char *day, uint32_t layout, const char *filename
+) {
+    Cache cache = {.layout = layout};
+    const char *directory = getenv("AOC_CACHE");
+    if (!directory || !*directory) {
+        return cache;
+    }
+
+    MappedFile file = map_file(filename);
+    cache.input_size = file.size;
+    cache.hash = cache_hash(file.data, file.size, 0x243f6a8885a308d3ull);
+    cache.check = cache_hash(file.data, file.size, 0x13198a2e03707344ull);
+    unmap_file(file);
+
+    snprintf(
+        cache.path, CACHE_PATH, "%s/day_%s-%016llx.bin", directory, day,
+        (unsigned long long)cache.hash
+    );
+    cache.mode = cache_map(&cache) ? CACHE_READ : CACHE_WRITE;
+    return cache;
+}
+
+// Name of the temporary file written before it replaces the cache file
+static inline void cache_temporary(Cache *cache, char path[CACHE_PATH + 32]) {
+    snprintf(path, CACHE_PATH + 32, "%s.tmp%ld", cache->path, (long)getpid());
+}
+
+// Returns the next size bytes of the cache in place, or null if the cache
+// cannot be read or has no more data
+static inline const void *cache_read(Cache *cache, size_t size) {
+    size_t padded = (size + CACHE_ALIGNMENT - 1) & ~(CACHE_ALIGNMENT - 1);
+    if (cache->mode != CACHE_READ || padded > cache->rest_size) {
+        return 0;
+    }
+
+    const void *data = cache->rest;
+    cache->rest += padded;
+    cache->rest_size -= padded;
+    return data;
+}
+
+// Appends size bytes to the cache. A cache that was read is written anew,
+// after a failed load for example.
+static inline void cache_write(Cache *cache, const void *data, size_t size) {
+    if (cache->mode == CACHE_READ) {
+        munmap(cache->mapping, cache->mapping_size);
+        cache->mapping = 0;
+        cache->mode = CACHE_WRITE;
+    }
+    if (cache->mode != CACHE_WRITE) {
+        return;
+    }
+
+    // The header is written last, once the size is known
+    if (!cache->out) {
+        char temporary[CACHE_PATH + 32];
+        cache_temporary(cache, temporary);
+        cache->out = fopen(temporary, "wb");
+        if (!cache->out) {
+            cache->mode = CACHE_OFF;
+            return;
+        }
+        fseek(cache->out, sizeof(CacheHeader), SEEK_SET);
+    }
+
+    static const char padding[CACHE_ALIGNMENT] = {0};
+    fwrite(data, 1, size, cache->out);
+    fwrite(padding, 1, -size & (CACHE_ALIGNMENT - 1), cache->out);
+}
+
+// Unmaps the cache, or finishes writing it. The temporary file replaces the
+// cache file at once, so concurrent runs never see a partially written cache.
+static inline void cache_close(Cache *cache) {
+    if (cache->mapping) {
+        munmap(cache->mapping, cache->mapping_size);
+    }
+    if (!cache->out) {
+        return;
+    }
+
+    CacheHeader header = {
+        .layout = cache->layout,
+        .size = ftell(cache->out) - sizeof(CacheHeader),
+        .input_size = cache->input_size,
+        .hash = cache->hash,
+        .check = cache->check,
+    };
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    fseek(cache->out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, cache->out);
+
+    char temporary[CACHE_PATH + 32];
+    cache_temporary(cache, temporary);
+    if (fclose(cache->out) || rename(temporary, cache->path)) {
+        remove(temporary);
+    }
+}
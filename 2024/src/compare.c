@@ -0,0 +1,295 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define STB_DS_IMPLEMENTATION
+#include "stb_ds.h"
+
+// Comparison of benchmark runs against a recorded baseline:
+//
+//     ./compare [-a alpha] [-t threshold] baseline.csv current.csv
+//
+// Both files hold the rows aoc_all prints with -b (see bench.sh), one per day,
+// phase and input scale with all timings of the phase. For each phase in both
+// files the timings are compared with a one-sided Mann-Whitney U test, and a
+// bootstrap confidence interval of the ratio of the medians estimates how much
+// slower or faster it got. A phase is flagged as slower if the test is
+// significant at alpha and the whole interval is above 1 + threshold, and as
+// faster the other way around. Peak live heap bytes are deterministic, so they
+// are flagged as soon as they grow by more than the threshold.
+//
+// The exit status is 1 if any phase got slower or uses more memory.
+
+#define FIELD_SIZE 32
+#define RESAMPLES 2000
+
+typedef struct Row {
+    char day[FIELD_SIZE];
+    char phase[FIELD_SIZE];
+    char scale[FIELD_SIZE];
+    long long median_ns;
+    long long peak_live_bytes;
+    double *samples;
+} Row;
+
+typedef struct Ranked {
+    double value;
+    bool first;
+} Ranked;
+
+// Copies the next comma separated field of the line and moves past it
+void next_field(char **line, char field[FIELD_SIZE]) {
+    size_t length = strcspn(*line, ",\n");
+    snprintf(field, FIELD_SIZE, "%.*s", (int) length, *line);
+    *line += length + ((*line)[length] == ',');
+}
+
+// Returns the rows of the file. Lines that do not parse are skipped.
+Row *read_rows(const char *filename) {
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot read %s\n", filename);
+        exit(2);
+    }
+
+    Row *rows = 0;
+    char *buffer = 0;
+    size_t capacity = 0;
+    while (getline(&buffer, &capacity, file) > 0) {
+        Row row = {0};
+        char field[FIELD_SIZE];
+        char *line = buffer;
+
+        next_field(&line, row.day);
+        next_field(&line, row.phase);
+        next_field(&line, row.scale);
+        next_field(&line, field);
+        next_field(&line, field);
+        row.median_ns = atoll(field);
+        next_field(&line, field);
+        next_field(&line, field);
+        row.peak_live_bytes = atoll(field);
+        next_field(&line, field);
+
+        char *end;
+        for (double ns = strtod(line, &end); end != line;
+             ns = strtod(line, &end)) {
+            arrput(row.samples, ns);
+            line = end;
+        }
+
+        if (strcmp(row.day, "day") && arrlen(row.samples)) {
+            arrput(rows, row);
+        } else {
+            arrfree(row.samples);
+        }
+    }
+
+    free(buffer);
+    fclose(file);
+    return rows;
+}
+
+int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+int compare_ranked(const void *a, const void *b) {
+    return compare_doubles(
+        &((const Ranked *) a)->value, &((const Ranked *) b)->value
+    );
+}
+
+// Sorts the values in place
+double median(double *values, size_t length) {
+    qsort(values, length, sizeof(double), compare_doubles);
+    return values[length / 2];
+}
+
+// Returns the probability of a U statistic of a at least this large if a and
+// b come from the same distribution, i.e. a one-sided p-value for a being
+// larger. Uses the normal approximation with tie and continuity corrections.
+double mann_whitney(double *a, double *b) {
+    size_t n1 = arrlen(a), n2 = arrlen(b), n = n1 + n2;
+    Ranked *all = malloc(n * sizeof(Ranked));
+    for (size_t i = 0; i < n; ++i) {
+        all[i] = (Ranked){i < n1 ? a[i] : b[i - n1], i < n1};
+    }
+    qsort(all, n, sizeof(Ranked), compare_ranked);
+
+    // Ties share the average of their ranks
+    double rank_sum = 0, ties = 0;
+    for (size_t i = 0; i < n;) {
+        size_t j = i;
+        while (j < n && all[j].value == all[i].value) {
+            ++j;
+        }
+        double rank = (i + j + 1) / 2.0;
+        for (size_t k = i; k < j; ++k) {
+            rank_sum += all[k].first ? rank : 0;
+        }
+        double t = j - i;
+        ties += t * t * t - t;
+        i = j;
+    }
+    free(all);
+
+    double u = rank_sum - n1 * (n1 + 1) / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - ties / ((double) n * (n - 1)));
+    if (variance <= 0) {
+        return 0.5;
+    }
+    double z = (u - n1 * n2 / 2.0 - 0.5) / sqrt(variance);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+// SplitMix64, seeded the same way every time so that the same files always
+// give the same interval
+uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+// Draws a sample of the same size with replacement and returns its median
+double resample_median(double *values, double *resample, uint64_t *state) {
+    size_t length = arrlen(values);
+    for (size_t i = 0; i < length; ++i) {
+        resample[i] = values[next_random(state) % length];
+    }
+    return median(resample, length);
+}
+
+// Bootstrap confidence interval at the given level of the ratio of the median
+// of a to the median of b
+void bootstrap_ratio(double *a, double *b, double level, double interval[2]) {
+    uint64_t state = 42;
+    double *ratios = malloc(RESAMPLES * sizeof(double));
+    double *resample_a = malloc(arrlen(a) * sizeof(double));
+    double *resample_b = malloc(arrlen(b) * sizeof(double));
+
+    for (size_t i = 0; i < RESAMPLES; ++i) {
+        double median_a = resample_median(a, resample_a, &state);
+        double median_b = resample_median(b, resample_b, &state);
+        ratios[i] = median_a / (median_b > 1 ? median_b : 1);
+    }
+
+    qsort(ratios, RESAMPLES, sizeof(double), compare_doubles);
+    size_t tail = (1 - level) / 2 * RESAMPLES;
+    interval[0] = ratios[tail];
+    interval[1] = ratios[RESAMPLES - 1 - tail];
+
+    free(resample_b);
+    free(resample_a);
+    free(ratios);
+}
+
+Row *find_row(Row *rows, Row *key) {
+    for (ptrdiff_t i = 0; i < arrlen(rows); ++i) {
+        if (!strcmp(rows[i].day, key->day) && !strcmp(rows[i].phase, key->phase)
+            && !strcmp(rows[i].scale, key->scale)) {
+            return &rows[i];
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    double alpha = 0.01;
+    double threshold = 0.05;
+    const char *files[2];
+    int num_files = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-a") && i + 1 < argc) {
+            alpha = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (num_files < 2) {
+            files[num_files++] = argv[i];
+        } else {
+            num_files = 0;
+            break;
+        }
+    }
+    if (num_files != 2) {
+        fprintf(
+            stderr, "Usage: %s [-a alpha] [-t threshold] baseline current\n",
+            argv[0]
+        );
+        return 2;
+    }
+
+    Row *baseline = read_rows(files[0]);
+    Row *current = read_rows(files[1]);
+
+    printf(
+        "%-4s %-6s %-8s %14s %14s %8s %17s %9s  %s\n", "day", "phase", "scale",
+        "baseline ns", "current ns", "change", "interval", "p", "verdict"
+    );
+
+    int regressions = 0;
+    for (ptrdiff_t i = 0; i < arrlen(current); ++i) {
+        Row *row = &current[i];
+        Row *base = find_row(baseline, row);
+        if (!base) {
+            printf(
+                "%-4s %-6s %-8s %14s %14lld %8s %17s %9s  new\n", row->day,
+                row->phase, row->scale, "-", row->median_ns, "-", "-", "-"
+            );
+            continue;
+        }
+
+        double slower = mann_whitney(row->samples, base->samples);
+        double faster = mann_whitney(base->samples, row->samples);
+        double interval[2];
+        bootstrap_ratio(row->samples, base->samples, 1 - 2 * alpha, interval);
+        double base_median = median(base->samples, arrlen(base->samples));
+        double change = median(row->samples, arrlen(row->samples))
+                            / (base_median > 1 ? base_median : 1)
+                        - 1;
+
+        const char *verdict = "same";
+        if (slower < alpha && interval[0] > 1 + threshold) {
+            verdict = "SLOWER";
+            ++regressions;
+        } else if (faster < alpha && interval[1] < 1 - threshold) {
+            verdict = "faster";
+        }
+
+        char range[32];
+        snprintf(range, sizeof(range), "[%.3f, %.3f]", interval[0], interval[1]);
+        printf(
+            "%-4s %-6s %-8s %14lld %14lld %+7.1f%% %17s %9.2g  %s", row->day,
+            row->phase, row->scale, base->median_ns, row->median_ns,
+            100 * change, range, slower < faster ? slower : faster, verdict
+        );
+        if (row->peak_live_bytes > base->peak_live_bytes * (1 + threshold)) {
+            printf(
+                ", MORE MEMORY (%lld -> %lld bytes)", base->peak_live_bytes,
+                row->peak_live_bytes
+            );
+            ++regressions;
+        }
+        putchar('\n');
+    }
+
+    if (regressions) {
+        fprintf(stderr, "%d regression(s) against %s\n", regressions, files[0]);
+    }
+
+    for (ptrdiff_t i = 0; i < arrlen(baseline); ++i) {
+        arrfree(baseline[i].samples);
+    }
+    for (ptrdiff_t i = 0; i < arrlen(current); ++i) {
+        arrfree(current[i].samples);
+    }
+    arrfree(baseline);
+    arrfree(current);
+    return regressions ? 1 : 0;
+}
@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 1024
 #define DAY 01
 
 typedef struct Locations {
@@ -22,6 +21,37 @@ void free_locations(Locations locations);
 int lists_difference(Locations locations);
 int lists_similarity(Locations locations);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Locations *input = malloc(sizeof(Locations));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Locations locations = *(Locations *) input;
+    snprintf(answer, ANSWER_SIZE, "%d", lists_difference(locations));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Locations locations = *(Locations *) input;
+    snprintf(answer, ANSWER_SIZE, "%d", lists_similarity(locations));
+}
+
+static void free_input(void *input) {
+    free_locations(*(Locations *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = true,
+};
+#else
 int main(void) {
     test();
 
@@ -32,6 +62,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -42,18 +73,17 @@ void test() {
 }
 
 Locations read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
     Locations locations = {0};
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        int left, right;
-        if (sscanf(buffer, "%d %d", &left, &right) != 2) {
-            fprintf(stderr, "Invalid input: %s", buffer);
+    View rest = file_view(file), line;
+    while (next_line(&rest, &line)) {
+        long long left, right;
+        View numbers = line;
+        if (!next_number(&numbers, &left) || !next_number(&numbers, &right)) {
+            fprintf(
+                stderr, "Invalid input: %.*s\n", (int) line.len, line.ptr
+            );
             exit(EXIT_FAILURE);
         }
 
@@ -62,7 +92,7 @@ Locations read_input(const char *filename) {
         ++locations.length;
     }
 
-    fclose(file);
+    unmap_file(file);
     return locations;
 }
 
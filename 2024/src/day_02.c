@@ -8,7 +8,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 1024
 #define MAX_REPORT 8
 #define DAY 02
 
@@ -21,6 +20,35 @@ void test();
 Report *read_input(const char *filename);
 size_t safe_reports(Report *reports, bool dampener);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    return read_input(filename);
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Report *reports = input;
+    snprintf(answer, ANSWER_SIZE, "%zu", safe_reports(reports, false));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Report *reports = input;
+    snprintf(answer, ANSWER_SIZE, "%zu", safe_reports(reports, true));
+}
+
+static void free_input(void *input) {
+    Report *reports = input;
+    arrfree(reports);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -31,6 +59,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -40,30 +69,27 @@ void test() {
     arrfree(reports);
 }
 
-Report parse_report(char *line) {
+Report parse_report(View line) {
     Report report = {0};
 
-    for (char *token = strtok(line, " "); token; token = strtok(0, " ")) {
-        report.levels[report.length++] = atoi(token);
+    long long level;
+    while (next_number(&line, &level)) {
+        report.levels[report.length++] = level;
     }
 
     return report;
 }
 
 Report *read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
     Report *reports = 0;
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        arrput(reports, parse_report(buffer));
+    View rest = file_view(file), line;
+    while (next_line(&rest, &line)) {
+        arrput(reports, parse_report(line));
     }
 
-    fclose(file);
+    unmap_file(file);
     return reports;
 }
 
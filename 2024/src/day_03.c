@@ -8,11 +8,12 @@
 
 #include "utils.h"
 
-#define MAX_LINE 4096
 #define DAY 03
 
+// The instructions are searched for in the mapped file directly. They never
+// span lines, so the file does not need to be split.
 typedef struct Memory {
-    const char **lines;
+    MappedFile file;
 } Memory;
 
 void test();
@@ -20,6 +21,37 @@ Memory read_input(const char *filename);
 void free_memory(Memory memory);
 int find_instructions(Memory memory, bool conditionals);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Memory *input = malloc(sizeof(Memory));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Memory memory = *(Memory *) input;
+    snprintf(answer, ANSWER_SIZE, "%d", find_instructions(memory, false));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Memory memory = *(Memory *) input;
+    snprintf(answer, ANSWER_SIZE, "%d", find_instructions(memory, true));
+}
+
+static void free_input(void *input) {
+    free_memory(*(Memory *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -30,6 +62,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -43,36 +76,11 @@ void test() {
 }
 
 Memory read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
-
-    Memory memory = {0};
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        // Remove the newline character
-        char *new_line_char = strchr(buffer, '\n');
-        if (new_line_char) {
-            *new_line_char = '\0';
-        }
-
-        char *line = malloc(strlen(buffer) + 1);
-        strcpy(line, buffer);
-        arrput(memory.lines, line);
-    }
-
-    fclose(file);
-    return memory;
+    return (Memory){map_file(filename)};
 }
 
 void free_memory(Memory memory) {
-    size_t lines = arrlen(memory.lines);
-    for (size_t i = 0; i < lines; ++i) {
-        free((void *) memory.lines[i]);
-    }
-    arrfree(memory.lines);
+    unmap_file(memory.file);
 }
 
 // Find mul instructions and return the sum of their return values. If
@@ -89,32 +97,24 @@ int find_instructions(Memory memory, bool conditionals) {
         REG_EXTENDED
     );
 
-    size_t lines = arrlen(memory.lines);
-    for (size_t i = 0; i < lines; ++i) {
-        char *line = malloc(strlen(memory.lines[i]) + 1);
-        strcpy(line, memory.lines[i]);
-
-        char *start = line;
-        while (!regexec(&regex, start, 1, match, 0)) {
-            // Replace the last ) with a null terminator
-            start[match[0].rm_eo - 1] = '\0';
-
-            if (!strcmp(start + match[0].rm_so, "do(")) {
-                enabled = true;
-            } else if (!strcmp(start + match[0].rm_so, "don't(")) {
-                enabled = false;
-            } else if (enabled || !conditionals) {
-                // Create two strings for the two numbers
-                char *left = start + match[0].rm_so + sizeof("mul");
-                char *right = strchr(left, ',') + 1;
-                right[-1] = '\0';
-                sum += atoi(left) * atoi(right);
-            }
-
-            start += match[0].rm_eo;
+    // The mapping is shared by both parts, so matches are compared by length
+    // instead of being null-terminated in place
+    const char *start = memory.file.data;
+    while (!regexec(&regex, start, 1, match, 0)) {
+        const char *instruction = start + match[0].rm_so;
+        size_t len = match[0].rm_eo - match[0].rm_so;
+
+        if (!strncmp(instruction, "do()", len)) {
+            enabled = true;
+        } else if (!strncmp(instruction, "don't()", len)) {
+            enabled = false;
+        } else if (enabled || !conditionals) {
+            char *right;
+            int left = strtol(instruction + sizeof("mul"), &right, 10);
+            sum += left * atoi(right + 1);
         }
 
-        free(line);
+        start += match[0].rm_eo;
     }
 
     regfree(&regex);
@@ -7,13 +7,14 @@
 
 #include "utils.h"
 
-#define MAX_LINE 256
 #define DAY 04
 
+// Rows point into the mapped input file and are not null-terminated
 typedef struct Grid {
     size_t rows;
     size_t cols;
     char **data;
+    MappedFile file;
 } Grid;
 
 void test();
@@ -22,6 +23,37 @@ void free_grid(Grid grid);
 size_t occurrences(const Grid, const char *word);
 size_t x_occurrences(const Grid);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Grid *input = malloc(sizeof(Grid));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Grid grid = *(Grid *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", occurrences(grid, "XMAS"));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Grid grid = *(Grid *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", x_occurrences(grid));
+}
+
+static void free_input(void *input) {
+    free_grid(*(Grid *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -32,6 +64,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -42,39 +75,24 @@ void test() {
 }
 
 Grid read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
-
-    Grid grid = {0};
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        char *new_line = strchr(buffer, '\n');
-        if (new_line) {
-            *new_line = '\0';
-        }
+    Grid grid = {.file = map_file(filename)};
 
-        char *line = malloc(strlen(buffer) + 1);
-        strcpy(line, buffer);
-        arrput(grid.data, line);
+    View rest = file_view(grid.file), line;
+    while (next_line(&rest, &line)) {
+        arrput(grid.data, line.ptr);
 
         ++grid.rows;
         if (!grid.cols) {
-            grid.cols = strlen(line);
+            grid.cols = line.len;
         }
     }
 
-    fclose(file);
     return grid;
 }
 
 void free_grid(Grid grid) {
-    for (size_t i = 0; i < grid.rows; ++i) {
-        free((void *) grid.data[i]);
-    }
     arrfree(grid.data);
+    unmap_file(grid.file);
 }
 
 // Return true if there is a word match in the given grid, starting at (x, y)
@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 128
 #define DAY 05
 
 // Because the largest page is 99, we use a 100x100 grid
@@ -24,6 +23,35 @@ void free_pages(Pages pages);
 size_t correctly_ordered_middle(Pages *pages);
 size_t incorrectly_ordered_middle(Pages *pages);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Pages *input = malloc(sizeof(Pages));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    snprintf(answer, ANSWER_SIZE, "%zu", correctly_ordered_middle(input));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    snprintf(answer, ANSWER_SIZE, "%zu", incorrectly_ordered_middle(input));
+}
+
+static void free_input(void *input) {
+    free_pages(*(Pages *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -34,6 +62,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -44,33 +73,29 @@ void test() {
 }
 
 Pages read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
-
-    char buffer[MAX_LINE];
+    MappedFile file = map_file(filename);
+    View rest = file_view(file), line;
     Pages pages = {0};
 
     // Read ordering rules
-    while (fgets(buffer, MAX_LINE, file) && buffer[0] != '\n') {
-        buffer[2] = '\0';
-        size_t left = atoi(buffer);
-        size_t right = atoi(buffer + 3);
+    while (next_line(&rest, &line) && line.len) {
+        long long left, right;
+        next_number(&line, &left);
+        next_number(&line, &right);
         pages.ordering[left][right] = true;
     }
 
     // Read updates
-    while (fgets(buffer, MAX_LINE, file)) {
+    while (next_line(&rest, &line)) {
         size_t *update = 0;
-        for (char *token = strtok(buffer, ","); token; token = strtok(0, ",")) {
-            arrput(update, atoi(token));
+        long long page;
+        while (next_number(&line, &page)) {
+            arrput(update, page);
         }
         arrput(pages.updates, update);
     }
 
-    fclose(file);
+    unmap_file(file);
     return pages;
 }
 
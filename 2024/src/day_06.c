@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 256
 #define DAY 06
 
 typedef enum Direction { UP, RIGHT, DOWN, LEFT, NUM_DIRS } Direction;
@@ -15,11 +14,13 @@ typedef struct Position {
     size_t x, y;
     Direction dir;
 } Position;
+// Rows point into the mapped input file and are not null-terminated
 typedef struct Map {
     char **map;
     size_t rows;
     size_t cols;
     Position start;
+    MappedFile file;
 } Map;
 
 const ptrdiff_t deltas[4][2] = {
@@ -32,9 +33,50 @@ const ptrdiff_t deltas[4][2] = {
 void test();
 Map read_input(const char *filename);
 void free_map(struct Map map);
-size_t possible_obstacles(Map map, Position pos, bool *visited, bool obstacle);
+size_t possible_obstacles(
+    Map map, Position pos, BitGrid visited, bool obstacle, Arena *arena
+);
 size_t visited_positions(Map map, size_t *obstacles);
 
+#ifdef AOC_ALL
+// Both answers are computed by part 1, part 2 only reports the saved one.
+typedef struct Input {
+    Map map;
+    size_t obstacles;
+} Input;
+
+static void *parse(const char *filename) {
+    Input *input = calloc(1, sizeof(Input));
+    input->map = read_input(filename);
+    return input;
+}
+
+static void part_1(void *data, char answer[ANSWER_SIZE]) {
+    Input *input = data;
+    size_t visited = visited_positions(input->map, &input->obstacles);
+    snprintf(answer, ANSWER_SIZE, "%zu", visited);
+}
+
+static void part_2(void *data, char answer[ANSWER_SIZE]) {
+    Input *input = data;
+    snprintf(answer, ANSWER_SIZE, "%zu", input->obstacles);
+}
+
+static void free_input(void *data) {
+    Input *input = data;
+    free_map(input->map);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = true,
+};
+#else
 int main(void) {
     test();
 
@@ -46,6 +88,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -75,39 +118,23 @@ void find_starting_position(Map *map) {
 }
 
 Map read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    Map map = {.file = map_file(filename)};
 
-    char buffer[MAX_LINE];
-    Map map = {0};
-
-    while (fgets(buffer, MAX_LINE, file)) {
-        char *line_end = strchr(buffer, '\n');
-        if (line_end) {
-            *line_end = '\0';
-        }
-
-        char *line = malloc(strlen(buffer));
-        memcpy((void *) line, buffer, strlen(buffer));
-        arrput(map.map, line);
+    View rest = file_view(map.file), line;
+    while (next_line(&rest, &line)) {
+        arrput(map.map, line.ptr);
 
         ++map.rows;
-        map.cols = strlen(buffer);
+        map.cols = line.len;
         find_starting_position(&map);
     }
 
-    fclose(file);
     return map;
 }
 
 void free_map(struct Map map) {
-    for (size_t i = 0; i < map.rows; ++i) {
-        free((void *) map.map[i]);
-    }
     arrfree(map.map);
+    unmap_file(map.file);
 }
 
 void move(size_t *x, size_t *y, Direction dir) {
@@ -115,32 +142,36 @@ void move(size_t *x, size_t *y, Direction dir) {
     *y += deltas[dir][1];
 }
 
-size_t visited_index(Map map, size_t x, size_t y, Direction dir) {
-    return (y * map.cols + x) * NUM_DIRS + dir;
+// The visited grid has a column for each direction of every map column
+size_t visited_column(size_t x, Direction dir) {
+    return x * NUM_DIRS + dir;
 }
 
 // Returns true if adding an obstacle in front of the guard, at pos, causes the
 // guard to get stuck in a cycle.
-bool obstacle_causes_cycle(Map map, Position pos, bool *visited) {
+bool obstacle_causes_cycle(
+    Map map, Position pos, BitGrid visited, Arena *arena
+) {
     bool can_add = pos.x < map.cols && pos.y < map.rows
                    && map.map[pos.y][pos.x] == '.';
-    for (size_t i = 0; i < NUM_DIRS; ++i) {
-        can_add &= !visited[visited_index(map, pos.x, pos.y, i)];
+    for (size_t i = 0; can_add && i < NUM_DIRS; ++i) {
+        can_add = !bitgrid_test(visited, visited_column(pos.x, i), pos.y);
     }
 
     if (!can_add) {
         return false;
     }
 
-    size_t size = map.rows * map.cols * NUM_DIRS * sizeof(bool);
-    bool *visited_copy = malloc(size);
-    memcpy(visited_copy, visited, size);
+    // The copy and everything the walk allocates is released on return
+    size_t mark = arena_mark(arena);
+    BitGrid visited_copy = bitgrid_arena(arena, visited.rows, visited.cols);
+    bitgrid_copy(visited_copy, visited);
 
     map.map[pos.y][pos.x] = '#';
-    bool cycle = possible_obstacles(map, pos, visited_copy, false);
+    bool cycle = possible_obstacles(map, pos, visited_copy, false, arena);
     map.map[pos.y][pos.x] = '.';
 
-    free(visited_copy);
+    arena_reset(arena, mark);
     return cycle;
 }
 
@@ -148,8 +179,10 @@ bool obstacle_causes_cycle(Map map, Position pos, bool *visited) {
 // cycle. The visited array is filled with visited positions of the guard
 // without adding any obstacles. We only add obstacles at the first recursion
 // level, where obstacle is true.
-size_t possible_obstacles(Map map, Position pos, bool *visited, bool obstacle) {
-    bool *obstacles = calloc(map.rows * map.cols, sizeof(bool));
+size_t possible_obstacles(
+    Map map, Position pos, BitGrid visited, bool obstacle, Arena *arena
+) {
+    BitGrid obstacles = bitgrid_arena(arena, map.rows, map.cols);
 
     while (pos.x < map.cols && pos.y < map.rows) {
         // Move back and turn right on obstacles
@@ -159,45 +192,39 @@ size_t possible_obstacles(Map map, Position pos, bool *visited, bool obstacle) {
         }
 
         // If we have already visited this position, we are in a cycle.
-        if (visited[visited_index(map, pos.x, pos.y, pos.dir)] && !obstacle) {
-            free(obstacles);
+        size_t column = visited_column(pos.x, pos.dir);
+        if (bitgrid_test_and_set(visited, column, pos.y) && !obstacle) {
             return 1;
         }
-        visited[visited_index(map, pos.x, pos.y, pos.dir)] = true;
         move(&pos.x, &pos.y, pos.dir);
 
         // Try adding an obstacle at the next position
-        if (obstacle && obstacle_causes_cycle(map, pos, visited)) {
-            obstacles[pos.y * map.cols + pos.x] = true;
+        if (obstacle && obstacle_causes_cycle(map, pos, visited, arena)) {
+            bitgrid_set(obstacles, pos.x, pos.y);
         }
     }
 
-    size_t count = 0;
-    for (size_t i = 0; i < map.rows * map.cols; ++i) {
-        count += obstacles[i];
-    }
-
-    free(obstacles);
-    return count;
+    return bitgrid_count(obstacles);
 }
 
 // Returns the number of distinct positions visited by the guard before
 // leaving the mapped area. The number of possible obstacles that cause a
 // cycle is stored in the obstacles pointer.
 size_t visited_positions(Map map, size_t *obstacles) {
-    size_t size = map.rows * map.cols * NUM_DIRS;
-    bool *visited = calloc(size, sizeof(bool));
-    *obstacles = possible_obstacles(map, map.start, visited, true);
+    Arena arena = arena_new();
+    BitGrid visited = bitgrid_arena(&arena, map.rows, map.cols * NUM_DIRS);
+    *obstacles = possible_obstacles(map, map.start, visited, true, &arena);
 
+    // The directions of a position are the four bits of an aligned nibble.
+    // Fold each nibble into its lowest bit and count those.
     size_t count = 0;
-    for (size_t i = 0; i < size; i += NUM_DIRS) {
-        bool is_visited = false;
-        for (size_t k = 0; k < NUM_DIRS; ++k) {
-            is_visited |= visited[i + k];
-        }
-        count += is_visited;
+    for (size_t i = 0; i < visited.length; ++i) {
+        uint64_t word = visited.words[i];
+        word |= word >> 2;
+        word |= word >> 1;
+        count += __builtin_popcountll(word & 0x1111111111111111);
     }
 
-    free(visited);
+    arena_free(&arena);
     return count;
 }
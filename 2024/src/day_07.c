@@ -8,7 +8,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 128
 #define DAY 07
 
 typedef struct Equation {
@@ -22,6 +21,37 @@ Equation *read_input(const char *filename);
 void free_equations(Equation *equations);
 size_t total_calibration_result(Equation *equations, bool concat);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    return read_input(filename);
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Equation *equations = input;
+    size_t result = total_calibration_result(equations, false);
+    snprintf(answer, ANSWER_SIZE, "%zu", result);
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Equation *equations = input;
+    size_t result = total_calibration_result(equations, true);
+    snprintf(answer, ANSWER_SIZE, "%zu", result);
+}
+
+static void free_input(void *input) {
+    Equation *equations = input;
+    free_equations(equations);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -32,6 +62,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -42,30 +73,26 @@ void test() {
 }
 
 Equation *read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
-    char buffer[MAX_LINE];
     Equation *equations = 0;
-    while (fgets(buffer, MAX_LINE, file)) {
+    View rest = file_view(file), line;
+    while (next_line(&rest, &line)) {
         Equation equation = {0};
-        char *numbers = strchr(buffer, ':') + 2;
+        long long number;
 
-        *(numbers - 2) = '\0';
-        equation.test_value = strtoull(buffer, 0, 10);
+        next_number(&line, &number);
+        equation.test_value = number;
 
-        for (char *tok = strtok(numbers, " "); tok; tok = strtok(0, " ")) {
-            arrput(equation.numbers, strtoull(tok, 0, 10));
+        while (next_number(&line, &number)) {
+            arrput(equation.numbers, number);
             ++equation.size;
         }
 
         arrput(equations, equation);
     }
 
-    fclose(file);
+    unmap_file(file);
     return equations;
 }
 
@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 64
 #define DAY 08
 
 // The last possible antenna is 'z' = 122
@@ -28,6 +27,37 @@ Map read_input(const char *filename);
 void free_map(Map map);
 size_t signal_impact(Map map, unsigned min_distance, unsigned max_distance);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Map *input = malloc(sizeof(Map));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Map map = *(Map *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", signal_impact(map, 1, 1));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Map map = *(Map *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", signal_impact(map, 0, -1));
+}
+
+static void free_input(void *input) {
+    free_map(*(Map *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -38,6 +68,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -48,31 +79,22 @@ void test() {
 }
 
 Map read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
-    char buffer[MAX_LINE];
     Map map = {0};
-    while (fgets(buffer, MAX_LINE, file)) {
-        char *line_end = strchr(buffer, '\n');
-        if (line_end) {
-            *line_end = '\0';
-        }
-
+    View rest = file_view(file), line;
+    while (next_line(&rest, &line)) {
         ++map.rows;
-        map.cols = strlen(buffer);
+        map.cols = line.len;
         for (size_t i = 0; i < map.cols; ++i) {
-            if (buffer[i] != '.') {
+            if (line.ptr[i] != '.') {
                 Location antenna = {i, map.rows - 1};
-                arrput(map.antennas[(size_t) buffer[i]], antenna);
+                arrput(map.antennas[(size_t) line.ptr[i]], antenna);
             }
         }
     }
 
-    fclose(file);
+    unmap_file(file);
     return map;
 }
 
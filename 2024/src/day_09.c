@@ -7,49 +7,73 @@
 
 #include "utils.h"
 
-#define MAX_LINE 20000
 #define DAY 09
 
 void test();
-char *read_input(const char *filename);
+MappedFile read_input(const char *filename);
 size_t compact_blocks(const char *memory_map);
 size_t compact_files(const char *memory_map);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    MappedFile *input = malloc(sizeof(MappedFile));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    const char *memory_map = ((MappedFile *) input)->data;
+    snprintf(answer, ANSWER_SIZE, "%zu", compact_blocks(memory_map));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    const char *memory_map = ((MappedFile *) input)->data;
+    snprintf(answer, ANSWER_SIZE, "%zu", compact_files(memory_map));
+}
+
+static void free_input(void *input) {
+    unmap_file(*(MappedFile *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
-    const char *memory_map = read_input("inputs/day_" STR(DAY) ".txt");
-    printf("%zu\n", compact_blocks(memory_map));
-    printf("%zu\n", compact_files(memory_map));
-    free((void *) memory_map);
+    MappedFile file = read_input("inputs/day_" STR(DAY) ".txt");
+    printf("%zu\n", compact_blocks(file.data));
+    printf("%zu\n", compact_files(file.data));
+    unmap_file(file);
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
-    const char *memory_map = read_input("inputs/day_" STR(DAY) "_test.txt");
-    assert_eq(compact_blocks(memory_map), 1928);
-    assert_eq(compact_files(memory_map), 2858);
-    free((void *) memory_map);
+    MappedFile file = read_input("inputs/day_" STR(DAY) "_test.txt");
+    assert_eq(compact_blocks(file.data), 1928);
+    assert_eq(compact_files(file.data), 2858);
+    unmap_file(file);
 }
 
-char *read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+// Maps the input file, whose data is the disk map as a null-terminated string
+MappedFile read_input(const char *filename) {
+    MappedFile file = map_file(filename);
 
-    char *memory_map = malloc(MAX_LINE);
-    fgets(memory_map, MAX_LINE, file);
-    char *line_end = strchr(memory_map, '\n');
-    if (line_end) {
-        *line_end = '\0';
-    }
+    View rest = file_view(file), line;
+    next_line(&rest, &line);
+    view_str(line);
 
-    fclose(file);
-    return memory_map;
+    return file;
 }
 
 // Computes the checksum after moving each file block to the leftmost free
@@ -7,13 +7,14 @@
 
 #include "utils.h"
 
-#define MAX_LINE 64
 #define DAY 10
 
+// Rows point into the mapped input file and are not null-terminated
 typedef struct Map {
     char **map;
     size_t rows;
     size_t cols;
+    MappedFile file;
 } Map;
 
 ptrdiff_t neighbors[4][2] = {
@@ -28,6 +29,45 @@ Map read_input(const char *filename);
 void free_map(Map map);
 size_t scores_ratings(Map map, size_t *ratings);
 
+#ifdef AOC_ALL
+// Both answers are computed by part 1, part 2 only reports the saved one.
+typedef struct Input {
+    Map map;
+    size_t ratings;
+} Input;
+
+static void *parse(const char *filename) {
+    Input *input = calloc(1, sizeof(Input));
+    input->map = read_input(filename);
+    return input;
+}
+
+static void part_1(void *data, char answer[ANSWER_SIZE]) {
+    Input *input = data;
+    size_t scores = scores_ratings(input->map, &input->ratings);
+    snprintf(answer, ANSWER_SIZE, "%zu", scores);
+}
+
+static void part_2(void *data, char answer[ANSWER_SIZE]) {
+    Input *input = data;
+    snprintf(answer, ANSWER_SIZE, "%zu", input->ratings);
+}
+
+static void free_input(void *data) {
+    Input *input = data;
+    free_map(input->map);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = true,
+};
+#else
 int main(void) {
     test();
 
@@ -39,6 +79,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -50,45 +91,30 @@ void test() {
 }
 
 Map read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
-
-    Map map = {0};
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        char *line_end = strchr(buffer, '\n');
-        if (line_end) {
-            *line_end = '\0';
-        }
+    Map map = {.file = map_file(filename)};
 
-        char *line = malloc(strlen(buffer));
-        memcpy((void *) line, buffer, strlen(buffer));
-        arrput(map.map, line);
+    View rest = file_view(map.file), line;
+    while (next_line(&rest, &line)) {
+        arrput(map.map, line.ptr);
 
         ++map.rows;
-        map.cols = strlen(buffer);
+        map.cols = line.len;
     }
 
-    fclose(file);
     return map;
 }
 
 void free_map(Map map) {
-    for (size_t i = 0; i < map.rows; ++i) {
-        free((void *) map.map[i]);
-    }
     arrfree(map.map);
+    unmap_file(map.file);
 }
 
 // Visits all possible positions and marks visited 9-height positions. It
 // returns the number of distinct hiking trails that lead to these positions.
-size_t visit(Map map, size_t x, size_t y, bool *visited) {
+size_t visit(Map map, size_t x, size_t y, BitGrid visited) {
     char height = map.map[y][x];
     if (height == '9') {
-        visited[y * map.cols + x] = true;
+        bitgrid_set(visited, x, y);
         return 1;
     }
 
@@ -107,33 +133,30 @@ size_t visit(Map map, size_t x, size_t y, bool *visited) {
 // Returns the score of the trailhead at position (x, y), i.e., the number of
 // 9-height positions reachable from it. The trailhead rating is saved into
 // the rating pointer, i.e., the number of distinct hiking trails that lead to
-// these positions.
-size_t trailhead_score_rating(Map map, size_t x, size_t y, size_t *rating) {
+// these positions. The visited grid is scratch space shared by all trailheads.
+size_t trailhead_score_rating(
+    Map map, size_t x, size_t y, BitGrid visited, size_t *rating
+) {
     if (map.map[y][x] != '0') {
         return 0;
     }
 
-    bool *visited = calloc(map.rows * map.cols, sizeof(bool));
+    bitgrid_reset(visited);
     *rating = visit(map, x, y, visited);
-
-    size_t score = 0;
-    for (size_t i = 0; i < map.rows * map.cols; ++i) {
-        score += visited[i];
-    }
-
-    free(visited);
-    return score;
+    return bitgrid_count(visited);
 }
 
 // Returns the sum of the scores and ratings of all trailheads.
 size_t scores_ratings(Map map, size_t *ratings) {
     size_t scores = 0;
+    BitGrid visited = bitgrid_new(map.rows, map.cols);
     for (size_t i = 0; i < map.rows; ++i) {
         for (size_t j = 0; j < map.cols; ++j) {
             size_t rating = 0;
-            scores += trailhead_score_rating(map, j, i, &rating);
+            scores += trailhead_score_rating(map, j, i, visited, &rating);
             *ratings += rating;
         }
     }
+    bitgrid_free(visited);
     return scores;
 }
@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 64
 #define DAY 11
 
 typedef struct Stone {
@@ -20,6 +19,35 @@ Stone *read_input(const char *filename);
 void free_stones(Stone *stones);
 size_t stones_after_blinking(Stone *stones, size_t blinks);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    return read_input(filename);
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Stone *stones = input;
+    snprintf(answer, ANSWER_SIZE, "%zu", stones_after_blinking(stones, 25));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Stone *stones = input;
+    snprintf(answer, ANSWER_SIZE, "%zu", stones_after_blinking(stones, 75));
+}
+
+static void free_input(void *input) {
+    Stone *stones = input;
+    hmfree(stones);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -30,6 +58,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -39,19 +68,16 @@ void test() {
 }
 
 Stone *read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
     Stone *stones = 0;
-    size_t number;
-    while (fscanf(file, "%zu", &number) == 1) {
+    View rest = file_view(file);
+    long long number;
+    while (next_number(&rest, &number)) {
         hmput(stones, number, 1);
     }
 
-    fclose(file);
+    unmap_file(file);
     return stones;
 }
 
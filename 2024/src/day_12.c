@@ -7,13 +7,14 @@
 
 #include "utils.h"
 
-#define MAX_LINE 256
 #define DAY 12
 
+// Rows point into the mapped input file and are not null-terminated
 typedef struct Garden {
     char **plants;
     size_t rows;
     size_t cols;
+    MappedFile file;
 } Garden;
 
 ptrdiff_t neighbors[4][2] = {
@@ -28,6 +29,37 @@ Garden read_input(const char *filename);
 void free_garden(Garden garden);
 size_t fencing_price(Garden garden, bool bulk_discount);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Garden *input = malloc(sizeof(Garden));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Garden garden = *(Garden *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", fencing_price(garden, false));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Garden garden = *(Garden *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", fencing_price(garden, true));
+}
+
+static void free_input(void *input) {
+    free_garden(*(Garden *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -38,6 +70,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -48,39 +81,24 @@ void test() {
 }
 
 Garden read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
-
-    Garden garden = {0};
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        char *line_end = strchr(buffer, '\n');
-        if (line_end) {
-            *line_end = '\0';
-        }
+    Garden garden = {.file = map_file(filename)};
 
+    View rest = file_view(garden.file), line;
+    while (next_line(&rest, &line)) {
         if (!garden.cols) {
-            garden.cols = strlen(buffer);
+            garden.cols = line.len;
         }
 
-        char *line = malloc(garden.cols + 1);
-        strcpy(line, buffer);
-        arrput(garden.plants, line);
+        arrput(garden.plants, line.ptr);
         ++garden.rows;
     }
 
-    fclose(file);
     return garden;
 }
 
 void free_garden(Garden garden) {
-    for (size_t i = 0; i < garden.rows; ++i) {
-        free(garden.plants[i]);
-    }
     arrfree(garden.plants);
+    unmap_file(garden.file);
 }
 
 // Returns the number of plot corners around the plant at position (x, y).
@@ -125,11 +143,11 @@ size_t plot_corners(Garden garden, size_t x, size_t y) {
 // plot containing the plant at position (x, y). We mark the visited plants to
 // avoid counting the same plot multiple times.
 void plot_dimensions(
-    Garden garden, size_t x, size_t y, bool *visited, size_t *area,
+    Garden garden, size_t x, size_t y, BitGrid visited, size_t *area,
     size_t *perimeter, size_t *sides
 ) {
     char plant = garden.plants[y][x];
-    visited[y * garden.cols + x] = true;
+    bitgrid_set(visited, x, y);
     *area += 1;
     *sides += plot_corners(garden, x, y);
 
@@ -140,7 +158,7 @@ void plot_dimensions(
         if (x_ >= garden.cols || y_ >= garden.rows
             || garden.plants[y_][x_] != plant) {
             *perimeter += 1;
-        } else if (!visited[y_ * garden.cols + x_]) {
+        } else if (!bitgrid_test(visited, x_, y_)) {
             plot_dimensions(garden, x_, y_, visited, area, perimeter, sides);
         }
     }
@@ -151,11 +169,11 @@ void plot_dimensions(
 // using the number of sides instead of the perimeter.
 size_t fencing_price(Garden garden, bool bulk_discount) {
     size_t price = 0;
-    bool *visited = calloc(garden.rows * garden.cols, sizeof(bool));
+    BitGrid visited = bitgrid_new(garden.rows, garden.cols);
 
     for (size_t y = 0; y < garden.rows; ++y) {
         for (size_t x = 0; x < garden.cols; ++x) {
-            if (visited[y * garden.cols + x]) {
+            if (bitgrid_test(visited, x, y)) {
                 continue;
             }
 
@@ -167,6 +185,6 @@ size_t fencing_price(Garden garden, bool bulk_discount) {
         }
     }
 
-    free(visited);
+    bitgrid_free(visited);
     return price;
 }
@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 64
 #define DAY 13
 
 typedef struct Location {
@@ -22,6 +21,35 @@ void test();
 Machine *read_input(const char *filename);
 size_t win_prizes(Machine *machines, size_t offset);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    return read_input(filename);
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Machine *machines = input;
+    snprintf(answer, ANSWER_SIZE, "%zu", win_prizes(machines, 0));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Machine *machines = input;
+    snprintf(answer, ANSWER_SIZE, "%zu", win_prizes(machines, 10000000000000));
+}
+
+static void free_input(void *input) {
+    Machine *machines = input;
+    arrfree(machines);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -32,6 +60,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -41,38 +70,22 @@ void test() {
 }
 
 Machine *read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
-    char buffer[MAX_LINE];
+    // Each machine is given by the six numbers of its three lines
     Machine *machines = 0;
-    while (fgets(buffer, MAX_LINE, file)) {
-        Machine machine = {0};
-
-        for (size_t i = 0; i < 3; ++i) {
-            char *x = strchr(buffer, 'X') + 2;
-            char *y = strchr(x, 'Y') + 2;
-            *(y - 4) = '\0';
-
-            Location location = {.x = atoi(x), .y = atoi(y)};
-            if (i == 0) {
-                machine.button_a = location;
-            } else if (i == 1) {
-                machine.button_b = location;
-            } else {
-                machine.prize = location;
-            }
-
-            fgets(buffer, MAX_LINE, file);
-        }
-
+    Machine machine = {0};
+    View rest = file_view(file);
+    while (next_number(&rest, &machine.button_a.x)) {
+        next_number(&rest, &machine.button_a.y);
+        next_number(&rest, &machine.button_b.x);
+        next_number(&rest, &machine.button_b.y);
+        next_number(&rest, &machine.prize.x);
+        next_number(&rest, &machine.prize.y);
         arrput(machines, machine);
     }
 
-    fclose(file);
+    unmap_file(file);
     return machines;
 }
 
@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 32
 #define DAY 14
 
 typedef struct Vector {
@@ -25,6 +24,35 @@ Robot *read_input(const char *filename);
 size_t safety_factor(Robot *robots, int seconds, int width, int height);
 size_t christmas_tree(Robot *robots, int width, int height);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    return read_input(filename);
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Robot *robots = input;
+    snprintf(answer, ANSWER_SIZE, "%zu", safety_factor(robots, 100, 101, 103));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Robot *robots = input;
+    snprintf(answer, ANSWER_SIZE, "%zu", christmas_tree(robots, 101, 103));
+}
+
+static void free_input(void *input) {
+    Robot *robots = input;
+    arrfree(robots);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -35,6 +63,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -44,33 +73,26 @@ void test() {
 }
 
 // Parses the string and saves the coordinates written after '=' to x and y.
-Vector parse_vector(char *str) {
-    char *x_str = strchr(str, '=') + 1;
-    char *y_str = strchr(x_str, ',') + 1;
-    y_str[-1] = '\0';
-    return (Vector){.x = atoi(x_str), .y = atoi(y_str)};
+Vector parse_vector(View *line) {
+    long long x, y;
+    next_number(line, &x);
+    next_number(line, &y);
+    return (Vector){.x = x, .y = y};
 }
 
 Robot *read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
-    char buffer[MAX_LINE];
     Robot *robots = 0;
-    while (fgets(buffer, MAX_LINE, file)) {
-        char *velocity = strchr(buffer, ' ') + 1;
-        velocity[-1] = '\0';
-        Robot robot = {
-            .position = parse_vector(buffer),
-            .velocity = parse_vector(velocity),
-        };
+    View rest = file_view(file), line;
+    while (next_line(&rest, &line)) {
+        Robot robot;
+        robot.position = parse_vector(&line);
+        robot.velocity = parse_vector(&line);
         arrput(robots, robot);
     }
 
-    fclose(file);
+    unmap_file(file);
     return robots;
 }
 
@@ -117,10 +139,13 @@ double entropy(size_t n, int counts[n], size_t total) {
 size_t christmas_tree(Robot *robots, int width, int height) {
     double h_x = 0;
     double h_y = 0;
+    size_t tree = -1;
 
+    Arena arena = arena_new();
     for (int seconds = 1; seconds < width * height; ++seconds) {
-        int *counts_x = calloc(width, sizeof(int));
-        int *counts_y = calloc(height, sizeof(int));
+        size_t mark = arena_mark(&arena);
+        int *counts_x = arena_calloc(&arena, width, sizeof(int));
+        int *counts_y = arena_calloc(&arena, height, sizeof(int));
         for (size_t i = 0; i < arrlenu(robots); ++i) {
             Vector position = move_robot(robots[i], seconds, width, height);
             ++counts_x[position.x];
@@ -130,17 +155,18 @@ size_t christmas_tree(Robot *robots, int width, int height) {
         // Compute entropy for each dimension
         double entropy_x = entropy(width, counts_x, arrlenu(robots));
         double entropy_y = entropy(height, counts_y, arrlenu(robots));
-        free(counts_x);
-        free(counts_y);
+        arena_reset(&arena, mark);
 
         // If entropies lowered, the robots are not scattered randomly
         if (h_x && h_y && entropy_x < 0.95 * h_x && entropy_y < 0.95 * h_y) {
-            return seconds;
+            tree = seconds;
+            break;
         }
 
         h_x = entropy_x;
         h_y = entropy_y;
     }
 
-    return -1;
+    arena_free(&arena);
+    return tree;
 }
@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 1024
 #define DAY 15
 
 typedef enum Direction { UP, DOWN, RIGHT, LEFT, DIRS } Direction;
@@ -16,12 +15,15 @@ typedef struct Location {
     size_t x, y;
 } Location;
 
+// The rows of a parsed warehouse point into its mapped input file and are not
+// null-terminated, while copies of it own their rows.
 typedef struct Warehouse {
     char **map;
     size_t rows;
     size_t cols;
     Direction *instructions;
     Location robot;
+    MappedFile file;
 } Warehouse;
 
 ptrdiff_t neighbors[4][2] = {
@@ -37,6 +39,37 @@ void free_warehouse(Warehouse warehouse);
 size_t boxes_gps(Warehouse warehouse);
 size_t boxes_gps_large(Warehouse warehouse);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Warehouse *input = malloc(sizeof(Warehouse));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Warehouse warehouse = *(Warehouse *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", boxes_gps(warehouse));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Warehouse warehouse = *(Warehouse *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", boxes_gps_large(warehouse));
+}
+
+static void free_input(void *input) {
+    free_warehouse(*(Warehouse *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -47,6 +80,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -60,43 +94,34 @@ void test() {
     free_warehouse(warehouse);
 }
 
-void parse_map(FILE *file, Warehouse *warehouse) {
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file) && strlen(buffer) > 1) {
+void parse_map(View *rest, Warehouse *warehouse) {
+    View line;
+    while (next_line(rest, &line) && line.len) {
         if (!warehouse->cols) {
-            warehouse->cols = strlen(buffer) - 1;
+            warehouse->cols = line.len;
         }
 
-        buffer[warehouse->cols] = '\0';
-        char *line = malloc(warehouse->cols + 1);
-        strcpy(line, buffer);
-        arrput(warehouse->map, line);
+        arrput(warehouse->map, line.ptr);
         ++warehouse->rows;
     }
 }
 
-void parse_instructions(FILE *file, Warehouse *warehouse) {
+void parse_instructions(View *rest, Warehouse *warehouse) {
     const char *dirs = "^v><";
-    char buffer[MAX_LINE];
 
-    while (fgets(buffer, MAX_LINE, file)) {
-        size_t len = strlen(buffer) - 1;
-        for (size_t i = 0; i < len; ++i) {
-            arrput(warehouse->instructions, strchr(dirs, buffer[i]) - dirs);
+    View line;
+    while (next_line(rest, &line)) {
+        for (size_t i = 0; i < line.len; ++i) {
+            arrput(warehouse->instructions, strchr(dirs, line.ptr[i]) - dirs);
         }
     }
 }
 
 Warehouse read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
-
-    Warehouse warehouse = {0};
-    parse_map(file, &warehouse);
-    parse_instructions(file, &warehouse);
+    Warehouse warehouse = {.file = map_file(filename)};
+    View rest = file_view(warehouse.file);
+    parse_map(&rest, &warehouse);
+    parse_instructions(&rest, &warehouse);
 
     // Find the starting position and clear it
     for (size_t i = 0; i < warehouse.rows; ++i) {
@@ -108,13 +133,16 @@ Warehouse read_input(const char *filename) {
         }
     }
 
-    fclose(file);
     return warehouse;
 }
 
 void free_warehouse(Warehouse warehouse) {
-    for (size_t i = 0; i < warehouse.rows; ++i) {
-        free(warehouse.map[i]);
+    if (warehouse.file.data) {
+        unmap_file(warehouse.file);
+    } else {
+        for (size_t i = 0; i < warehouse.rows; ++i) {
+            free(warehouse.map[i]);
+        }
     }
     arrfree(warehouse.map);
     arrfree(warehouse.instructions);
@@ -128,7 +156,8 @@ Warehouse copy_warehouse(Warehouse warehouse) {
 
     for (size_t i = 0; i < warehouse.rows; ++i) {
         char *line = malloc(warehouse.cols + 1);
-        strcpy(line, warehouse.map[i]);
+        memcpy(line, warehouse.map[i], warehouse.cols);
+        line[warehouse.cols] = '\0';
         arrput(copy.map, line);
     }
 
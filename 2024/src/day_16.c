@@ -6,32 +6,23 @@
 #include "stb_ds.h"
 
 #include "utils.h"
+#include "search.h"
+#include "instrument.h"
 
-#define MAX_LINE 256
 #define DAY 16
-#define HEAP_SIZE 10000
 
+// Rows point into the mapped input file and are not null-terminated
 typedef struct Maze {
     char **map;
     size_t rows;
     size_t cols;
+    MappedFile file;
 } Maze;
 
 typedef enum Direction { UP, DOWN, LEFT, RIGHT, NUM_DIRS } Direction;
 typedef struct Location {
     size_t x, y;
 } Location;
-typedef struct State {
-    Location loc;
-    Direction dir;
-    size_t score;
-    Location *path;
-} State;
-
-typedef struct MinHeap {
-    State data[HEAP_SIZE];
-    size_t size;
-} MinHeap;
 
 ptrdiff_t neighbors[4][2] = {
     [UP] = {0,  -1},
@@ -45,9 +36,45 @@ Maze read_input(const char *filename);
 void free_maze(Maze maze);
 size_t best_score(Maze maze, size_t *best_tiles);
 
-void enqueue(MinHeap *, Location, Direction, size_t, Location *);
-State dequeue(MinHeap *);
+#ifdef AOC_ALL
+// Both answers are computed by part 1, part 2 only reports the saved one.
+typedef struct Input {
+    Maze maze;
+    size_t best_tiles;
+} Input;
+
+static void *parse(const char *filename) {
+    Input *input = calloc(1, sizeof(Input));
+    input->maze = read_input(filename);
+    return input;
+}
+
+static void part_1(void *data, char answer[ANSWER_SIZE]) {
+    Input *input = data;
+    size_t score = best_score(input->maze, &input->best_tiles);
+    snprintf(answer, ANSWER_SIZE, "%zu", score);
+}
 
+static void part_2(void *data, char answer[ANSWER_SIZE]) {
+    Input *input = data;
+    snprintf(answer, ANSWER_SIZE, "%zu", input->best_tiles);
+}
+
+static void free_input(void *data) {
+    Input *input = data;
+    free_maze(input->maze);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = true,
+};
+#else
 int main(void) {
     test();
 
@@ -59,6 +86,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -75,111 +103,102 @@ void test() {
 }
 
 Maze read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    Maze maze = {.file = map_file(filename)};
 
-    Maze maze = {0};
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
+    View rest = file_view(maze.file), line;
+    while (next_line(&rest, &line)) {
         if (!maze.cols) {
-            maze.cols = strlen(buffer) - 1;
+            maze.cols = line.len;
         }
-        buffer[maze.cols] = '\0';
-        char *line = malloc(maze.cols + 1);
-        strcpy(line, buffer);
-        arrput(maze.map, line);
+        arrput(maze.map, line.ptr);
         ++maze.rows;
     }
 
-    fclose(file);
     return maze;
 }
 
 void free_maze(Maze maze) {
-    for (size_t i = 0; i < maze.rows; ++i) {
-        free(maze.map[i]);
-    }
     arrfree(maze.map);
+    unmap_file(maze.file);
 }
 
-// Returns a duplicate of the given array.
-Location *arr_dup(Location *arr) {
-    Location *dup = 0;
-    for (size_t i = 0; i < arrlenu(arr); ++i) {
-        arrput(dup, arr[i]);
-    }
-    return dup;
+size_t state_index(Maze maze, Location loc, Direction dir) {
+    return (loc.y * maze.cols + loc.x) * NUM_DIRS + dir;
 }
 
-void mark_tiles(Maze maze, Location *path, bool tiles[maze.rows * maze.cols]) {
-    // Mark start and end
-    tiles[(maze.rows - 2) * maze.cols + 1] = true;
-    tiles[1 * maze.cols + maze.cols - 2] = true;
-
-    for (size_t i = 0; i < arrlenu(path); ++i) {
-        Location loc = path[i];
-        tiles[loc.y * maze.cols + loc.x] = true;
+// Marks the tiles of all the states on the best paths to the given end
+// states, walking the predecessors recorded by the search back to the start.
+void mark_tiles(
+    Maze maze, Search *search, size_t *ends, bool tiles[maze.rows * maze.cols]
+) {
+    bool *seen = arena_calloc(
+        &search->arena, maze.rows * maze.cols * NUM_DIRS, sizeof(bool)
+    );
+    for (size_t i = 0; i < arena_arrlen(ends); ++i) {
+        seen[ends[i]] = true;
     }
-}
 
-size_t score_index(Maze maze, Location loc, Direction dir) {
-    return (loc.y * maze.cols + loc.x) * NUM_DIRS + dir;
-}
+    while (arena_arrlen(ends)) {
+        size_t state = arena_arrpop(ends);
+        tiles[state / NUM_DIRS] = true;
 
-bool better_score(size_t score, size_t prev_score, size_t best_score) {
-    return score < best_score && (!prev_score || prev_score > score);
+        SearchEdge *edge = search_predecessors(search, state);
+        for (; edge; edge = edge->next) {
+            if (!seen[edge->from]) {
+                seen[edge->from] = true;
+                arena_arrput(&search->arena, ends, edge->from);
+            }
+        }
+    }
 }
 
 // Finds all the best paths, marks their tiles and returns the lowest score.
+// Turning costs 1000 and a step 1, so the search uses a bucket queue.
 size_t best_path(Maze maze, bool tiles[maze.rows * maze.cols]) {
-    size_t *scores = calloc(maze.rows * maze.cols * NUM_DIRS, sizeof(size_t));
-    size_t best = -1;
+    Search search = search_new(
+        maze.rows * maze.cols * NUM_DIRS, 1000, SEARCH_PREDECESSORS
+    );
+    Location start = {1, maze.rows - 2};
+    search_push(&search, state_index(maze, start, RIGHT), 0, 0);
 
-    MinHeap *q = calloc(1, sizeof(MinHeap));
-    enqueue(q, (Location){1, maze.rows - 2}, RIGHT, 0, 0);
+    size_t best = -1;
+    size_t *ends = 0;
 
-    while (q->size) {
-        State s = dequeue(q);
-        scores[score_index(maze, s.loc, s.dir)] = s.score;
+    INSTRUMENT_REGION("day_16 best_path");
+    size_t state, score;
+    while (search_pop(&search, &state, &score) && score <= best) {
+        INSTRUMENT_COUNT("day_16 states", 1);
+        Location loc = {
+            state / NUM_DIRS % maze.cols, state / NUM_DIRS / maze.cols
+        };
+        Direction dir = state % NUM_DIRS;
 
         // If we come to the end, one of the best paths is found
-        if (maze.map[s.loc.y][s.loc.x] == 'E') {
-            mark_tiles(maze, s.path, tiles);
-            best = s.score;
-            arrfree(s.path);
+        if (maze.map[loc.y][loc.x] == 'E') {
+            arena_arrput(&search.arena, ends, state);
+            best = score;
             continue;
         }
 
         // Try rotating
         for (size_t i = 1; i < NUM_DIRS; ++i) {
-            size_t score = s.score + 1000;
-            Direction dir = (s.dir + i) % NUM_DIRS;
-            size_t prev_score = scores[score_index(maze, s.loc, dir)];
-            if (better_score(score, prev_score, best)) {
-                enqueue(q, s.loc, dir, score, arr_dup(s.path));
-            }
+            Direction turned = (dir + i) % NUM_DIRS;
+            search_push(
+                &search, state_index(maze, loc, turned), score + 1000, 0
+            );
         }
 
         // Try moving forward
-        size_t x = s.loc.x + neighbors[s.dir][0];
-        size_t y = s.loc.y + neighbors[s.dir][1];
-        Location loc = {x, y};
-        size_t score = s.score + 1;
-        size_t prev_score = scores[score_index(maze, loc, s.dir)];
-        if (maze.map[y][x] != '#' && better_score(score, prev_score, best)) {
-            Location *path = arr_dup(s.path);
-            arrput(path, loc);
-            enqueue(q, loc, s.dir, score, path);
+        size_t x = loc.x + neighbors[dir][0];
+        size_t y = loc.y + neighbors[dir][1];
+        if (maze.map[y][x] != '#') {
+            Location next = {x, y};
+            search_push(&search, state_index(maze, next, dir), score + 1, 0);
         }
-
-        arrfree(s.path);
     }
 
-    free(scores);
-    free(q);
+    mark_tiles(maze, &search, ends, tiles);
+    search_free(&search);
     return best;
 }
 
@@ -197,42 +216,3 @@ size_t best_score(Maze maze, size_t *best_tiles) {
     free(tiles);
     return score;
 }
-
-State dequeue(MinHeap *heap) {
-    State min = heap->data[0];
-    heap->data[0] = heap->data[--heap->size];
-
-    for (size_t i = 0; 2 * i + 1 < heap->size;) {
-        size_t min = 1;
-        size_t left_score = heap->data[2 * i + min].score;
-        size_t right = 2 * i + 2;
-        min += right < heap->size && heap->data[right].score < left_score;
-
-        if (heap->data[i].score <= heap->data[2 * i + min].score) {
-            break;
-        }
-
-        State tmp = heap->data[i];
-        heap->data[i] = heap->data[2 * i + min];
-        heap->data[2 * i + min] = tmp;
-        i = 2 * i + min;
-    }
-
-    return min;
-}
-
-void enqueue(
-    MinHeap *heap, Location loc, Direction dir, size_t score, Location *path
-) {
-    size_t i = heap->size++;
-    while (i > 0) {
-        size_t parent = (i - 1) / 2;
-        if (score >= heap->data[parent].score) {
-            break;
-        }
-
-        heap->data[i] = heap->data[parent];
-        i = parent;
-    }
-    heap->data[i] = (State){loc, dir, score, path};
-}
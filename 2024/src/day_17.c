@@ -6,7 +6,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 64
 #define DAY 17
 
 #define UNUSED(x) (void)(x)
@@ -25,6 +24,36 @@ Computer read_input(const char *filename);
 char *run_program(Computer computer);
 size_t output_itself(Computer computer);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Computer *input = malloc(sizeof(Computer));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    char *output = run_program(*(Computer *) input);
+    snprintf(answer, ANSWER_SIZE, "%s", output);
+    free(output);
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    snprintf(answer, ANSWER_SIZE, "%zu", output_itself(*(Computer *) input));
+}
+
+static void free_input(void *input) {
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -36,6 +65,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -53,28 +83,24 @@ void test() {
 }
 
 Computer read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
     Computer computer = {0};
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        if (strstr(buffer, "Register")) {
-            char reg = buffer[sizeof("Register")];
-            size_t val = atoi(buffer + sizeof("Register A:"));
-            computer.registers[reg - 'A'] = val;
-        } else if (strlen(buffer) > 1) {
-            char *program = buffer + strlen("Program: ");
-            for (char *t = strtok(program, ","); t; t = strtok(0, ",")) {
-                computer.program[computer.instructions++] = atoi(t);
+    View rest = file_view(file), line;
+    while (next_line(&rest, &line)) {
+        long long value;
+        if (line.len > sizeof("Register") && line.ptr[0] == 'R') {
+            char reg = line.ptr[sizeof("Register")];
+            next_number(&line, &value);
+            computer.registers[reg - 'A'] = value;
+        } else {
+            while (next_number(&line, &value)) {
+                computer.program[computer.instructions++] = value;
             }
         }
     }
 
-    fclose(file);
+    unmap_file(file);
     return computer;
 }
 
@@ -6,8 +6,8 @@
 #include "stb_ds.h"
 
 #include "utils.h"
+#include "search.h"
 
-#define MAX_LINE 16
 #define DAY 18
 
 #define SMALL_GRID_SIZE 7
@@ -17,11 +17,6 @@ typedef struct Position {
     size_t x, y;
 } Position;
 
-typedef struct State {
-    Position pos;
-    size_t steps;
-} State;
-
 ptrdiff_t neighbors[4][2] = {
     {0,  -1},
     {0,  1 },
@@ -34,6 +29,35 @@ Position *read_input(const char *filename);
 size_t steps_to_exit(Position *positions, size_t bytes, size_t grid_size);
 Position unreachable_byte(Position *positions, size_t grid_size);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    return read_input(filename);
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    size_t steps = steps_to_exit(input, 1024, GRID_SIZE);
+    snprintf(answer, ANSWER_SIZE, "%zu", steps);
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Position unreachable = unreachable_byte(input, GRID_SIZE);
+    snprintf(answer, ANSWER_SIZE, "%zu,%zu", unreachable.x, unreachable.y);
+}
+
+static void free_input(void *input) {
+    Position *positions = input;
+    arrfree(positions);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -45,6 +69,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -57,83 +82,56 @@ void test() {
 }
 
 Position *read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
     Position *positions = 0;
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        Position position;
-        sscanf(buffer, "%zu,%zu", &position.x, &position.y);
+    View rest = file_view(file);
+    long long x, y;
+    while (next_number(&rest, &x) && next_number(&rest, &y)) {
+        Position position = {x, y};
         arrput(positions, position);
     }
 
-    fclose(file);
+    unmap_file(file);
     return positions;
 }
 
 // Creates a 2D grid and drops the bytes number of bytes in positions on it.
-bool **drop_bytes(Position *positions, size_t bytes, size_t grid_size) {
-    bool **grid = malloc(grid_size * sizeof(bool *));
-    for (size_t i = 0; i < grid_size; ++i) {
-        grid[i] = calloc(grid_size, sizeof(bool));
-    }
-
+BitGrid drop_bytes(Position *positions, size_t bytes, size_t grid_size) {
+    BitGrid grid = bitgrid_new(grid_size, grid_size);
     for (size_t i = 0; i < bytes; ++i) {
-        grid[positions[i].y][positions[i].x] = true;
+        bitgrid_set(grid, positions[i].x, positions[i].y);
     }
-
     return grid;
 }
 
-void free_grid(size_t grid_size, bool **grid) {
-    for (size_t i = 0; i < grid_size; ++i) {
-        free(grid[i]);
-    }
-    free(grid);
-}
-
-// Returns the number of steps required to exit the grid.
+// Returns the number of steps required to exit the grid. States are the
+// cells in row-major order, and with steps of 1 the search is a breadth-first
+// search over a bucket queue of two buckets.
 size_t steps_to_exit(Position *positions, size_t bytes, size_t grid_size) {
-    bool **grid = drop_bytes(positions, bytes, grid_size);
-    bool **visited = drop_bytes(positions, 0, grid_size);
-
-    State *q = 0;
-    State start = {0};
-    visited[start.pos.y][start.pos.x] = true;
-    arrput(q, start);
-
-    size_t steps = -1;
-    while (arrlenu(q) && steps == SIZE_MAX) {
-        State s = q[0];
-        arrdel(q, 0);
+    BitGrid grid = drop_bytes(positions, bytes, grid_size);
+    Search search = search_new(grid_size * grid_size, 1, 0);
+    search_push(&search, 0, 0, 0);
+
+    size_t goal = grid_size * grid_size - 1;
+    size_t state, cost, steps = -1;
+    while (search_pop(&search, &state, &cost)) {
+        if (state == goal) {
+            steps = cost;
+            break;
+        }
 
         for (size_t i = 0; i < 4; ++i) {
-            size_t x = s.pos.x + neighbors[i][0];
-            size_t y = s.pos.y + neighbors[i][1];
-            if (x >= grid_size || y >= grid_size || grid[y][x]
-                || visited[y][x]) {
-                continue;
-            } else if (x == grid_size - 1 && y == grid_size - 1) {
-                steps = s.steps + 1;
-                break;
+            size_t x = state % grid_size + neighbors[i][0];
+            size_t y = state / grid_size + neighbors[i][1];
+            if (x < grid_size && y < grid_size && !bitgrid_test(grid, x, y)) {
+                search_push(&search, y * grid_size + x, cost + 1, 0);
             }
-
-            State next = {
-                {x, y},
-                s.steps + 1
-            };
-            arrput(q, next);
-            visited[y][x] = true;
         }
     }
 
-    arrfree(q);
-    free_grid(grid_size, grid);
-    free_grid(grid_size, visited);
+    search_free(&search);
+    bitgrid_free(grid);
     return steps;
 }
 
@@ -7,9 +7,9 @@
 
 #include "utils.h"
 
-#define MAX_LINE 4096
 #define DAY 19
 
+// Designs are null-terminated in place in the mapped input file
 typedef struct Towels {
     struct {
         char *key;
@@ -17,6 +17,7 @@ typedef struct Towels {
     } *towels;
     char **designs;
     size_t longest_towel;
+    MappedFile file;
 } Towels;
 
 void test();
@@ -24,6 +25,37 @@ Towels read_input(const char *filename);
 void free_towels(Towels towels);
 size_t possible_designs(Towels towels, bool count_ways);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Towels *input = malloc(sizeof(Towels));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Towels towels = *(Towels *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", possible_designs(towels, false));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Towels towels = *(Towels *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", possible_designs(towels, true));
+}
+
+static void free_input(void *input) {
+    free_towels(*(Towels *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = true,
+};
+#else
 int main(void) {
     test();
 
@@ -34,6 +66,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -44,49 +77,34 @@ void test() {
 }
 
 Towels read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
-
-    Towels towels = {0};
+    Towels towels = {.file = map_file(filename)};
     sh_new_strdup(towels.towels);
 
-    char buffer[MAX_LINE];
+    View rest = file_view(towels.file), line, token;
 
     // Read towels
-    fgets(buffer, MAX_LINE, file);
-    buffer[strlen(buffer) - 1] = '\0';
-    for (char *token = strtok(buffer, ", "); token; token = strtok(0, ", ")) {
-        shput(towels.towels, token, 0);
-        size_t len = strlen(token);
-        if (len > towels.longest_towel) {
-            towels.longest_towel = len;
+    next_line(&rest, &line);
+    while (next_token(&line, ", ", &token)) {
+        shput(towels.towels, view_str(token), 0);
+        if (token.len > towels.longest_towel) {
+            towels.longest_towel = token.len;
         }
     }
 
     // Read designs
-    while (fgets(buffer, MAX_LINE, file)) {
-        size_t len = strlen(buffer);
-        if (len > 1) {
-            buffer[len - 1] = '\0';
-            char *design = malloc(len);
-            strcpy(design, buffer);
-            arrput(towels.designs, design);
+    while (next_line(&rest, &line)) {
+        if (line.len) {
+            arrput(towels.designs, view_str(line));
         }
     }
 
-    fclose(file);
     return towels;
 }
 
 void free_towels(Towels towels) {
     shfree(towels.towels);
-    for (size_t i = 0; i < arrlenu(towels.designs); ++i) {
-        free(towels.designs[i]);
-    }
     arrfree(towels.designs);
+    unmap_file(towels.file);
 }
 
 // Returns the number of towel combinations that form the given design.
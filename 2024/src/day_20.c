@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 256
 #define DAY 20
 
 typedef struct Position {
@@ -15,6 +14,14 @@ typedef struct Position {
     size_t y;
 } Position;
 
+// Rows point into the mapped input file and are not null-terminated
+typedef struct Racetrack {
+    char **map;
+    size_t rows;
+    size_t cols;
+    MappedFile file;
+} Racetrack;
+
 ptrdiff_t neighbors[4][2] = {
     {0,  -1},
     {1,  0 },
@@ -23,24 +30,56 @@ ptrdiff_t neighbors[4][2] = {
 };
 
 void test();
-char **read_input(const char *filename);
-void free_racetrack(char **racetrack);
-size_t good_cheats(char **racetrack, size_t duration, size_t saving);
+Racetrack read_input(const char *filename);
+void free_racetrack(Racetrack racetrack);
+size_t good_cheats(Racetrack racetrack, size_t duration, size_t saving);
+
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Racetrack *input = malloc(sizeof(Racetrack));
+    *input = read_input(filename);
+    return input;
+}
 
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Racetrack racetrack = *(Racetrack *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", good_cheats(racetrack, 2, 100));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Racetrack racetrack = *(Racetrack *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", good_cheats(racetrack, 20, 100));
+}
+
+static void free_input(void *input) {
+    free_racetrack(*(Racetrack *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
-    char **racetrack = read_input("inputs/day_" STR(DAY) ".txt");
+    Racetrack racetrack = read_input("inputs/day_" STR(DAY) ".txt");
     printf("%zu\n", good_cheats(racetrack, 2, 100));
     printf("%zu\n", good_cheats(racetrack, 20, 100));
     free_racetrack(racetrack);
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
-    char **racetrack = read_input("inputs/day_" STR(DAY) "_test.txt");
+    Racetrack racetrack = read_input("inputs/day_" STR(DAY) "_test.txt");
     assert_eq(good_cheats(racetrack, 2, 64), 1);
     assert_eq(good_cheats(racetrack, 2, 40), 2);
     assert_eq(good_cheats(racetrack, 2, 20), 5);
@@ -55,32 +94,22 @@ void test() {
     free_racetrack(racetrack);
 }
 
-char **read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+Racetrack read_input(const char *filename) {
+    Racetrack racetrack = {.file = map_file(filename)};
 
-    char **racetrack = 0;
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        size_t len = strlen(buffer);
-        buffer[len - 1] = '\0';
-        char *line = malloc(len);
-        strcpy(line, buffer);
-        arrput(racetrack, line);
+    View rest = file_view(racetrack.file), line;
+    while (next_line(&rest, &line)) {
+        arrput(racetrack.map, line.ptr);
+        ++racetrack.rows;
+        racetrack.cols = line.len;
     }
 
-    fclose(file);
     return racetrack;
 }
 
-void free_racetrack(char **racetrack) {
-    for (size_t i = 0; i < arrlenu(racetrack); ++i) {
-        free(racetrack[i]);
-    }
-    arrfree(racetrack);
+void free_racetrack(Racetrack racetrack) {
+    arrfree(racetrack.map);
+    unmap_file(racetrack.file);
 }
 
 size_t **init_times(size_t rows, size_t cols) {
@@ -101,22 +130,12 @@ void free_times(size_t rows, size_t **times) {
     free(times);
 }
 
-bool **init_visited(size_t rows, size_t cols, Position start) {
-    bool **visited = malloc(rows * sizeof(bool *));
-    for (size_t i = 0; i < rows; ++i) {
-        visited[i] = calloc(cols, sizeof(bool));
-    }
-    visited[start.y][start.x] = true;
+BitGrid init_visited(Arena *arena, size_t rows, size_t cols, Position start) {
+    BitGrid visited = bitgrid_arena(arena, rows, cols);
+    bitgrid_set(visited, start.x, start.y);
     return visited;
 }
 
-void free_visited(size_t rows, bool **visited) {
-    for (size_t i = 0; i < rows; ++i) {
-        free(visited[i]);
-    }
-    free(visited);
-}
-
 // Returns the position of the first occurrence of c in racetrack.
 Position find_position(size_t rows, size_t cols, char **racetrack, char c) {
     for (size_t i = 0; i < rows; ++i) {
@@ -159,27 +178,29 @@ void find_path(size_t rows, size_t cols, char **racetrack, size_t **times) {
 }
 
 // Returns the number of cheats starting from the given position that last
-// at most duration picoseconds and save at least saving picoseconds.
+// at most duration picoseconds and save at least saving picoseconds. The
+// scratch memory is released on return.
 size_t num_cheats(
     Position start, size_t rows, size_t cols, size_t **times, size_t duration,
-    size_t saving
+    size_t saving, Arena *arena
 ) {
     typedef struct State {
         Position pos;
         size_t steps;
     } State;
 
-    bool **visited = init_visited(rows, cols, start);
+    size_t mark = arena_mark(arena);
+    BitGrid visited = init_visited(arena, rows, cols, start);
     size_t time = times[start.y][start.x];
 
+    // The queue is never shrunk, states are taken from its head instead
     State *q = 0;
     State state = {start, 0};
-    arrput(q, state);
+    arena_arrput(arena, q, state);
 
     size_t cheats = 0;
-    while (arrlenu(q)) {
-        State s = q[0];
-        arrdel(q, 0);
+    for (size_t head = 0; head < arena_arrlen(q); ++head) {
+        State s = q[head];
 
         size_t t = times[s.pos.y][s.pos.x];
         // Found a non-wall position different from the starting one
@@ -197,33 +218,37 @@ size_t num_cheats(
             Position pos = {
                 .x = s.pos.x + neighbors[i][0], .y = s.pos.y + neighbors[i][1]
             };
-            if (pos.y < rows && pos.x < cols && !visited[pos.y][pos.x]) {
-                visited[pos.y][pos.x] = true;
+            if (pos.y < rows && pos.x < cols
+                && !bitgrid_test_and_set(visited, pos.x, pos.y)) {
                 State next = {pos, s.steps + 1};
-                arrput(q, next);
+                arena_arrput(arena, q, next);
             }
         }
     }
 
-    free_visited(rows, visited);
+    arena_reset(arena, mark);
     return cheats;
 }
 
 // Returns the number of cheats that last at most duration picoseconds and
 // save at least saving picoseconds.
-size_t good_cheats(char **racetrack, size_t duration, size_t saving) {
-    size_t rows = arrlen(racetrack);
-    size_t cols = strlen(racetrack[0]);
+size_t good_cheats(Racetrack racetrack, size_t duration, size_t saving) {
+    size_t rows = racetrack.rows;
+    size_t cols = racetrack.cols;
     size_t **times = init_times(rows, cols);
-    find_path(rows, cols, racetrack, times);
+    find_path(rows, cols, racetrack.map, times);
 
     size_t cheats = 0;
-    Position pos = find_position(rows, cols, racetrack, 'S');
+    Arena arena = arena_new();
+    Position pos = find_position(rows, cols, racetrack.map, 'S');
     while (times[pos.y][pos.x] != 0) {
-        cheats += num_cheats(pos, rows, cols, times, duration, saving);
-        pos = next_position(racetrack, times, pos, false);
+        cheats += num_cheats(
+            pos, rows, cols, times, duration, saving, &arena
+        );
+        pos = next_position(racetrack.map, times, pos, false);
     }
 
+    arena_free(&arena);
     free_times(rows, times);
     return cheats;
 }
@@ -8,7 +8,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 8
 #define DAY 21
 #define CODES 5
 #define CODE_LENGTH 4
@@ -23,6 +22,12 @@ typedef struct Position {
     size_t y;
 } Position;
 
+// Codes point into the mapped input file and are not null-terminated
+typedef struct Codes {
+    char *code[CODES];
+    MappedFile file;
+} Codes;
+
 char keypads[6][4] = {
     {'7', '8', '9'},
     {'4', '5', '6'},
@@ -33,55 +38,74 @@ char keypads[6][4] = {
 };
 
 void test();
-char **read_input(const char *filename);
-void free_codes(char **codes);
+Codes read_input(const char *filename);
+void free_codes(Codes codes);
 Position keypad_position(char button, bool numeric);
-size_t complexities_sum(char **codes, size_t keypads);
+size_t complexities_sum(Codes codes, size_t keypads);
+
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Codes *input = malloc(sizeof(Codes));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    Codes codes = *(Codes *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", complexities_sum(codes, 2));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    Codes codes = *(Codes *) input;
+    snprintf(answer, ANSWER_SIZE, "%zu", complexities_sum(codes, 25));
+}
 
+static void free_input(void *input) {
+    free_codes(*(Codes *) input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
-    char **codes = read_input("inputs/day_" STR(DAY) ".txt");
+    Codes codes = read_input("inputs/day_" STR(DAY) ".txt");
     printf("%zu\n", complexities_sum(codes, 2));
     printf("%zu\n", complexities_sum(codes, 25));
     free_codes(codes);
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
-    char **codes = read_input("inputs/day_" STR(DAY) "_test.txt");
+    Codes codes = read_input("inputs/day_" STR(DAY) "_test.txt");
     assert_eq(complexities_sum(codes, 2), 126384);
     free_codes(codes);
 }
 
-char **read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
-
-    char buffer[MAX_LINE];
-    char **codes = malloc(CODES * sizeof(char *));
+Codes read_input(const char *filename) {
+    Codes codes = {.file = map_file(filename)};
 
-    size_t i = 0;
-    while (fgets(buffer, MAX_LINE, file)) {
-        codes[i] = malloc(CODE_LENGTH * sizeof(char));
-        memcpy(codes[i], buffer, CODE_LENGTH);
-        ++i;
+    View rest = file_view(codes.file), line;
+    for (size_t i = 0; i < CODES && next_line(&rest, &line); ++i) {
+        codes.code[i] = line.ptr;
     }
 
-    fclose(file);
     return codes;
 }
 
-void free_codes(char **codes) {
-    for (size_t i = 0; i < CODES; i++) {
-        free(codes[i]);
-    }
-    free(codes);
+void free_codes(Codes codes) {
+    unmap_file(codes.file);
 }
 
 void free_presses(char **presses) {
@@ -218,12 +242,12 @@ size_t code_value(char code[CODE_LENGTH]) {
 
 // Returns the sum of complexities of all codes. Each code value is multiplied
 // by the number of keypresses needed on the keypads-th directional keypad.
-size_t complexities_sum(char **codes, size_t keypads) {
+size_t complexities_sum(Codes codes, size_t keypads) {
     size_t complexities = 0;
     Memory *memo = 0;
 
     for (size_t i = 0; i < CODES; ++i) {
-        char *code = codes[i];
+        char *code = codes.code[i];
         size_t length = 0;
 
         for (size_t j = 0; j < CODE_LENGTH; ++j) {
@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 16
 #define DAY 22
 
 typedef struct KeyVal {
@@ -22,6 +21,35 @@ size_t buyers_secret_numbers(size_t *secrets);
 size_t buy_bananas(size_t *secrets);
 size_t seq_to_num(int sequence[4]);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    return read_input(filename);
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    size_t *secrets = input;
+    snprintf(answer, ANSWER_SIZE, "%zu", buyers_secret_numbers(secrets));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    size_t *secrets = input;
+    snprintf(answer, ANSWER_SIZE, "%zu", buy_bananas(secrets));
+}
+
+static void free_input(void *input) {
+    size_t *secrets = input;
+    arrfree(secrets);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -32,6 +60,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -51,19 +80,16 @@ void test() {
 }
 
 size_t *read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
-    char buffer[MAX_LINE];
     size_t *numbers = 0;
-    while (fgets(buffer, MAX_LINE, file)) {
-        arrput(numbers, strtoul(buffer, 0, 10));
+    View rest = file_view(file);
+    long long number;
+    while (next_number(&rest, &number)) {
+        arrput(numbers, number);
     }
 
-    fclose(file);
+    unmap_file(file);
     return numbers;
 }
 
@@ -7,7 +7,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 8
 #define DAY 23
 
 typedef struct Connection {
@@ -26,6 +25,34 @@ void free_computers(Computer *computers);
 size_t connected_computers(Computer *computers);
 char *party_password(Computer *computers);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    return read_input(filename);
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    snprintf(answer, ANSWER_SIZE, "%zu", connected_computers(input));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    char *password = party_password(input);
+    snprintf(answer, ANSWER_SIZE, "%s", password);
+    free(password);
+}
+
+static void free_input(void *input) {
+    free_computers(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = true,
+};
+#else
 int main(void) {
     test();
 
@@ -38,6 +65,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -70,24 +98,20 @@ void add_connection(Computer **computers, char a[3], char b[3]) {
 }
 
 Computer *read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
-    char buffer[MAX_LINE];
     Computer *computers = 0;
     sh_new_strdup(computers);
-    while (fgets(buffer, MAX_LINE, file)) {
-        *(strchr(buffer, '\n')) = '\0';
-        *(strchr(buffer, '-')) = '\0';
-        add_connection(&computers, buffer, buffer + 3);
+    View rest = file_view(file), line, a, b;
+    while (next_line(&rest, &line)) {
+        next_token(&line, "-", &a);
+        next_token(&line, "-", &b);
+        add_connection(&computers, view_str(a), view_str(b));
     }
 
     qsort(computers, shlenu(computers), sizeof(*computers), cmp_computers);
 
-    fclose(file);
+    unmap_file(file);
     return computers;
 }
 
@@ -7,10 +7,13 @@
 #include "stb_ds.h"
 
 #include "utils.h"
+#include "cache.h"
 
-#define MAX_LINE 32
 #define DAY 24
 
+// Version of what the cache holds for this day
+#define CACHE_LAYOUT 1
+
 typedef enum Operation { AND, OR, XOR } Operation;
 
 typedef struct Wire {
@@ -38,6 +41,37 @@ void free_device(Device *device);
 size_t system_output(Device *device);
 char *swapped_gates(Device *device);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Device *input = malloc(sizeof(Device));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    snprintf(answer, ANSWER_SIZE, "%zu", system_output(input));
+}
+
+static void part_2(void *input, char answer[ANSWER_SIZE]) {
+    char *swaps = swapped_gates(input);
+    snprintf(answer, ANSWER_SIZE, "%s", swaps);
+    free(swaps);
+}
+
+static void free_input(void *input) {
+    free_device(input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = part_2,
+    .free = free_input,
+    .sequential = true,
+};
+#else
 int main(void) {
     test();
 
@@ -50,6 +84,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -66,13 +101,12 @@ size_t static inline wire_key(char wire[3]) {
     return (wire[0] * 1000 + wire[1]) * 1000 + wire[2];
 }
 
-Wire *parse_wires(FILE *file) {
+Wire *parse_wires(View *rest) {
     Wire *wires = 0;
 
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file) && strlen(buffer) > 1) {
-        char *value = strchr(buffer, ' ') + 1;
-        hmput(wires, wire_key(buffer), atoi(value));
+    View line;
+    while (next_line(rest, &line) && line.len) {
+        hmput(wires, wire_key(line.ptr), line.ptr[line.len - 1] == '1');
     }
 
     return wires;
@@ -89,40 +123,89 @@ Connection create_connection(char *op, char *out, char *lhs, char *rhs) {
     return connection;
 }
 
-Connection *parse_connections(FILE *file, Device *device) {
+Connection *parse_connections(View *rest, Device *device) {
     Connection *connections = 0;
 
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        char *out = strchr(buffer, '>') + 2;
-        char *op = buffer + 4;
-        out[3] = '\0';
-
-        char *rhs = strchr(op, ' ') + 1;
-        rhs[3] = '\0';
-        rhs[-1] = '\0';
-        buffer[3] = '\0';
-
-        Connection connection = create_connection(op, out, buffer, rhs);
+    // Each line is of the form "lhs op rhs -> out"
+    View line, lhs, op, rhs, arrow, out;
+    while (next_line(rest, &line)) {
+        next_token(&line, " ", &lhs);
+        next_token(&line, " ", &op);
+        next_token(&line, " ", &rhs);
+        next_token(&line, " ", &arrow);
+        next_token(&line, " ", &out);
+
+        Connection connection = create_connection(
+            view_str(op), view_str(out), view_str(lhs), view_str(rhs)
+        );
         hmputs(connections, connection);
-        device->out_wires += out[0] == 'z';
+        device->out_wires += out.ptr[0] == 'z';
     }
 
     return connections;
 }
 
-Device read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
+Device parse_input(const char *filename) {
+    MappedFile file = map_file(filename);
+    View rest = file_view(file);
+
+    Device device = {0};
+    device.wires = parse_wires(&rest);
+    device.connections = parse_connections(&rest, &device);
+
+    unmap_file(file);
+    return device;
+}
+
+// Saves the number of output wires followed by the counts and entries of the
+// wire and connection maps.
+void save_device(Cache *cache, Device *device) {
+    size_t counts[3] = {
+        device->out_wires, hmlenu(device->wires), hmlenu(device->connections)
+    };
+    cache_write(cache, counts, sizeof(counts));
+    cache_write(cache, device->wires, counts[1] * sizeof(Wire));
+    cache_write(cache, device->connections, counts[2] * sizeof(Connection));
+}
+
+// Rebuilds the maps of the device from the cache. Returns false, with an
+// empty device, if the cache cannot be read.
+bool load_device(Cache *cache, Device *device) {
+    const size_t *counts = cache_read(cache, 3 * sizeof(size_t));
+    if (!counts) {
+        return false;
+    }
+
+    const Wire *wires = cache_read(cache, counts[1] * sizeof(Wire));
+    const Connection *connections = cache_read(
+        cache, counts[2] * sizeof(Connection)
+    );
+    if (!wires || !connections) {
+        return false;
     }
 
+    *device = (Device){.out_wires = counts[0]};
+    for (size_t i = 0; i < counts[1]; ++i) {
+        hmputs(device->wires, wires[i]);
+    }
+    for (size_t i = 0; i < counts[2]; ++i) {
+        hmputs(device->connections, connections[i]);
+    }
+    return true;
+}
+
+// Reads the device from the cache if it was saved for this input before,
+// otherwise parses the input and saves it.
+Device read_input(const char *filename) {
+    Cache cache = cache_open(STR(DAY), CACHE_LAYOUT, filename);
+
     Device device = {0};
-    device.wires = parse_wires(file);
-    device.connections = parse_connections(file, &device);
+    if (!load_device(&cache, &device)) {
+        device = parse_input(filename);
+        save_device(&cache, &device);
+    }
 
-    fclose(file);
+    cache_close(&cache);
     return device;
 }
 
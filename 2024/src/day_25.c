@@ -8,7 +8,6 @@
 
 #include "utils.h"
 
-#define MAX_LINE 8
 #define DAY 25
 
 #define COLUMNS 5
@@ -23,6 +22,31 @@ Schematics read_input(const char *filename);
 void free_schematics(Schematics *schematics);
 size_t lock_key_pairs(Schematics schematics);
 
+#ifdef AOC_ALL
+static void *parse(const char *filename) {
+    Schematics *input = malloc(sizeof(Schematics));
+    *input = read_input(filename);
+    return input;
+}
+
+static void part_1(void *input, char answer[ANSWER_SIZE]) {
+    snprintf(answer, ANSWER_SIZE, "%zu", lock_key_pairs(*(Schematics *) input));
+}
+
+static void free_input(void *input) {
+    free_schematics(input);
+    free(input);
+}
+
+const Solution SOLUTION(DAY) = {
+    .day = STR(DAY),
+    .parse = parse,
+    .part_1 = part_1,
+    .part_2 = 0,
+    .free = free_input,
+    .sequential = false,
+};
+#else
 int main(void) {
     test();
 
@@ -32,6 +56,7 @@ int main(void) {
 
     return EXIT_SUCCESS;
 }
+#endif
 
 // Tests for the included examples.
 void test() {
@@ -40,14 +65,15 @@ void test() {
     free_schematics(&schematics);
 }
 
-size_t parse_schematic(FILE *file) {
-    char buffer[MAX_LINE];
+size_t parse_schematic(View *rest) {
+    View line;
 
     // Each column of lock/key is repesented by a decimal digit.
     size_t schematic = 100000;
-    while (fgets(buffer, MAX_LINE, file) && strlen(buffer) > 1) {
+    while (next_line(rest, &line) && line.len) {
         for (size_t i = 0; i < COLUMNS; ++i) {
-            schematic += (buffer[i] == '#') * (size_t) pow(10, COLUMNS - 1 - i);
+            size_t digit = pow(10, COLUMNS - 1 - i);
+            schematic += (line.ptr[i] == '#') * digit;
         }
     }
 
@@ -55,17 +81,13 @@ size_t parse_schematic(FILE *file) {
 }
 
 Schematics read_input(const char *filename) {
-    FILE *file = fopen(filename, "rt");
-    if (!file) {
-        perror(filename);
-        exit(EXIT_FAILURE);
-    }
+    MappedFile file = map_file(filename);
 
     Schematics schematics = {0};
-    char buffer[MAX_LINE];
-    while (fgets(buffer, MAX_LINE, file)) {
-        bool is_lock = buffer[0] == '#';
-        size_t schematic = parse_schematic(file);
+    View rest = file_view(file), line;
+    while (next_line(&rest, &line)) {
+        bool is_lock = line.ptr[0] == '#';
+        size_t schematic = parse_schematic(&rest);
         if (is_lock) {
             arrput(schematics.locks, schematic);
         } else {
@@ -75,7 +97,7 @@ Schematics read_input(const char *filename) {
         }
     }
 
-    fclose(file);
+    unmap_file(file);
     return schematics;
 }
 
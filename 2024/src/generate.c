@@ -0,0 +1,1044 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define STB_DS_IMPLEMENTATION
+#include "stb_ds.h"
+
+#include "utils.h"
+
+// Generator of synthetic inputs for stress benchmarks. It writes a valid input
+// of the given day at the given scale to the standard output:
+//
+//     ./generate <day> [scale] [seed] > large/day_09.txt
+//     ./aoc_all -i large 9
+//
+// The meaning of the scale depends on the day (number of lines, side of a
+// grid, ...) and its default is roughly the size of the puzzle input. Some
+// solutions hardcode the size of their input, and their generators ignore the
+// scale. Every day has a smallest scale that still gives a valid input, at
+// least 1. The same seed always gives the same input.
+
+#define DAYS 25
+
+typedef struct Random {
+    uint64_t state;
+} Random;
+
+typedef struct Generator {
+    void (*generate)(size_t scale, Random *rng);
+    size_t scale;
+    size_t min_scale;
+} Generator;
+
+const ptrdiff_t neighbors[4][2] = {
+    {0,  -1},
+    {1,  0 },
+    {0,  1 },
+    {-1, 0 },
+};
+
+// SplitMix64, good enough for random inputs and the same on every platform
+uint64_t next_random(Random *rng) {
+    uint64_t z = (rng->state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+// Returns a random number from [lo, hi]
+long long uniform(Random *rng, long long lo, long long hi) {
+    return lo + (long long) (next_random(rng) % (uint64_t) (hi - lo + 1));
+}
+
+bool coin(Random *rng, double probability) {
+    return (next_random(rng) >> 11) * 0x1.0p-53 < probability;
+}
+
+void shuffle(void *items, size_t count, size_t size, Random *rng) {
+    char *bytes = items;
+    char tmp[64];
+    for (size_t i = count; i > 1; --i) {
+        size_t j = uniform(rng, 0, i - 1);
+        memcpy(tmp, bytes + (i - 1) * size, size);
+        memcpy(bytes + (i - 1) * size, bytes + j * size, size);
+        memcpy(bytes + j * size, tmp, size);
+    }
+}
+
+// Returns a square grid of the given side filled with c, as rows of a single
+// allocation
+char **new_grid(size_t side, char c) {
+    char **grid = malloc(side * sizeof(char *));
+    char *cells = malloc(side * side);
+    memset(cells, c, side * side);
+    for (size_t i = 0; i < side; ++i) {
+        grid[i] = cells + i * side;
+    }
+    return grid;
+}
+
+void print_grid(char **grid, size_t side) {
+    for (size_t i = 0; i < side; ++i) {
+        fwrite(grid[i], 1, side, stdout);
+        putchar('\n');
+    }
+}
+
+void free_grid(char **grid) {
+    free(grid[0]);
+    free(grid);
+}
+
+// Assigns every cell of the grid to one of the randomly placed seeds by a
+// breadth-first search from all of them at once. Returns the seed index of
+// each cell and stores the distance to it in distances.
+size_t *grow_regions(
+    size_t side, size_t seeds, Random *rng, size_t **distances
+) {
+    size_t cells = side * side;
+    size_t *region = malloc(cells * sizeof(size_t));
+    *distances = malloc(cells * sizeof(size_t));
+    memset(region, 0xff, cells * sizeof(size_t));
+
+    size_t *queue = 0;
+    for (size_t i = 0; i < seeds; ++i) {
+        size_t cell = uniform(rng, 0, cells - 1);
+        if (region[cell] == SIZE_MAX) {
+            region[cell] = i;
+            (*distances)[cell] = 0;
+            arrput(queue, cell);
+        }
+    }
+
+    for (size_t i = 0; i < arrlenu(queue); ++i) {
+        size_t y = queue[i] / side, x = queue[i] % side;
+        for (size_t k = 0; k < 4; ++k) {
+            size_t y_ = y + neighbors[k][1], x_ = x + neighbors[k][0];
+            size_t next = y_ * side + x_;
+            if (y_ < side && x_ < side && region[next] == SIZE_MAX) {
+                region[next] = region[queue[i]];
+                (*distances)[next] = (*distances)[queue[i]] + 1;
+                arrput(queue, next);
+            }
+        }
+    }
+
+    arrfree(queue);
+    return region;
+}
+
+// Carves a random perfect maze into a grid of walls with an odd side. The
+// passages connect the cells with odd coordinates. Returns the parent of
+// each passage cell in the tree of passages rooted at (x, y).
+size_t *carve_maze(char **grid, size_t side, size_t x, size_t y, Random *rng) {
+    size_t *parent = malloc(side * side * sizeof(size_t));
+    size_t *stack = 0;
+    grid[y][x] = '.';
+    parent[y * side + x] = SIZE_MAX;
+    arrput(stack, y * side + x);
+
+    while (arrlenu(stack)) {
+        size_t cell = stack[arrlenu(stack) - 1];
+        y = cell / side;
+        x = cell % side;
+
+        size_t directions[4] = {0, 1, 2, 3};
+        shuffle(directions, 4, sizeof(size_t), rng);
+
+        bool carved = false;
+        for (size_t i = 0; i < 4 && !carved; ++i) {
+            size_t x_ = x + 2 * neighbors[directions[i]][0];
+            size_t y_ = y + 2 * neighbors[directions[i]][1];
+            if (x_ >= side - 1 || y_ >= side - 1 || grid[y_][x_] == '.') {
+                continue;
+            }
+
+            size_t wall = (y + y_) / 2 * side + (x + x_) / 2;
+            grid[(y + y_) / 2][(x + x_) / 2] = '.';
+            grid[y_][x_] = '.';
+            parent[wall] = cell;
+            parent[y_ * side + x_] = wall;
+            arrput(stack, y_ * side + x_);
+            carved = true;
+        }
+
+        if (!carved) {
+            arrpop(stack);
+        }
+    }
+
+    arrfree(stack);
+    return parent;
+}
+
+// Two location lists where part of the right list repeats the left one
+void generate_01(size_t scale, Random *rng) {
+    long long *left = malloc(scale * sizeof(long long));
+    for (size_t i = 0; i < scale; ++i) {
+        left[i] = uniform(rng, 10000, 99999);
+    }
+    for (size_t i = 0; i < scale; ++i) {
+        long long right = coin(rng, 0.5) ? left[uniform(rng, 0, scale - 1)]
+                                         : uniform(rng, 10000, 99999);
+        printf("%lld   %lld\n", left[i], right);
+    }
+    free(left);
+}
+
+// Mostly monotonic reports, some of them with a single bad level
+void generate_02(size_t scale, Random *rng) {
+    for (size_t i = 0; i < scale; ++i) {
+        long long levels = uniform(rng, 5, 8);
+        long long level = uniform(rng, 30, 70);
+        long long direction = coin(rng, 0.5) ? 1 : -1;
+        long long bad = coin(rng, 0.5) ? uniform(rng, 0, levels - 1) : -1;
+
+        for (long long j = 0; j < levels; ++j) {
+            long long step = j == bad ? uniform(rng, -3, 5)
+                                      : uniform(rng, 1, 3);
+            level += j ? direction * step : 0;
+            printf(j ? " %lld" : "%lld", level);
+        }
+        putchar('\n');
+    }
+}
+
+// Scale is the number of instructions in the corrupted memory, among them
+// broken ones and do()/don't() switches
+void generate_03(size_t scale, Random *rng) {
+    const char *noise = "!@#$%^&*()[]{}<>,;:'+-/? whywhatwherefromselect";
+    size_t line = 0;
+
+    for (size_t i = 0; i < scale; ++i) {
+        for (long long n = uniform(rng, 0, 8); n > 0; --n) {
+            putchar(noise[uniform(rng, 0, strlen(noise) - 1)]);
+        }
+
+        long long x = uniform(rng, 1, 999), y = uniform(rng, 1, 999);
+        switch (uniform(rng, 0, 9)) {
+        case 0:
+            printf("do()");
+            break;
+        case 1:
+            printf("don't()");
+            break;
+        case 2:
+            printf("mul[%lld,%lld]", x, y);
+            break;
+        case 3:
+            printf("mul(%lld,%lld]", x, y);
+            break;
+        case 4:
+            printf("mul( %lld,%lld)", x, y);
+            break;
+        default:
+            printf("mul(%lld,%lld)", x, y);
+        }
+
+        // The puzzle input is split over a few long lines
+        if (++line == 700) {
+            putchar('\n');
+            line = 0;
+        }
+    }
+    putchar('\n');
+}
+
+void generate_04(size_t scale, Random *rng) {
+    char **grid = new_grid(scale, '.');
+    for (size_t i = 0; i < scale * scale; ++i) {
+        grid[0][i] = "XMAS"[uniform(rng, 0, 3)];
+    }
+    print_grid(grid, scale);
+    free_grid(grid);
+}
+
+// Rules order all pairs of 49 pages, like in the puzzle. Scale is the number
+// of updates, about half of them in the right order.
+void generate_05(size_t scale, Random *rng) {
+    enum { PAGES = 49 };
+    long long pages[PAGES];
+    bool used[100] = {0};
+    for (size_t i = 0; i < PAGES; ++i) {
+        do {
+            pages[i] = uniform(rng, 10, 99);
+        } while (used[pages[i]]);
+        used[pages[i]] = true;
+    }
+
+    size_t (*rules)[2] = malloc(PAGES * PAGES * sizeof(*rules));
+    size_t count = 0;
+    for (size_t i = 0; i < PAGES; ++i) {
+        for (size_t j = i + 1; j < PAGES; ++j) {
+            rules[count][0] = i;
+            rules[count++][1] = j;
+        }
+    }
+    shuffle(rules, count, sizeof(*rules), rng);
+    for (size_t i = 0; i < count; ++i) {
+        printf("%lld|%lld\n", pages[rules[i][0]], pages[rules[i][1]]);
+    }
+    free(rules);
+
+    putchar('\n');
+    for (size_t i = 0; i < scale; ++i) {
+        size_t indices[PAGES];
+        for (size_t j = 0; j < PAGES; ++j) {
+            indices[j] = j;
+        }
+        shuffle(indices, PAGES, sizeof(size_t), rng);
+
+        // Pages of a correct update keep the order of the rules
+        size_t length = 2 * uniform(rng, 2, 11) + 1;
+        if (coin(rng, 0.5)) {
+            for (size_t j = 1; j < length; ++j) {
+                for (size_t k = j; k > 0 && indices[k - 1] > indices[k]; --k) {
+                    size_t tmp = indices[k];
+                    indices[k] = indices[k - 1];
+                    indices[k - 1] = tmp;
+                }
+            }
+        }
+
+        for (size_t j = 0; j < length; ++j) {
+            printf(j ? ",%lld" : "%lld", pages[indices[j]]);
+        }
+        putchar('\n');
+    }
+}
+
+// Returns true if the guard walks off the map instead of ending in a cycle
+bool guard_leaves(char **grid, size_t side, size_t x, size_t y) {
+    BitGrid visited = bitgrid_new(side, side * 4);
+    size_t dir = 0;
+    bool leaves = true;
+
+    while (true) {
+        if (bitgrid_test_and_set(visited, x * 4 + dir, y)) {
+            leaves = false;
+            break;
+        }
+
+        size_t x_ = x + neighbors[dir][0], y_ = y + neighbors[dir][1];
+        if (x_ >= side || y_ >= side) {
+            break;
+        } else if (grid[y_][x_] == '#') {
+            dir = (dir + 1) % 4;
+        } else {
+            x = x_;
+            y = y_;
+        }
+    }
+
+    bitgrid_free(visited);
+    return leaves;
+}
+
+// Obstacles are placed again until the guard leaves the map, since part 1
+// only ends when the guard does
+void generate_06(size_t scale, Random *rng) {
+    char **grid = new_grid(scale, '.');
+    size_t x, y;
+
+    do {
+        for (size_t i = 0; i < scale * scale; ++i) {
+            grid[0][i] = coin(rng, 0.05) ? '#' : '.';
+        }
+        x = uniform(rng, 0, scale - 1);
+        y = uniform(rng, 0, scale - 1);
+        grid[y][x] = '.';
+    } while (!guard_leaves(grid, scale, x, y));
+
+    grid[y][x] = '^';
+    print_grid(grid, scale);
+    free_grid(grid);
+}
+
+// Largest test value of an equation, so that all of them fit in 64 bits
+#define MAX_TEST_VALUE 1000000000000000LL
+
+// Equations with up to 12 numbers. Half of them are built from random
+// operators, so they can be calibrated.
+void generate_07(size_t scale, Random *rng) {
+    for (size_t i = 0; i < scale; ++i) {
+        long long numbers[12];
+        size_t count = uniform(rng, 2, 12);
+        for (size_t j = 0; j < count; ++j) {
+            numbers[j] = uniform(rng, 1, j < 3 ? 999 : 9);
+        }
+
+        long long value = numbers[0];
+        for (size_t j = 1; j < count && value < MAX_TEST_VALUE; ++j) {
+            long long number = numbers[j];
+            switch (uniform(rng, 0, 2)) {
+            case 0:
+                value += number;
+                break;
+            case 1:
+                value *= number;
+                break;
+            default:
+                for (long long k = number; k > 0; k /= 10) {
+                    value *= 10;
+                }
+                value += number;
+            }
+        }
+
+        if (value >= MAX_TEST_VALUE || coin(rng, 0.5)) {
+            value = uniform(rng, 1, MAX_TEST_VALUE / 1000);
+        }
+
+        printf("%lld:", value);
+        for (size_t j = 0; j < count; ++j) {
+            printf(" %lld", numbers[j]);
+        }
+        putchar('\n');
+    }
+}
+
+void generate_08(size_t scale, Random *rng) {
+    const char *frequencies =
+        "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    char **grid = new_grid(scale, '.');
+    for (size_t i = 0; i < scale * scale / 12; ++i) {
+        grid[0][uniform(rng, 0, scale * scale - 1)] =
+            frequencies[uniform(rng, 0, strlen(frequencies) - 1)];
+    }
+    print_grid(grid, scale);
+    free_grid(grid);
+}
+
+// Scale is the number of digits of the disk map
+void generate_09(size_t scale, Random *rng) {
+    for (size_t i = 0; i < scale; ++i) {
+        putchar('0' + uniform(rng, i % 2 ? 0 : 1, 9));
+    }
+    putchar('\n');
+}
+
+// Heights fall from random peaks in steps of one, so that there are many
+// hiking trails, and some cells are random
+void generate_10(size_t scale, Random *rng) {
+    size_t *distances;
+    size_t peaks = scale * scale / 50 + 1;
+    size_t *region = grow_regions(scale, peaks, rng, &distances);
+
+    char **grid = new_grid(scale, '.');
+    for (size_t i = 0; i < scale * scale; ++i) {
+        int height = 9 - distances[i] % 10;
+        grid[0][i] = '0' + (coin(rng, 0.1) ? uniform(rng, 0, 9) : height);
+    }
+    print_grid(grid, scale);
+
+    free_grid(grid);
+    free(region);
+    free(distances);
+}
+
+void generate_11(size_t scale, Random *rng) {
+    for (size_t i = 0; i < scale; ++i) {
+        printf(i ? " %lld" : "%lld", uniform(rng, 0, 999999));
+    }
+    putchar('\n');
+}
+
+// Garden plots are random regions, which merge if they grow the same plant
+void generate_12(size_t scale, Random *rng) {
+    size_t *distances;
+    size_t seeds = scale * scale / 40 + 1;
+    size_t *region = grow_regions(scale, seeds, rng, &distances);
+
+    char *plants = malloc(seeds);
+    for (size_t i = 0; i < seeds; ++i) {
+        plants[i] = 'A' + uniform(rng, 0, 25);
+    }
+
+    char **grid = new_grid(scale, '.');
+    for (size_t i = 0; i < scale * scale; ++i) {
+        grid[0][i] = plants[region[i]];
+    }
+    print_grid(grid, scale);
+
+    free_grid(grid);
+    free(plants);
+    free(region);
+    free(distances);
+}
+
+// Half of the prizes can be won. One button moves more along X and the other
+// along Y, so that the far prizes of part 2 never need negative presses.
+void generate_13(size_t scale, Random *rng) {
+    for (size_t i = 0; i < scale; ++i) {
+        long long ax, ay, bx, by;
+        do {
+            ax = uniform(rng, 10, 99);
+            ay = uniform(rng, 10, 99);
+            bx = uniform(rng, 10, 99);
+            by = uniform(rng, 10, 99);
+        } while ((ax - ay) * (bx - by) >= 0);
+
+        long long a = uniform(rng, 1, 100), b = uniform(rng, 1, 100);
+        long long x = a * ax + b * bx, y = a * ay + b * by;
+        if (coin(rng, 0.5)) {
+            x += uniform(rng, 1, 50);
+            y += uniform(rng, 1, 50);
+        }
+
+        if (i) {
+            putchar('\n');
+        }
+        printf("Button A: X+%lld, Y+%lld\n", ax, ay);
+        printf("Button B: X+%lld, Y+%lld\n", bx, by);
+        printf("Prize: X=%lld, Y=%lld\n", x, y);
+    }
+}
+
+// The solution assumes a 101x103 room. Scale is the number of robots, and
+// most of them gather in a box at a random second, which is the tree.
+void generate_14(size_t scale, Random *rng) {
+    const long long width = 101, height = 103;
+    long long tree = uniform(rng, 1, width * height - 1);
+    long long box_x = uniform(rng, 0, width - 31);
+    long long box_y = uniform(rng, 0, height - 33);
+
+    for (size_t i = 0; i < scale; ++i) {
+        long long vx = uniform(rng, -100, 100), vy = uniform(rng, -100, 100);
+        long long x, y;
+        if (coin(rng, 0.6)) {
+            x = box_x + uniform(rng, 0, 30);
+            y = box_y + uniform(rng, 0, 32);
+        } else {
+            x = uniform(rng, 0, width - 1);
+            y = uniform(rng, 0, height - 1);
+        }
+
+        // Move the robot back from its position in the tree
+        x = ((x - vx * tree) % width + width) % width;
+        y = ((y - vy * tree) % height + height) % height;
+        printf("p=%lld,%lld v=%lld,%lld\n", x, y, vx, vy);
+    }
+}
+
+// Scale is the side of the warehouse, and there are eight moves per cell
+void generate_15(size_t scale, Random *rng) {
+    char **grid = new_grid(scale, '.');
+    for (size_t y = 0; y < scale; ++y) {
+        for (size_t x = 0; x < scale; ++x) {
+            bool border = !x || !y || x == scale - 1 || y == scale - 1;
+            grid[y][x] = border ? '#'
+                         : coin(rng, 0.05) ? '#'
+                         : coin(rng, 0.3)  ? 'O'
+                                           : '.';
+        }
+    }
+    grid[uniform(rng, 1, scale - 2)][uniform(rng, 1, scale - 2)] = '@';
+    print_grid(grid, scale);
+    free_grid(grid);
+
+    putchar('\n');
+    size_t moves = 8 * scale * scale;
+    for (size_t i = 0; i < moves; ++i) {
+        putchar("^>v<"[uniform(rng, 0, 3)]);
+        if ((i + 1) % 1000 == 0 || i == moves - 1) {
+            putchar('\n');
+        }
+    }
+}
+
+// Maze with some extra openings, so there are several best paths
+void generate_16(size_t scale, Random *rng) {
+    scale |= 1;
+    char **grid = new_grid(scale, '#');
+    free(carve_maze(grid, scale, 1, scale - 2, rng));
+
+    for (size_t y = 1; y < scale - 1; ++y) {
+        for (size_t x = 1 + y % 2; x < scale - 1; x += 2) {
+            if (coin(rng, 0.05)) {
+                grid[y][x] = '.';
+            }
+        }
+    }
+
+    grid[scale - 2][1] = 'S';
+    grid[1][scale - 2] = 'E';
+    print_grid(grid, scale);
+    free_grid(grid);
+}
+
+// Returns the output of a single loop of the program below
+size_t loop_output(size_t a, size_t x, size_t y) {
+    size_t b = (a % 8) ^ x;
+    size_t c = a >> b;
+    return (b ^ y ^ c) % 8;
+}
+
+// Returns true if some value of register A makes the program print itself,
+// found the same way as the solution does
+bool has_quine(const size_t *program, size_t x, size_t y) {
+    size_t *candidates = 0;
+    arrput(candidates, 0);
+
+    for (size_t i = 16; i > 0 && arrlenu(candidates); --i) {
+        size_t *next = 0;
+        for (size_t j = 0; j < arrlenu(candidates); ++j) {
+            size_t from = 8 * candidates[j];
+            for (size_t a = from; a < from + 8; ++a) {
+                if (loop_output(a, x, y) == program[i - 1]) {
+                    arrput(next, a);
+                }
+            }
+        }
+        arrfree(candidates);
+        candidates = next;
+    }
+
+    bool found = arrlenu(candidates) > 0;
+    arrfree(candidates);
+    return found;
+}
+
+// The program has the structure that part 2 relies on. Its constants are
+// drawn until some value of register A makes it print itself.
+void generate_17(size_t, Random *rng) {
+    size_t program[16] = {2, 4, 1, 0, 7, 5, 1, 0, 4, 0, 0, 3, 5, 5, 3, 0};
+    do {
+        program[3] = uniform(rng, 0, 7);
+        program[7] = uniform(rng, 0, 7);
+        program[9] = uniform(rng, 0, 7);
+    } while (!has_quine(program, program[3], program[7]));
+
+    printf("Register A: %lld\n", uniform(rng, 1LL << 45, (1LL << 48) - 1));
+    printf("Register B: 0\nRegister C: 0\n\nProgram: ");
+    for (size_t i = 0; i < 16; ++i) {
+        printf(i ? ",%zu" : "%zu", program[i]);
+    }
+    putchar('\n');
+}
+
+// Returns true if the exit of the memory space is reachable
+bool exit_reachable(BitGrid corrupted, size_t side) {
+    BitGrid visited = bitgrid_new(side, side);
+    size_t *queue = 0;
+    arrput(queue, 0);
+    bitgrid_set(visited, 0, 0);
+
+    bool reachable = false;
+    for (size_t i = 0; i < arrlenu(queue) && !reachable; ++i) {
+        size_t x = queue[i] % side, y = queue[i] / side;
+        reachable = x == side - 1 && y == side - 1;
+        for (size_t k = 0; k < 4; ++k) {
+            size_t x_ = x + neighbors[k][0], y_ = y + neighbors[k][1];
+            if (x_ < side && y_ < side && !bitgrid_test(corrupted, x_, y_)
+                && !bitgrid_test_and_set(visited, x_, y_)) {
+                arrput(queue, y_ * side + x_);
+            }
+        }
+    }
+
+    arrfree(queue);
+    bitgrid_free(visited);
+    return reachable;
+}
+
+// The solution assumes a 71x71 memory space, so scale is the number of bytes
+// in it, at least 3000. The exit stays reachable after the first 1024 bytes,
+// and all bytes block it.
+void generate_18(size_t scale, Random *rng) {
+    const size_t side = 71;
+    size_t cells[71 * 71 - 2];
+    size_t count = 0;
+    for (size_t i = 1; i < side * side - 1; ++i) {
+        cells[count++] = i;
+    }
+    scale = scale < 3000 ? 3000 : scale < count ? scale : count;
+
+    BitGrid corrupted = bitgrid_new(side, side);
+    bool valid = false;
+    while (!valid) {
+        shuffle(cells, count, sizeof(size_t), rng);
+        bitgrid_reset(corrupted);
+        for (size_t i = 0; i < 1024; ++i) {
+            bitgrid_set(corrupted, cells[i] % side, cells[i] / side);
+        }
+        valid = exit_reachable(corrupted, side);
+        for (size_t i = 1024; i < scale; ++i) {
+            bitgrid_set(corrupted, cells[i] % side, cells[i] / side);
+        }
+        valid &= !exit_reachable(corrupted, side);
+    }
+    bitgrid_free(corrupted);
+
+    for (size_t i = 0; i < scale; ++i) {
+        printf("%zu,%zu\n", cells[i] % side, cells[i] / side);
+    }
+}
+
+// Scale is the number of designs. Most of them are made of towels. The rest
+// have random stripes and end with a red one, which no towel does.
+void generate_19(size_t scale, Random *rng) {
+    const char *colors = "wubrg";
+    char **towels = 0;
+    while (arrlenu(towels) < 450) {
+        char *towel = calloc(9, 1);
+        for (long long n = uniform(rng, 1, 8); n > 0; --n) {
+            towel[strlen(towel)] = colors[uniform(rng, 0, 4)];
+        }
+
+        bool duplicate = towel[strlen(towel) - 1] == 'r';
+        for (size_t i = 0; i < arrlenu(towels) && !duplicate; ++i) {
+            duplicate = !strcmp(towels[i], towel);
+        }
+        if (duplicate) {
+            free(towel);
+        } else {
+            arrput(towels, towel);
+        }
+    }
+
+    for (size_t i = 0; i < arrlenu(towels); ++i) {
+        printf(i ? ", %s" : "%s", towels[i]);
+    }
+    printf("\n\n");
+
+    for (size_t i = 0; i < scale; ++i) {
+        bool possible = coin(rng, 0.7);
+        long long length = uniform(rng, 40, 60);
+        for (long long n = 0; n < length;) {
+            if (possible) {
+                n += printf("%s", towels[uniform(rng, 0, arrlenu(towels) - 1)]);
+            } else {
+                putchar(colors[uniform(rng, 0, 4)]);
+                ++n;
+            }
+        }
+        printf(possible ? "\n" : "r\n");
+    }
+
+    for (size_t i = 0; i < arrlenu(towels); ++i) {
+        free(towels[i]);
+    }
+    arrfree(towels);
+}
+
+// The racetrack is the path from the start of a random maze to its farthest
+// cell, and every other cell is a wall
+void generate_20(size_t scale, Random *rng) {
+    scale |= 1;
+    char **maze = new_grid(scale, '#');
+    size_t start = (scale - 2) * scale + 1;
+    size_t *parent = carve_maze(maze, scale, 1, scale - 2, rng);
+
+    // The farthest cell has the longest chain of parents. Lengths are found
+    // by walking up to the first cell with a known length.
+    size_t *lengths = malloc(scale * scale * sizeof(size_t));
+    memset(lengths, 0xff, scale * scale * sizeof(size_t));
+    lengths[start] = 0;
+
+    size_t end = start, *chain = 0;
+    for (size_t i = 0; i < scale * scale; ++i) {
+        if (maze[0][i] != '.') {
+            continue;
+        }
+        for (size_t cell = i; lengths[cell] == SIZE_MAX; cell = parent[cell]) {
+            arrput(chain, cell);
+        }
+        while (arrlenu(chain)) {
+            size_t cell = arrpop(chain);
+            lengths[cell] = lengths[parent[cell]] + 1;
+        }
+        end = lengths[i] > lengths[end] ? i : end;
+    }
+    arrfree(chain);
+    free(lengths);
+
+    char **grid = new_grid(scale, '#');
+    for (size_t cell = end; cell != start; cell = parent[cell]) {
+        grid[0][cell] = '.';
+    }
+    grid[0][start] = 'S';
+    grid[0][end] = 'E';
+    print_grid(grid, scale);
+
+    free_grid(grid);
+    free_grid(maze);
+    free(parent);
+}
+
+// The solution assumes five codes
+void generate_21(size_t, Random *rng) {
+    for (size_t i = 0; i < 5; ++i) {
+        printf("%lldA\n", uniform(rng, 100, 999));
+    }
+}
+
+void generate_22(size_t scale, Random *rng) {
+    for (size_t i = 0; i < scale; ++i) {
+        printf("%lld\n", uniform(rng, 1, (1 << 24) - 1));
+    }
+}
+
+// Scale is the number of computers, at most all 676 two letter names. Every
+// computer has about 13 connections, and a clique of 13 is planted among
+// them, so the LAN party is unique.
+void generate_23(size_t scale, Random *rng) {
+    size_t count = scale < 676 ? scale : 676;
+    size_t names[676];
+    for (size_t i = 0; i < 676; ++i) {
+        names[i] = i;
+    }
+    shuffle(names, 676, sizeof(size_t), rng);
+
+    bool *connected = calloc(count * count, sizeof(bool));
+    size_t clique = count < 13 ? count : 13;
+    for (size_t i = 0; i < clique; ++i) {
+        for (size_t j = i + 1; j < clique; ++j) {
+            connected[i * count + j] = true;
+        }
+    }
+    for (size_t i = 0; i < count * 13 / 2 && count > 1; ++i) {
+        size_t a = uniform(rng, 0, count - 1), b = uniform(rng, 0, count - 1);
+        if (a != b) {
+            connected[(a < b ? a : b) * count + (a < b ? b : a)] = true;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = i + 1; j < count; ++j) {
+            if (connected[i * count + j]) {
+                printf(
+                    "%c%c-%c%c\n", 'a' + (char) (names[i] / 26),
+                    'a' + (char) (names[i] % 26), 'a' + (char) (names[j] / 26),
+                    'a' + (char) (names[j] % 26)
+                );
+            }
+        }
+    }
+    free(connected);
+}
+
+typedef struct Gate {
+    char lhs[4];
+    char op[4];
+    char rhs[4];
+    char out[4];
+} Gate;
+
+// Adds a gate of the adder. Returns its output wire, which is given or a new
+// random name that is not used yet.
+char *add_gate(
+    Gate **gates, const char *lhs, const char *op, const char *rhs,
+    const char *out, Random *rng
+) {
+    Gate gate = {0};
+    strcpy(gate.lhs, lhs);
+    strcpy(gate.op, op);
+    strcpy(gate.rhs, rhs);
+
+    bool used = !out;
+    while (used) {
+        for (size_t i = 0; i < 3; ++i) {
+            gate.out[i] = 'a' + uniform(rng, 0, 22);
+        }
+        used = false;
+        for (size_t i = 0; i < arrlenu(*gates) && !used; ++i) {
+            used = !strcmp((*gates)[i].out, gate.out);
+        }
+    }
+    if (out) {
+        strcpy(gate.out, out);
+    }
+
+    arrput(*gates, gate);
+    return (*gates)[arrlenu(*gates) - 1].out;
+}
+
+// Ripple-carry adder of scale bits, at most 99. Four pairs of gate outputs
+// are swapped inside four different full adders, the ways the puzzle does.
+void generate_24(size_t scale, Random *rng) {
+    size_t bits = scale < 6 ? 6 : scale > 99 ? 99 : scale;
+    for (size_t i = 0; i < 2 * bits; ++i) {
+        int bit = uniform(rng, 0, 1);
+        printf("%c%02zu: %d\n", i < bits ? 'x' : 'y', i % bits, bit);
+    }
+    putchar('\n');
+
+    // Indices of the gates of each full adder
+    enum { XOR_XY, AND_XY, XOR_CARRY, AND_CARRY, OR_CARRY, GATES };
+    Gate *gates = 0;
+    size_t (*adders)[GATES] = calloc(bits, sizeof(*adders));
+    char x[4], y[4], z[4], carry[4] = "";
+
+    for (size_t i = 0; i < bits; ++i) {
+        sprintf(x, "x%02zu", i);
+        sprintf(y, "y%02zu", i);
+        sprintf(z, "z%02zu", i);
+        bool last = i == bits - 1;
+
+        if (!i) {
+            add_gate(&gates, x, "XOR", y, z, rng);
+            strcpy(carry, add_gate(&gates, x, "AND", y, 0, rng));
+            continue;
+        }
+
+        char sum[4], and_xy[4], and_carry[4], carry_in[4];
+        strcpy(carry_in, carry);
+        strcpy(sum, add_gate(&gates, x, "XOR", y, 0, rng));
+        adders[i][XOR_XY] = arrlenu(gates) - 1;
+        strcpy(and_xy, add_gate(&gates, x, "AND", y, 0, rng));
+        adders[i][AND_XY] = arrlenu(gates) - 1;
+        add_gate(&gates, sum, "XOR", carry_in, z, rng);
+        adders[i][XOR_CARRY] = arrlenu(gates) - 1;
+        strcpy(and_carry, add_gate(&gates, sum, "AND", carry_in, 0, rng));
+        adders[i][AND_CARRY] = arrlenu(gates) - 1;
+
+        // The carry of the last bit is the highest output bit
+        sprintf(z, "z%02zu", bits);
+        char *out = last ? z : 0;
+        strcpy(carry, add_gate(&gates, and_xy, "OR", and_carry, out, rng));
+        adders[i][OR_CARRY] = arrlenu(gates) - 1;
+    }
+
+    // Swap outputs in four distinct full adders, never the first or last one
+    size_t swapped[4];
+    for (size_t i = 0; i < 4; ++i) {
+        bool used;
+        do {
+            swapped[i] = uniform(rng, 1, bits - 2);
+            used = false;
+            for (size_t j = 0; j < i; ++j) {
+                used |= swapped[j] == swapped[i];
+            }
+        } while (used);
+
+        size_t *adder = adders[swapped[i]];
+        size_t a, b;
+        switch (uniform(rng, 0, 2)) {
+        case 0:
+            a = adder[XOR_XY];
+            b = adder[AND_XY];
+            break;
+        case 1:
+            a = adder[XOR_CARRY];
+            b = adder[AND_CARRY];
+            break;
+        default:
+            a = adder[XOR_CARRY];
+            b = adder[OR_CARRY];
+        }
+
+        char tmp[4];
+        strcpy(tmp, gates[a].out);
+        strcpy(gates[a].out, gates[b].out);
+        strcpy(gates[b].out, tmp);
+    }
+
+    shuffle(gates, arrlenu(gates), sizeof(Gate), rng);
+    for (size_t i = 0; i < arrlenu(gates); ++i) {
+        bool flip = coin(rng, 0.5);
+        printf(
+            "%s %s %s -> %s\n", flip ? gates[i].rhs : gates[i].lhs, gates[i].op,
+            flip ? gates[i].lhs : gates[i].rhs, gates[i].out
+        );
+    }
+
+    free(adders);
+    arrfree(gates);
+}
+
+// Scale is the number of schematics, half of them locks
+void generate_25(size_t scale, Random *rng) {
+    for (size_t i = 0; i < scale; ++i) {
+        bool lock = coin(rng, 0.5);
+        long long heights[5];
+        for (size_t j = 0; j < 5; ++j) {
+            heights[j] = uniform(rng, 0, 5);
+        }
+
+        if (i) {
+            putchar('\n');
+        }
+        for (long long row = 0; row < 7; ++row) {
+            for (size_t j = 0; j < 5; ++j) {
+                bool filled = lock ? row <= heights[j] : 6 - row <= heights[j];
+                putchar(filled ? '#' : '.');
+            }
+            putchar('\n');
+        }
+    }
+}
+
+const Generator generators[DAYS] = {
+    {generate_01, 1000,  1},
+    {generate_02, 1000,  1},
+    {generate_03, 700,   1},
+    {generate_04, 140,   1},
+    {generate_05, 200,   1},
+    {generate_06, 130,   1},
+    {generate_07, 850,   1},
+    {generate_08, 50,    1},
+    {generate_09, 19999, 1},
+    {generate_10, 50,    1},
+    {generate_11, 8,     1},
+    {generate_12, 140,   1},
+    {generate_13, 320,   1},
+    {generate_14, 500,   1},
+    {generate_15, 50,    3},
+    {generate_16, 141,   5},
+    {generate_17, 1,     1},
+    {generate_18, 3450,  1},
+    {generate_19, 400,   1},
+    {generate_20, 141,   5},
+    {generate_21, 1,     1},
+    {generate_22, 2000,  1},
+    {generate_23, 520,   2},
+    {generate_24, 45,    1},
+    {generate_25, 500,   1},
+};
+
+// Reads a decimal number without a sign, which strtoull would wrap around
+bool parse_number(const char *text, uint64_t *value) {
+    if (*text < '0' || *text > '9') {
+        return false;
+    }
+
+    char *end;
+    errno = 0;
+    *value = strtoull(text, &end, 10);
+    return !*end && !errno;
+}
+
+int usage(const char *program) {
+    fprintf(stderr, "Usage: %s <day> [scale] [seed]\n", program);
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[]) {
+    int day = argc > 1 ? atoi(argv[1]) : 0;
+    if (day < 1 || day > DAYS) {
+        return usage(argv[0]);
+    }
+
+    const Generator *generator = &generators[day - 1];
+    uint64_t scale = generator->scale, seed = day;
+    if ((argc > 2 && !parse_number(argv[2], &scale))
+        || (argc > 3 && !parse_number(argv[3], &seed))) {
+        return usage(argv[0]);
+    }
+    if (scale < generator->min_scale) {
+        fprintf(
+            stderr, "The scale of day %d is at least %zu\n", day,
+            generator->min_scale
+        );
+        return usage(argv[0]);
+    }
+
+    Random rng = {seed};
+    generator->generate(scale, &rng);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+// Instrumentation of hot paths, compiled in with -DINSTRUMENT (the INSTRUMENT
+// option in CMake). Without it the macros below expand to nothing.
+//
+// INSTRUMENT_REGION(name) times the rest of the enclosing block, so a region
+// is marked by opening a block around the code. INSTRUMENT_COUNT(name, n)
+// adds n to a named event counter. On Linux every region also counts cycles,
+// instructions, last level cache misses and branch misses of its thread with
+// perf_event_open, as far as the kernel allows (see perf_event_paranoid).
+//
+// Regions and events belong to the source file that uses them, and each file
+// prints its own report to stderr at exit. Totals include nested regions.
+
+#ifdef INSTRUMENT
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+typedef enum InstrumentCounter {
+    INSTRUMENT_CYCLES,
+    INSTRUMENT_INSTRUCTIONS,
+    INSTRUMENT_LLC_MISSES,
+    INSTRUMENT_BRANCH_MISSES,
+    INSTRUMENT_COUNTERS
+} InstrumentCounter;
+
+typedef struct InstrumentRegion {
+    const char *name;
+    bool registered;
+    uint64_t calls;
+    uint64_t nanoseconds;
+    // Calls that could read the hardware counters, and their totals
+    uint64_t counted_calls;
+    uint64_t counters[INSTRUMENT_COUNTERS];
+    struct InstrumentRegion *next;
+} InstrumentRegion;
+
+typedef struct InstrumentEvent {
+    const char *name;
+    bool registered;
+    uint64_t count;
+    struct InstrumentEvent *next;
+} InstrumentEvent;
+
+typedef struct InstrumentScope {
+    InstrumentRegion *region;
+    uint64_t start;
+    bool counted;
+    uint64_t counters[INSTRUMENT_COUNTERS];
+} InstrumentScope;
+
+static InstrumentRegion *instrument_regions;
+static InstrumentEvent *instrument_events;
+static bool instrument_report_registered;
+
+// Counter group of the current thread. The leader is -2 until the group is
+// opened and -1 if no counter is available. Counters the hardware does not
+// have are left out of the group, and their slot is -1.
+static _Thread_local int instrument_group = -2;
+static _Thread_local int instrument_slots[INSTRUMENT_COUNTERS];
+
+static inline uint64_t instrument_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static inline void instrument_open_group(void) {
+    instrument_group = -1;
+#ifdef __linux__
+    static const uint64_t configs[INSTRUMENT_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    int slot = 0;
+    for (size_t i = 0; i < INSTRUMENT_COUNTERS; ++i) {
+        struct perf_event_attr attr = {0};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.disabled = instrument_group == -1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        int fd = syscall(
+            SYS_perf_event_open, &attr, 0, -1, instrument_group, 0
+        );
+        instrument_slots[i] = fd < 0 ? -1 : slot++;
+        if (fd >= 0 && instrument_group == -1) {
+            instrument_group = fd;
+        }
+    }
+
+    if (instrument_group >= 0) {
+        ioctl(instrument_group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+// Reads the counters of the current thread, or returns false if it has none
+static inline bool instrument_read(uint64_t counters[INSTRUMENT_COUNTERS]) {
+    if (instrument_group == -2) {
+        instrument_open_group();
+    }
+    if (instrument_group < 0) {
+        return false;
+    }
+
+    // The group is read as the number of counters followed by their values
+    uint64_t values[1 + INSTRUMENT_COUNTERS];
+    if (read(instrument_group, values, sizeof(values)) <= 0) {
+        return false;
+    }
+
+    for (size_t i = 0; i < INSTRUMENT_COUNTERS; ++i) {
+        int slot = instrument_slots[i];
+        counters[i] = slot < 0 ? 0 : values[1 + slot];
+    }
+    return true;
+}
+
+static inline void instrument_report(void) {
+    if (instrument_regions) {
+        fprintf(
+            stderr, "%-24s %10s %12s %14s %14s %6s %12s %12s\n", "region",
+            "calls", "total ms", "cycles", "instructions", "IPC", "LLC misses",
+            "br misses"
+        );
+    }
+
+    for (InstrumentRegion *r = instrument_regions; r; r = r->next) {
+        fprintf(
+            stderr, "%-24s %10llu %12.3f", r->name,
+            (unsigned long long)r->calls, r->nanoseconds / 1e6
+        );
+        if (r->counted_calls) {
+            const uint64_t *c = r->counters;
+            double ipc = c[INSTRUMENT_CYCLES]
+                             ? (double)c[INSTRUMENT_INSTRUCTIONS]
+                                   / c[INSTRUMENT_CYCLES]
+                             : 0;
+            fprintf(
+                stderr, " %14llu %14llu %6.2f %12llu %12llu\n",
+                (unsigned long long)c[INSTRUMENT_CYCLES],
+                (unsigned long long)c[INSTRUMENT_INSTRUCTIONS], ipc,
+                (unsigned long long)c[INSTRUMENT_LLC_MISSES],
+                (unsigned long long)c[INSTRUMENT_BRANCH_MISSES]
+            );
+        } else {
+            fprintf(
+                stderr, " %14s %14s %6s %12s %12s\n", "-", "-", "-", "-", "-"
+            );
+        }
+    }
+
+    for (InstrumentEvent *e = instrument_events; e; e = e->next) {
+        fprintf(
+            stderr, "%-24s %10llu\n", e->name, (unsigned long long)e->count
+        );
+    }
+}
+
+// Schedules the report the first time anything is recorded
+static inline void instrument_register_report(void) {
+    if (!__atomic_load_n(&instrument_report_registered, __ATOMIC_RELAXED)
+        && !__atomic_exchange_n(
+            &instrument_report_registered, true, __ATOMIC_ACQ_REL
+        )) {
+        atexit(instrument_report);
+    }
+}
+
+// Registration only writes the flag once, later calls on the hot path just
+// read it
+static inline void instrument_register_region(InstrumentRegion *region) {
+    if (__atomic_load_n(&region->registered, __ATOMIC_RELAXED)
+        || __atomic_exchange_n(&region->registered, true, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+
+    region->next = __atomic_load_n(&instrument_regions, __ATOMIC_ACQUIRE);
+    while (!__atomic_compare_exchange_n(
+        &instrument_regions, &region->next, region, false, __ATOMIC_ACQ_REL,
+        __ATOMIC_ACQUIRE
+    )) {
+    }
+    instrument_register_report();
+}
+
+static inline void instrument_register_event(InstrumentEvent *event) {
+    if (__atomic_load_n(&event->registered, __ATOMIC_RELAXED)
+        || __atomic_exchange_n(&event->registered, true, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+
+    event->next = __atomic_load_n(&instrument_events, __ATOMIC_ACQUIRE);
+    while (!__atomic_compare_exchange_n(
+        &instrument_events, &event->next, event, false, __ATOMIC_ACQ_REL,
+        __ATOMIC_ACQUIRE
+    )) {
+    }
+    instrument_register_report();
+}
+
+static inline InstrumentScope instrument_begin(InstrumentRegion *region) {
+    instrument_register_region(region);
+
+    InstrumentScope scope = {.region = region};
+    scope.counted = instrument_read(scope.counters);
+    scope.start = instrument_now();
+    return scope;
+}
+
+static inline void instrument_end(InstrumentScope *scope) {
+    uint64_t end = instrument_now();
+    uint64_t counters[INSTRUMENT_COUNTERS];
+    bool counted = scope->counted && instrument_read(counters);
+
+    InstrumentRegion *region = scope->region;
+    __atomic_fetch_add(&region->calls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(
+        &region->nanoseconds, end - scope->start, __ATOMIC_RELAXED
+    );
+    if (!counted) {
+        return;
+    }
+
+    __atomic_fetch_add(&region->counted_calls, 1, __ATOMIC_RELAXED);
+    for (size_t i = 0; i < INSTRUMENT_COUNTERS; ++i) {
+        __atomic_fetch_add(
+            &region->counters[i], counters[i] - scope->counters[i],
+            __ATOMIC_RELAXED
+        );
+    }
+}
+
+static inline void instrument_add(InstrumentEvent *event, uint64_t n) {
+    instrument_register_event(event);
+    __atomic_fetch_add(&event->count, n, __ATOMIC_RELAXED);
+}
+
+#define INSTRUMENT_CONCAT_(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_(a, b)
+#define INSTRUMENT_UNIQUE(prefix) INSTRUMENT_CONCAT(prefix, __LINE__)
+
+#define INSTRUMENT_REGION(region_name)                                       \
+    static InstrumentRegion INSTRUMENT_UNIQUE(instrument_region_) = {        \
+        .name = region_name                                                  \
+    };                                                                       \
+    __attribute__((cleanup(instrument_end))) InstrumentScope                 \
+    INSTRUMENT_UNIQUE(instrument_scope_) =                                   \
+        instrument_begin(&INSTRUMENT_UNIQUE(instrument_region_))
+
+#define INSTRUMENT_COUNT(event_name, n)                                      \
+    do {                                                                     \
+        static InstrumentEvent instrument_event = {.name = event_name};      \
+        instrument_add(&instrument_event, n);                                \
+    } while (0)
+
+#else
+
+#define INSTRUMENT_REGION(region_name)
+#define INSTRUMENT_COUNT(event_name, n) ((void)0)
+
+#endif
@@ -0,0 +1,265 @@
+#pragma once
+
+// Shortest paths over graphs whose states the day numbers densely from 0,
+// shared by the search days. The day drives the search with its own loop:
+//
+//     Search search = search_new(num_states, max_step, flags);
+//     search_push(&search, start, 0, estimate(start));
+//     size_t state, cost;
+//     while (search_pop(&search, &state, &cost)) {
+//         if (is_goal(state)) ...
+//         for each neighbor next of state:
+//             search_push(&search, next, cost + edge, estimate(next));
+//     }
+//     search_free(&search);
+//
+// With all estimates 0 this is Dijkstra's algorithm, otherwise A*. The
+// estimate of the remaining cost must be consistent, i.e. never drop by more
+// than the cost of an edge, so that keys leave the queue in order.
+//
+// max_step bounds how much the key of a state can grow along one edge, which
+// is the largest edge cost plus the largest growth of the estimate. A small
+// bound selects a bucket queue (Dial's algorithm), otherwise a radix heap is
+// used. A max_step of 0 declares that keys are not monotone, e.g. because
+// the estimate is not consistent, and selects a binary heap.
+//
+// With SEARCH_PREDECESSORS every reached state keeps all its predecessors on
+// shortest paths, which together form the DAG of all shortest paths. All
+// memory of a search lives in its arena.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+#define SEARCH_UNREACHED SIZE_MAX
+
+// Largest max_step served by a bucket queue
+#define SEARCH_BUCKET_LIMIT ((size_t) 1 << 12)
+
+#define SEARCH_RADIX_BUCKETS 65
+
+typedef enum SearchFlags {
+    SEARCH_PREDECESSORS = 1,
+} SearchFlags;
+
+typedef enum SearchQueue {
+    SEARCH_BUCKETS,
+    SEARCH_RADIX,
+    SEARCH_HEAP,
+} SearchQueue;
+
+typedef struct SearchEntry {
+    size_t key;
+    size_t cost;
+    size_t state;
+} SearchEntry;
+
+// Predecessor of a state on one of its shortest paths, followed by the next
+// predecessor of the same state
+typedef struct SearchEdge {
+    size_t from;
+    struct SearchEdge *next;
+} SearchEdge;
+
+typedef struct Search {
+    Arena arena;
+    SearchQueue queue;
+    size_t *distances;
+    SearchEdge **predecessors;
+    // State of the last popped entry, the source of pushed edges
+    size_t from;
+    size_t size;
+    // Arena arrays of entries. The bucket queue keeps a circular array of
+    // buckets and the radix heap one bucket per bit of the keys. The binary
+    // heap is a single array. Current is the last popped key, modulo the
+    // number of buckets for the bucket queue.
+    SearchEntry **buckets;
+    size_t mask;
+    size_t current;
+    SearchEntry *heap;
+} Search;
+
+static inline Search search_new(
+    size_t num_states, size_t max_step, SearchFlags flags
+) {
+    Search search = {.arena = arena_new(), .from = SEARCH_UNREACHED};
+
+    search.distances = arena_alloc(&search.arena, num_states * sizeof(size_t));
+    memset(search.distances, 0xff, num_states * sizeof(size_t));
+    if (flags & SEARCH_PREDECESSORS) {
+        search.predecessors = arena_calloc(
+            &search.arena, num_states, sizeof(SearchEdge *)
+        );
+    }
+
+    size_t num_buckets = 0;
+    if (max_step && max_step <= SEARCH_BUCKET_LIMIT) {
+        search.queue = SEARCH_BUCKETS;
+        num_buckets = 1;
+        while (num_buckets <= max_step) {
+            num_buckets *= 2;
+        }
+        search.mask = num_buckets - 1;
+    } else if (max_step) {
+        search.queue = SEARCH_RADIX;
+        num_buckets = SEARCH_RADIX_BUCKETS;
+    } else {
+        search.queue = SEARCH_HEAP;
+    }
+    search.buckets = arena_calloc(
+        &search.arena, num_buckets, sizeof(SearchEntry *)
+    );
+
+    return search;
+}
+
+static inline void search_free(Search *search) {
+    arena_free(&search->arena);
+}
+
+// Returns the bucket of the key in the radix heap. Keys equal to the last
+// popped key are in bucket 0, the others by their highest bit that differs.
+static inline size_t search_radix_bucket(size_t key, size_t last) {
+    return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+}
+
+static inline void search_heap_push(Search *search, SearchEntry entry) {
+    arena_arrput(&search->arena, search->heap, entry);
+    SearchEntry *heap = search->heap;
+
+    size_t i = arena_arrlen(heap) - 1;
+    while (i > 0 && heap[(i - 1) / 2].key > entry.key) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = entry;
+}
+
+static inline SearchEntry search_heap_pop(Search *search) {
+    SearchEntry *heap = search->heap;
+    SearchEntry min = heap[0];
+    SearchEntry last = arena_arrpop(heap);
+    size_t size = arena_arrlen(heap);
+
+    size_t i = 0;
+    while (2 * i + 1 < size) {
+        size_t child = 2 * i + 1;
+        child += child + 1 < size && heap[child + 1].key < heap[child].key;
+        if (last.key <= heap[child].key) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (size) {
+        heap[i] = last;
+    }
+
+    return min;
+}
+
+static inline void search_enqueue(Search *search, SearchEntry entry) {
+    if (search->queue == SEARCH_BUCKETS) {
+        SearchEntry **bucket = &search->buckets[entry.key & search->mask];
+        arena_arrput(&search->arena, *bucket, entry);
+    } else if (search->queue == SEARCH_RADIX) {
+        size_t i = search_radix_bucket(entry.key, search->current);
+        arena_arrput(&search->arena, search->buckets[i], entry);
+    } else {
+        search_heap_push(search, entry);
+    }
+    ++search->size;
+}
+
+static inline SearchEntry search_dequeue(Search *search) {
+    --search->size;
+
+    if (search->queue == SEARCH_BUCKETS) {
+        while (!arena_arrlen(search->buckets[search->current & search->mask])) {
+            ++search->current;
+        }
+        return arena_arrpop(search->buckets[search->current & search->mask]);
+    } else if (search->queue == SEARCH_HEAP) {
+        return search_heap_pop(search);
+    }
+
+    // Redistribute the radix bucket with the smallest keys around its minimum
+    SearchEntry **buckets = search->buckets;
+    if (!arena_arrlen(buckets[0])) {
+        size_t i = 1;
+        while (!arena_arrlen(buckets[i])) {
+            ++i;
+        }
+
+        SearchEntry *bucket = buckets[i];
+        size_t length = arena_arrlen(bucket);
+        search->current = bucket[0].key;
+        for (size_t j = 1; j < length; ++j) {
+            if (bucket[j].key < search->current) {
+                search->current = bucket[j].key;
+            }
+        }
+
+        arena_arrheader(bucket)->length = 0;
+        for (size_t j = 0; j < length; ++j) {
+            size_t k = search_radix_bucket(bucket[j].key, search->current);
+            arena_arrput(&search->arena, buckets[k], bucket[j]);
+        }
+    }
+    return arena_arrpop(buckets[0]);
+}
+
+// Reaches the state with the cost from the state popped last, or starts the
+// search there if nothing was popped yet. The state is queued if the cost is
+// lower than any before, with the estimate of its remaining cost added to its
+// key. Returns whether it was queued.
+static inline bool search_push(
+    Search *search, size_t state, size_t cost, size_t estimate
+) {
+    size_t known = search->distances[state];
+    if (cost > known) {
+        return false;
+    }
+
+    if (search->predecessors && search->from != SEARCH_UNREACHED) {
+        SearchEdge *edge = arena_alloc(&search->arena, sizeof(SearchEdge));
+        *edge = (SearchEdge){
+            search->from, cost == known ? search->predecessors[state] : 0
+        };
+        search->predecessors[state] = edge;
+    }
+    if (cost == known) {
+        return false;
+    }
+
+    search->distances[state] = cost;
+    search_enqueue(search, (SearchEntry){cost + estimate, cost, state});
+    return true;
+}
+
+// Pops the queued state with the lowest key, skipping states that were
+// reached more cheaply since they were queued. Returns false once the queue
+// is empty.
+static inline bool search_pop(Search *search, size_t *state, size_t *cost) {
+    while (search->size) {
+        SearchEntry entry = search_dequeue(search);
+        if (entry.cost == search->distances[entry.state]) {
+            search->from = *state = entry.state;
+            *cost = entry.cost;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns the cost of the cheapest path to the state found so far
+static inline size_t search_distance(Search *search, size_t state) {
+    return search->distances[state];
+}
+
+// Returns the first of the predecessors of the state on shortest paths
+static inline SearchEdge *search_predecessors(Search *search, size_t state) {
+    return search->predecessors[state];
+}
@@ -1,5 +1,15 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #define STR_(x) #x
 #define STR(x) STR_(x)
 
@@ -45,3 +55,325 @@ static inline void assert_eq_s(char *a, char *b) {
         abort();
     }
 }
+
+#define ANSWER_SIZE 64
+
+// Entry of the multi-day runner registry. Each day exports one as
+// solution_<DAY> when compiled with AOC_ALL. The parsed input is shared by
+// both parts, which may run concurrently unless the entry is sequential.
+typedef struct Solution {
+    const char *day;
+    void *(*parse)(const char *filename);
+    void (*part_1)(void *input, char answer[ANSWER_SIZE]);
+    void (*part_2)(void *input, char answer[ANSWER_SIZE]);
+    void (*free)(void *input);
+    bool sequential;
+} Solution;
+
+#define SOLUTION_(day) solution_##day
+#define SOLUTION(day) SOLUTION_(day)
+
+// Input file mapped into memory. The mapping is private and writable, so days
+// may modify it in place without touching the file, and it is always followed
+// by a null character, so the last line can be terminated like any other.
+typedef struct MappedFile {
+    char *data;
+    size_t size;
+    size_t length;
+} MappedFile;
+
+// Non-owning (ptr, len) view into a mapped file. Views are not null-terminated.
+typedef struct View {
+    char *ptr;
+    size_t len;
+} View;
+
+static inline MappedFile map_file(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st)) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+
+    // Reserve at least one page more than the file needs, so the byte after
+    // its end is always mapped and zero, then map the file over the start
+    size_t page = sysconf(_SC_PAGESIZE);
+    MappedFile file = {.size = st.st_size};
+    file.length = (file.size + page) / page * page;
+    file.data = mmap(
+        0, file.length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+        -1, 0
+    );
+    if (file.data == MAP_FAILED
+        || (file.size
+            && mmap(
+                   file.data, file.size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_FIXED, fd, 0
+               ) == MAP_FAILED)) {
+        perror(filename);
+        exit(EXIT_FAILURE);
+    }
+
+    close(fd);
+    return file;
+}
+
+static inline void unmap_file(MappedFile file) {
+    munmap(file.data, file.length);
+}
+
+static inline View file_view(MappedFile file) {
+    return (View){file.data, file.size};
+}
+
+// Splits the next line off the front of rest, without its line terminator.
+// Returns false, with an empty line, once rest is empty.
+static inline bool next_line(View *rest, View *line) {
+    if (!rest->len) {
+        *line = (View){rest->ptr, 0};
+        return false;
+    }
+
+    char *end = memchr(rest->ptr, '\n', rest->len);
+    size_t len = end ? (size_t)(end - rest->ptr) : rest->len;
+    *line = (View){rest->ptr, len};
+    rest->ptr += end ? len + 1 : len;
+    rest->len -= end ? len + 1 : len;
+
+    if (line->len && line->ptr[line->len - 1] == '\r') {
+        --line->len;
+    }
+    return true;
+}
+
+// Splits the next token off the front of rest, skipping any run of the
+// delimiter characters before it. Like strtok, the delimiter right after the
+// token is consumed too, so the token can be null-terminated with view_str.
+// Returns false, with an empty token, if rest has no more tokens.
+static inline bool next_token(View *rest, const char *delims, View *token) {
+    while (rest->len && strchr(delims, *rest->ptr)) {
+        ++rest->ptr, --rest->len;
+    }
+    if (!rest->len) {
+        *token = (View){rest->ptr, 0};
+        return false;
+    }
+
+    size_t len = 0;
+    while (len < rest->len && !strchr(delims, rest->ptr[len])) {
+        ++len;
+    }
+    *token = (View){rest->ptr, len};
+    len += len < rest->len;
+    rest->ptr += len;
+    rest->len -= len;
+    return true;
+}
+
+// Parses the next integer in rest, skipping anything before it. A minus sign
+// right before the digits makes it negative. Returns false, and sets the
+// number to zero, if rest has no more digits.
+static inline bool next_number(View *rest, long long *number) {
+    bool negative = false;
+    while (rest->len && (*rest->ptr < '0' || *rest->ptr > '9')) {
+        negative = *rest->ptr == '-';
+        ++rest->ptr, --rest->len;
+    }
+    if (!rest->len) {
+        *number = 0;
+        return false;
+    }
+
+    long long value = 0;
+    while (rest->len && *rest->ptr >= '0' && *rest->ptr <= '9') {
+        value = value * 10 + (*rest->ptr - '0');
+        ++rest->ptr, --rest->len;
+    }
+
+    *number = negative ? -value : value;
+    return true;
+}
+
+// Null-terminates the view in place, overwriting the character that follows
+// it in the mapping, and returns it as a C string
+static inline char *view_str(View view) {
+    view.ptr[view.len] = '\0';
+    return view.ptr;
+}
+
+// Address space reserved by each arena. Only the touched part of it is backed
+// by memory, so this is just an upper bound.
+#define ARENA_RESERVE ((size_t) 1 << 32)
+
+// Bump allocator for the scratch memory of hot loops. Allocations never move
+// and are never freed on their own. Instead, everything allocated after a
+// mark is released at once by resetting the arena to that mark.
+typedef struct Arena {
+    char *data;
+    size_t used;
+    size_t capacity;
+} Arena;
+
+static inline Arena arena_new(void) {
+    Arena arena = {.capacity = ARENA_RESERVE};
+    arena.data = mmap(
+        0, arena.capacity, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0
+    );
+    if (arena.data == MAP_FAILED) {
+        perror("arena_new");
+        exit(EXIT_FAILURE);
+    }
+    return arena;
+}
+
+static inline void arena_free(Arena *arena) {
+    munmap(arena->data, arena->capacity);
+    *arena = (Arena){0};
+}
+
+// Returns uninitialized memory aligned for any type
+static inline void *arena_alloc(Arena *arena, size_t size) {
+    size_t align = _Alignof(max_align_t);
+    size_t start = (arena->used + align - 1) & ~(align - 1);
+    if (start + size > arena->capacity) {
+        fprintf(stderr, "Arena out of memory\n");
+        abort();
+    }
+
+    arena->used = start + size;
+    return arena->data + start;
+}
+
+static inline void *arena_calloc(Arena *arena, size_t count, size_t size) {
+    void *ptr = arena_alloc(arena, count * size);
+    memset(ptr, 0, count * size);
+    return ptr;
+}
+
+static inline size_t arena_mark(Arena *arena) {
+    return arena->used;
+}
+
+static inline void arena_reset(Arena *arena, size_t mark) {
+    arena->used = mark;
+}
+
+// Dynamic arrays allocated in an arena, used like the stb_ds ones. An empty
+// array is a null pointer, and the length and capacity are stored in front of
+// the first element. They are released together with their arena.
+typedef struct ArenaArrayHeader {
+    size_t length;
+    size_t capacity;
+} ArenaArrayHeader;
+
+#define arena_arrheader(a) ((ArenaArrayHeader *) (a) - 1)
+#define arena_arrlen(a) ((a) ? arena_arrheader(a)->length : 0)
+#define arena_arrpop(a) ((a)[--arena_arrheader(a)->length])
+#define arena_arrput(arena, a, v) \
+    ((a) = arena_arrgrow((arena), (a), sizeof(*(a)), 1), \
+     (a)[arena_arrheader(a)->length++] = (v))
+
+// Makes room for add more elements. An array that is the last allocation of
+// the arena grows in place, any other one is moved to the end of the arena.
+static inline void *arena_arrgrow(
+    Arena *arena, void *a, size_t elem_size, size_t add
+) {
+    ArenaArrayHeader *header = a ? arena_arrheader(a) : 0;
+    size_t length = header ? header->length : 0;
+    size_t capacity = header ? header->capacity : 0;
+    if (length + add <= capacity) {
+        return a;
+    }
+
+    size_t new_capacity = capacity ? 2 * capacity : 8;
+    new_capacity = new_capacity < length + add ? length + add : new_capacity;
+
+    char *end = (char *) a + capacity * elem_size;
+    size_t extra = (new_capacity - capacity) * elem_size;
+    if (header && end == arena->data + arena->used
+        && arena->used + extra <= arena->capacity) {
+        arena->used += extra;
+        header->capacity = new_capacity;
+        return a;
+    }
+
+    header = arena_alloc(arena, sizeof(*header) + new_capacity * elem_size);
+    header->length = length;
+    header->capacity = new_capacity;
+    if (a) {
+        memcpy(header + 1, a, length * elem_size);
+    }
+    return header + 1;
+}
+
+// Grid of flags packed into 64-bit words, one bit per cell in row-major
+// order. Whole grids are reset, copied and counted a word at a time.
+typedef struct BitGrid {
+    uint64_t *words;
+    size_t rows;
+    size_t cols;
+    size_t length;
+} BitGrid;
+
+static inline BitGrid bitgrid_new(size_t rows, size_t cols) {
+    BitGrid grid = {.rows = rows, .cols = cols};
+    grid.length = (rows * cols + 63) / 64;
+    grid.words = calloc(grid.length ? grid.length : 1, sizeof(uint64_t));
+    return grid;
+}
+
+// Like bitgrid_new, but the words are released together with the arena
+static inline BitGrid bitgrid_arena(Arena *arena, size_t rows, size_t cols) {
+    BitGrid grid = {.rows = rows, .cols = cols};
+    grid.length = (rows * cols + 63) / 64;
+    grid.words = arena_calloc(arena, grid.length, sizeof(uint64_t));
+    return grid;
+}
+
+static inline void bitgrid_free(BitGrid grid) {
+    free(grid.words);
+}
+
+static inline bool bitgrid_test(BitGrid grid, size_t x, size_t y) {
+    size_t i = y * grid.cols + x;
+    return grid.words[i / 64] >> (i % 64) & 1;
+}
+
+static inline void bitgrid_set(BitGrid grid, size_t x, size_t y) {
+    size_t i = y * grid.cols + x;
+    grid.words[i / 64] |= (uint64_t) 1 << (i % 64);
+}
+
+static inline void bitgrid_clear(BitGrid grid, size_t x, size_t y) {
+    size_t i = y * grid.cols + x;
+    grid.words[i / 64] &= ~((uint64_t) 1 << (i % 64));
+}
+
+// Sets the flag and returns whether it was already set
+static inline bool bitgrid_test_and_set(BitGrid grid, size_t x, size_t y) {
+    size_t i = y * grid.cols + x;
+    uint64_t bit = (uint64_t) 1 << (i % 64);
+    bool was_set = grid.words[i / 64] & bit;
+    grid.words[i / 64] |= bit;
+    return was_set;
+}
+
+// Returns the number of set flags
+static inline size_t bitgrid_count(BitGrid grid) {
+    size_t count = 0;
+    for (size_t i = 0; i < grid.length; ++i) {
+        count += __builtin_popcountll(grid.words[i]);
+    }
+    return count;
+}
+
+static inline void bitgrid_reset(BitGrid grid) {
+    memset(grid.words, 0, grid.length * sizeof(uint64_t));
+}
+
+// Copies the flags of src to dst, which must have the same size
+static inline void bitgrid_copy(BitGrid dst, BitGrid src) {
+    memcpy(dst.words, src.words, src.length * sizeof(uint64_t));
+}